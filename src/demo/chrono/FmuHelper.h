@@ -20,6 +20,14 @@ public:
     // Simulation Step
     fmi2_status_t DoStep(double currentCommunicationPoint, double communicationStepSize, bool noSetFMUStatePriorToCurrentPoint = true);
 
+    // Step rejection handling
+    bool CanGetAndSetState() const;
+    bool CanHandleVariableStepSize() const;
+    bool GetState(fmi2_FMU_state_t& state);
+    bool SetState(fmi2_FMU_state_t state);
+    void FreeState(fmi2_FMU_state_t& state);
+    bool GetLastSuccessfulTime(double& time);
+
     // Variable Access
     bool SetVariable(const std::string& name, double value);
     bool SetVariable(const std::string& name, int value);
@@ -32,8 +40,11 @@ public:
     bool GetVariable(const std::string& name, std::string& value);
 
     // Helpers
+    const std::string& GetInstanceName() const { return m_instanceName; }
     std::string GetVersion() const;
     std::string GetTypesPlatform() const;
+    // Variable names in modelDescription order
+    std::vector<std::string> GetVariableNames() const;
     // Debug
     void DebugPrintVariables();
 
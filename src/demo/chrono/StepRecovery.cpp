@@ -0,0 +1,154 @@
+#include "StepRecovery.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+StepRecovery::StepRecovery(const std::string& groupName, std::vector<FmuHelper*> members, SubstepFn substep, const Options& options)
+    : m_groupName(groupName), m_members(std::move(members)), m_substep(std::move(substep)), m_options(options) {
+    if (m_options.factor < 2) m_options.factor = 2;
+    if (m_options.max_depth < 0) m_options.max_depth = 0;
+
+    m_canRollback = !m_members.empty();
+    for (auto* m : m_members) {
+        if (!m->CanGetAndSetState()) {
+            m_canRollback = false;
+            if (m_options.enabled) {
+                printf("[Recovery] Group %s: %s cannot get/set its FMU state; rejected steps abort the run\n",
+                       m_groupName.c_str(), m->GetInstanceName().c_str());
+            }
+        }
+    }
+    m_states.assign(m_members.size(), nullptr);
+
+    printf("[Recovery] Group %s: %zu members, recovery %s, max depth %d, factor %d\n",
+           m_groupName.c_str(), m_members.size(),
+           !m_options.enabled ? "disabled" : m_canRollback ? "by rollback" : "not possible",
+           m_options.max_depth, m_options.factor);
+}
+
+StepRecovery::~StepRecovery() {
+    for (size_t i = 0; i < m_states.size(); ++i) m_members[i]->FreeState(m_states[i]);
+}
+
+StepRecovery::Options StepRecovery::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.enabled = config.GetBool(root + ".enabled", o.enabled);
+    o.max_depth = static_cast<int>(config.GetDouble(root + ".max_depth", o.max_depth));
+    o.factor = static_cast<int>(config.GetDouble(root + ".factor", o.factor));
+    return o;
+}
+
+const char* StepRecovery::StatusName(fmi2_status_t status) {
+    switch (status) {
+        case fmi2_status_ok: return "fmi2OK";
+        case fmi2_status_warning: return "fmi2Warning";
+        case fmi2_status_discard: return "fmi2Discard";
+        case fmi2_status_error: return "fmi2Error";
+        case fmi2_status_fatal: return "fmi2Fatal";
+        case fmi2_status_pending: return "fmi2Pending";
+    }
+    return "unknown";
+}
+
+void StepRecovery::Result::Report(fmi2_status_t memberStatus, FmuHelper* fmu) {
+    if (!IsFailure(memberStatus)) return;
+    if (!IsFailure(status)) {
+        status = memberStatus;
+        failed = fmu;
+    }
+    rejected.push_back({fmu, memberStatus});
+}
+
+void StepRecovery::AddHostState(StateFn save, StateFn restore) {
+    m_hostStates.emplace_back(std::move(save), std::move(restore));
+}
+
+bool StepRecovery::Advance(double time, double step, int substeps) {
+    if (substeps < 1) substeps = 1;
+    // One snapshot per macro step; every retry restarts from it
+    bool saved = m_options.enabled && m_canRollback && SaveStates();
+
+    for (int depth = 0;; ++depth) {
+        const double h = step / substeps;
+        Result r;
+        double t = time;
+        for (int k = 0; k < substeps; ++k) {
+            t = time + k * h;
+            r = m_substep(t, h);
+            if (IsFailure(r.status)) break;
+        }
+        if (!IsFailure(r.status)) return true;
+
+        if (!m_options.enabled) {
+            Diagnose(r, t, h, depth, "recovery disabled");
+        } else if (!m_canRollback) {
+            Diagnose(r, t, h, depth, "FMU state cannot be restored (canGetAndSetFMUstate=false)");
+        } else if (!saved) {
+            Diagnose(r, t, h, depth, "fmi2GetFMUstate failed at the start of the macro step");
+        } else if (r.status == fmi2_status_fatal) {
+            Diagnose(r, t, h, depth, "fatal error");
+        } else if (depth >= m_options.max_depth) {
+            Diagnose(r, t, h, depth, "maximum refinement depth reached");
+        } else if (!RestoreStates()) {
+            Diagnose(r, t, h, depth, "rollback (fmi2SetFMUstate) failed");
+        } else {
+            // Re-run the whole macro step from the snapshot with finer substeps
+            m_rollbacks++;
+            m_finestDepth = std::max(m_finestDepth, depth + 1);
+            substeps *= m_options.factor;
+            continue;
+        }
+        return false;
+    }
+}
+
+bool StepRecovery::SaveStates() {
+    for (size_t i = 0; i < m_members.size(); ++i) {
+        if (!m_members[i]->GetState(m_states[i])) return false;
+    }
+    for (auto& h : m_hostStates) h.first();
+    return true;
+}
+
+bool StepRecovery::RestoreStates() {
+    for (size_t i = 0; i < m_members.size(); ++i) {
+        if (!m_members[i]->SetState(m_states[i])) return false;
+    }
+    for (auto& h : m_hostStates) h.second();
+    return true;
+}
+
+void StepRecovery::Diagnose(const Result& r, double time, double step, int depth, const std::string& reason) {
+    std::ostringstream ss;
+    ss << "[Recovery] Group " << m_groupName << " could not complete substep\n"
+       << "  time:           " << time << " s\n"
+       << "  step:           " << step << " s (refinement depth " << depth << ")\n"
+       << "  failed member:  " << (r.failed ? r.failed->GetInstanceName() : std::string("unknown")) << "\n"
+       << "  status:         " << StatusName(r.status) << "\n"
+       << "  reason:         " << reason << "\n";
+    if (r.rejected.size() > 1) {
+        ss << "  also rejected: ";
+        for (size_t i = 1; i < r.rejected.size(); ++i) {
+            const Rejection& x = r.rejected[i];
+            ss << " " << (x.fmu ? x.fmu->GetInstanceName() : std::string("unknown")) << " (" << StatusName(x.status) << ")";
+        }
+        ss << "\n";
+    }
+
+    if (r.failed) {
+        double last;
+        if (r.status == fmi2_status_discard && r.failed->GetLastSuccessfulTime(last)) {
+            ss << "  last success:   " << last << " s\n";
+        }
+        ss << "  capabilities:   getSetFMUstate=" << (r.failed->CanGetAndSetState() ? "yes" : "no")
+           << ", variableStepSize=" << (r.failed->CanHandleVariableStepSize() ? "yes" : "no") << "\n";
+    }
+    ss << "  rollbacks so far: " << m_rollbacks;
+    m_diagnostics = ss.str();
+}
+
+void StepRecovery::PrintStats() const {
+    printf("[Recovery] Group %s: %d rollbacks, finest level %d (substeps x %d^%d)\n",
+           m_groupName.c_str(), m_rollbacks, m_finestDepth, m_options.factor, m_finestDepth);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FmuHelper.h"
+#include "DemoConfiguration.h"
+
+// Recovery from rejected substeps (fmi2Discard / fmi2Error) of one coupling group.
+//
+// A substep of the group (exchange + DoStep of every member) is given as a
+// callback. FMI 2.0 allows repeating a rejected step only after
+// fmi2SetFMUstate, so recovery needs canGetAndSetFMUstate on every member:
+// the group's states (and the registered host-side state) are taken once at
+// the start of each macro step, and when a substep is rejected the group is
+// restored and the whole macro step is re-run with `factor` times as many
+// substeps (up to `max_depth` times). Otherwise, or when recovery is
+// disabled, the first rejected substep is reported with diagnostics and the
+// caller aborts.
+class StepRecovery {
+public:
+    struct Options {
+        bool enabled = false;
+        int max_depth = 3;
+        int factor = 2;
+    };
+
+    struct Rejection {
+        FmuHelper* fmu = nullptr;  // nullptr for components without an FMU
+        fmi2_status_t status = fmi2_status_ok;
+    };
+
+    struct Result {
+        fmi2_status_t status = fmi2_status_ok;
+        FmuHelper* failed = nullptr;       // first member that rejected the step
+        std::vector<Rejection> rejected;   // every member that rejected it, in report order
+
+        // Records a member's DoStep status; the first failure sets status / failed
+        void Report(fmi2_status_t memberStatus, FmuHelper* fmu);
+    };
+
+    using SubstepFn = std::function<Result(double time, double step)>;
+    // Saves / restores host-side state at the start of the macro step
+    using StateFn = std::function<void()>;
+
+    StepRecovery(const std::string& groupName, std::vector<FmuHelper*> members, SubstepFn substep, const Options& options);
+    ~StepRecovery();
+
+    // Advances the group from `time` by the macro step `step` in `substeps`
+    // equal substeps. Returns false when a substep was rejected and could not
+    // be recovered; GetDiagnostics() then describes the failure.
+    bool Advance(double time, double step, int substeps = 1);
+
+    // Host-side state that the substep changes (e.g. PowerBond bookkeeping) and
+    // that must be rolled back together with the FMU states
+    void AddHostState(StateFn save, StateFn restore);
+
+    const std::string& GetDiagnostics() const { return m_diagnostics; }
+    void PrintStats() const;
+
+    static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    static const char* StatusName(fmi2_status_t status);
+    static bool IsFailure(fmi2_status_t status) { return status != fmi2_status_ok && status != fmi2_status_warning; }
+
+private:
+    bool SaveStates();
+    bool RestoreStates();
+    void Diagnose(const Result& r, double time, double step, int depth, const std::string& reason);
+
+    std::string m_groupName;
+    std::vector<FmuHelper*> m_members;
+    SubstepFn m_substep;
+    Options m_options;
+    bool m_canRollback = false;
+
+    std::vector<fmi2_FMU_state_t> m_states;  // per member, reused across macro steps
+    std::vector<std::pair<StateFn, StateFn>> m_hostStates;
+    std::string m_diagnostics;
+
+    int m_rollbacks = 0;
+    int m_finestDepth = 0;
+};
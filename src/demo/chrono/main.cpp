@@ -3,7 +3,10 @@
 #include <vector>
 #include <filesystem>
 #include <array>
+#include <cmath>
+#include <set>
 #include "FmuHelper.h"
+#include "StepRecovery.h"
 
 // Hardcoded paths for demo purposes - in a real app these might be args
 // Assuming running from build directory or referencing fixed paths relative to repository root
@@ -41,6 +44,21 @@ void GetQuatVariable(FmuHelper& fmu, const std::string& prefix, double* q) {
 
 #include "DemoConfiguration.h"
 
+// Wheel variable prefixes of a vehicle FMU: every "<id>" that declares <id>.pos.x,
+// <id>.lin_vel.x and <id>.force.x, in modelDescription order
+std::vector<std::string> FindWheelIds(const FmuHelper& fmu) {
+    std::vector<std::string> names = fmu.GetVariableNames();
+    std::set<std::string> declared(names.begin(), names.end());
+    std::vector<std::string> ids;
+    const std::string marker = ".lin_vel.x";
+    for (const auto& n : names) {
+        if (n.size() <= marker.size() || n.compare(n.size() - marker.size(), marker.size(), marker) != 0) continue;
+        std::string id = n.substr(0, n.size() - marker.size());
+        if (declared.count(id + ".pos.x") && declared.count(id + ".force.x")) ids.push_back(id);
+    }
+    return ids;
+}
+
 int main(int argc, char* argv[]) {
     // -------------------------------------------------------------------------
     // Configuration
@@ -98,13 +116,19 @@ int main(int argc, char* argv[]) {
         FmuHelper powertrain_fmu("PowertrainFMU", powertrain_fmu_file, p_unpack);
         FmuHelper driver_fmu("DriverFMU", driver_fmu_file, d_unpack);
 
+        // Wheel topology from the vehicle FMU; one tire / terrain instance per wheel
+        std::vector<std::string> wheel_ids = FindWheelIds(vehicle_fmu);
+        if (wheel_ids.empty()) throw std::runtime_error("Vehicle FMU declares no wheels");
+        int num_wheels = static_cast<int>(wheel_ids.size());
+        std::cout << "Vehicle has " << num_wheels << " wheels" << std::endl;
+
         std::vector<FmuHelper*> tires;
         std::vector<FmuHelper*> terrains;
         
         std::string t_prefix = config.GetString("tire.unpack_dir_prefix", "./tmp_tire_");
         std::string tr_prefix = config.GetString("terrain.unpack_dir_prefix", "./tmp_terrain_");
 
-        for(int i=0; i<4; ++i) {
+        for(int i=0; i<num_wheels; ++i) {
             std::string t_dir = std::filesystem::absolute(t_prefix + std::to_string(i)).string();
             std::string tr_dir = std::filesystem::absolute(tr_prefix + std::to_string(i)).string();
             ensure_dir(t_dir);
@@ -193,36 +217,14 @@ int main(int argc, char* argv[]) {
         std::cout << "Starting simulation loop..." << std::endl;
         
         double time = start_time;
-        std::string wheel_ids[4] = {"wheel_FL", "wheel_FR", "wheel_RL", "wheel_RR"};
-
-        while (time < t_end) {
-            // --- Driver Control ---
-
-            double steering, throttle, braking;
-            driver_fmu.GetVariable("steering", steering);
-            driver_fmu.GetVariable("throttle", throttle);
-            driver_fmu.GetVariable("braking", braking);
-
-            vehicle_fmu.SetVariable("steering", steering);
-            vehicle_fmu.SetVariable("throttle", throttle);
-            vehicle_fmu.SetVariable("braking", braking);
-            powertrain_fmu.SetVariable("throttle", throttle);
-
-            // --- Vehicle State -> Driver ---
-            // "ref_frame" is a FrameMoving.
-            // FMUs expose this as ref_frame.pos, ref_frame.rot, ref_frame.pos_dt, ref_frame.rot_dt
-            
-            double ref_pos[3], ref_rot[4], ref_pos_dt[3], ref_rot_dt[4];
-            GetVecVariable(vehicle_fmu, "ref_frame.pos", ref_pos);
-            GetQuatVariable(vehicle_fmu, "ref_frame.rot", ref_rot);
-            GetVecVariable(vehicle_fmu, "ref_frame.pos_dt", ref_pos_dt);
-            GetQuatVariable(vehicle_fmu, "ref_frame.rot_dt", ref_rot_dt);
-
-            SetVecVariable(driver_fmu, "ref_frame.pos", ref_pos);
-            SetQuatVariable(driver_fmu, "ref_frame.rot", ref_rot);
-            SetVecVariable(driver_fmu, "ref_frame.pos_dt", ref_pos_dt);
-            SetQuatVariable(driver_fmu, "ref_frame.rot_dt", ref_rot_dt);
 
+        // One step of the coupled FMUs (exchange + DoStep), wrapped so that
+        // StepRecovery can re-run it when a member rejects the step.
+        auto coupled_step = [&](double t, double h) -> StepRecovery::Result {
+            // Every member is stepped even after a failure, so that none of them stays
+            // behind; the result lists all that rejected the step.
+            StepRecovery::Result result;
+            auto check = [&](fmi2_status_t status, FmuHelper* fmu) { result.Report(status, fmu); };
 
             // --- Powertrain <-> Vehicle ---
             double driveshaft_torque, driveshaft_speed;
@@ -233,7 +235,7 @@ int main(int argc, char* argv[]) {
             powertrain_fmu.SetVariable("driveshaft_speed", driveshaft_speed);
 
             // --- Tires & Terrains ---
-            for(int i=0; i<4; ++i) {
+            for(int i=0; i<num_wheels; ++i) {
                 // Vehicle -> Tire
                 double w_pos[3], w_rot[4], w_lin_vel[3], w_ang_vel[3];
                 GetVecVariable(vehicle_fmu, wheel_ids[i] + ".pos", w_pos);
@@ -262,32 +264,71 @@ int main(int argc, char* argv[]) {
                 SetVecVariable(*terrains[i], "query_point", query_point);
 
                 // Step Terrain
-                terrains[i]->DoStep(time, step_size);
+                fmi2_status_t terrain_status = terrains[i]->DoStep(t, h);
+                check(terrain_status, terrains[i]);
+                // A rejected terrain step leaves its outputs undefined; the tire keeps the previous ones
+                if (StepRecovery::IsFailure(terrain_status)) continue;
 
                 // Terrain -> Tire
                 double height, mu, normal[3];
                 terrains[i]->GetVariable("height", height);
                 terrains[i]->GetVariable("mu", mu);
                 GetVecVariable(*terrains[i], "normal", normal);
-                
+            
                 tires[i]->SetVariable("terrain_height", height);
                 tires[i]->SetVariable("terrain_mu", mu);
                 SetVecVariable(*tires[i], "terrain_normal", normal);
             }
 
             // --- Advance Steps ---
-            /*
-            auto status_vehicle = vehicle_fmu.DoStep(time, step, fmi2True);
-            auto status_powertrain = powertrain_fmu.DoStep(time, step, fmi2True);
-            auto status_driver = driver_fmu.DoStep(time, step, fmi2True);
-            // Terrain already stepped
-            */
-            if(vehicle_fmu.DoStep(time, step_size) != fmi2_status_ok) break;
-            if(powertrain_fmu.DoStep(time, step_size) != fmi2_status_ok) break;
-            if(driver_fmu.DoStep(time, step_size) != fmi2_status_ok) break;
+            check(vehicle_fmu.DoStep(t, h), &vehicle_fmu);
+            check(powertrain_fmu.DoStep(t, h), &powertrain_fmu);
+            check(driver_fmu.DoStep(t, h), &driver_fmu);
+            for(auto tire : tires) check(tire->DoStep(t, h), tire);
+            return result;
+        };
+
+        std::vector<FmuHelper*> members = {&vehicle_fmu, &powertrain_fmu, &driver_fmu};
+        for(auto t : tires) members.push_back(t);
+        for(auto t : terrains) members.push_back(t);
+        StepRecovery recovery("Chrono", members, coupled_step,
+                              StepRecovery::FromConfig(config, "simulation.step_recovery"));
+        bool aborted = false;
+
+        while (time < t_end) {
+            // --- Driver Control ---
+
+            double steering, throttle, braking;
+            driver_fmu.GetVariable("steering", steering);
+            driver_fmu.GetVariable("throttle", throttle);
+            driver_fmu.GetVariable("braking", braking);
+
+            vehicle_fmu.SetVariable("steering", steering);
+            vehicle_fmu.SetVariable("throttle", throttle);
+            vehicle_fmu.SetVariable("braking", braking);
+            powertrain_fmu.SetVariable("throttle", throttle);
+
+            // --- Vehicle State -> Driver ---
+            // "ref_frame" is a FrameMoving.
+            // FMUs expose this as ref_frame.pos, ref_frame.rot, ref_frame.pos_dt, ref_frame.rot_dt
             
-            for(auto t : tires) {
-                if(t->DoStep(time, step_size) != fmi2_status_ok) break;
+            double ref_pos[3], ref_rot[4], ref_pos_dt[3], ref_rot_dt[4];
+            GetVecVariable(vehicle_fmu, "ref_frame.pos", ref_pos);
+            GetQuatVariable(vehicle_fmu, "ref_frame.rot", ref_rot);
+            GetVecVariable(vehicle_fmu, "ref_frame.pos_dt", ref_pos_dt);
+            GetQuatVariable(vehicle_fmu, "ref_frame.rot_dt", ref_rot_dt);
+
+            SetVecVariable(driver_fmu, "ref_frame.pos", ref_pos);
+            SetQuatVariable(driver_fmu, "ref_frame.rot", ref_rot);
+            SetVecVariable(driver_fmu, "ref_frame.pos_dt", ref_pos_dt);
+            SetQuatVariable(driver_fmu, "ref_frame.rot_dt", ref_rot_dt);
+
+
+            // --- Coupled step (with recovery on rejected steps) ---
+            if (!recovery.Advance(time, step_size)) {
+                std::cerr << recovery.GetDiagnostics() << std::endl;
+                aborted = true;
+                break;
             }
 
             time += step_size;
@@ -300,11 +341,14 @@ int main(int argc, char* argv[]) {
         }
 
         std::cout << "Simulation finished at time " << time << std::endl;
+        recovery.PrintStats();
 
         // Cleanup
         for(auto t : tires) delete t;
         for(auto t : terrains) delete t;
 
+        if (aborted) return 2;
+
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 1;
@@ -203,6 +203,18 @@ std::string FmuHelper::GetTypesPlatform() const {
     return fmi2_import_get_types_platform(m_fmu);
 }
 
+std::vector<std::string> FmuHelper::GetVariableNames() const {
+    std::vector<std::string> names;
+    fmi2_import_variable_list_t* varList = fmi2_import_get_variable_list(m_fmu, 0);
+    size_t numVars = fmi2_import_get_variable_list_size(varList);
+    names.reserve(numVars);
+    for (size_t i = 0; i < numVars; ++i) {
+        names.push_back(fmi2_import_get_variable_name(fmi2_import_get_variable(varList, i)));
+    }
+    fmi2_import_free_variable_list(varList);
+    return names;
+}
+
 void FmuHelper::DebugPrintVariables() {
     printf("DEBUG: Variables for %s:\n", m_instanceName.c_str());
     fmi2_import_variable_list_t* varList = fmi2_import_get_variable_list(m_fmu, 0);
@@ -34,6 +34,8 @@ public:
     // Helpers
     std::string GetVersion() const;
     std::string GetTypesPlatform() const;
+    // Variable names in modelDescription order
+    std::vector<std::string> GetVariableNames() const;
     // Debug
     void DebugPrintVariables();
 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Selective decoding of OSI messages straight from the protobuf wire format.
+//
+// The master only needs a handful of fields of the SensorView esmini publishes
+// every step (host vehicle id, moving object ids and poses), while a full
+// ParseFromArray also materializes lanes, boundaries, signs and everything
+// else. The scanner walks the encoded buffer, decodes the fields it was asked
+// for and skips all others by their length prefix, without allocating.
+
+// Cursor over one encoded message. Next() reads a tag and its value; a
+// length-delimited value is only located, so a field that is not looked at
+// costs nothing beyond its tag.
+class WireReader {
+public:
+    enum WireType { kVarint = 0, kFixed64 = 1, kLength = 2, kFixed32 = 5 };
+
+    WireReader() = default;
+    WireReader(const void* data, size_t size)
+        : m_p(static_cast<const uint8_t*>(data)), m_end(static_cast<const uint8_t*>(data) + size) {}
+
+    // false at the end of the message or on malformed input (see Failed())
+    bool Next() {
+        if (m_p >= m_end) return false;
+        m_record = m_p;
+        uint64_t tag;
+        if (!ReadVarint(tag) || (tag >> 3) == 0) return Fail();
+        m_field = static_cast<uint32_t>(tag >> 3);
+        m_type = static_cast<int>(tag & 7);
+        switch (m_type) {
+        case kVarint:
+            if (!ReadVarint(m_value)) return Fail();
+            break;
+        case kFixed64:
+            if (m_end - m_p < 8) return Fail();
+            std::memcpy(&m_value, m_p, 8);
+            m_p += 8;
+            break;
+        case kFixed32: {
+            if (m_end - m_p < 4) return Fail();
+            uint32_t v;
+            std::memcpy(&v, m_p, 4);
+            m_value = v;
+            m_p += 4;
+            break;
+        }
+        case kLength:
+            if (!ReadVarint(m_value) || m_value > static_cast<uint64_t>(m_end - m_p)) return Fail();
+            m_data = m_p;
+            m_p += m_value;
+            break;
+        default:
+            return Fail();  // groups are not used by OSI
+        }
+        return true;
+    }
+
+    bool Failed() const { return m_failed; }
+    uint32_t Field() const { return m_field; }
+    int Type() const { return m_type; }
+
+    uint64_t Varint() const { return m_value; }
+    // fixed64 / fixed32 payloads; OSI only runs on little-endian hosts
+    double Double() const {
+        double d;
+        std::memcpy(&d, &m_value, 8);
+        return d;
+    }
+    float Float() const {
+        uint32_t bits = static_cast<uint32_t>(m_value);
+        float f;
+        std::memcpy(&f, &bits, 4);
+        return f;
+    }
+
+    // Length-delimited payload
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return static_cast<size_t>(m_value); }
+    WireReader Message() const { return WireReader(m_data, Size()); }
+
+    // The whole current field (tag and value) as encoded, for copying it verbatim
+    const uint8_t* Record() const { return m_record; }
+    size_t RecordSize() const { return static_cast<size_t>(m_p - m_record); }
+
+private:
+    bool ReadVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && m_p < m_end; shift += 7) {
+            uint8_t b = *m_p++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+    bool Fail() {
+        m_failed = true;
+        m_p = m_end;
+        return false;
+    }
+
+    const uint8_t* m_p = nullptr;
+    const uint8_t* m_end = nullptr;
+    const uint8_t* m_data = nullptr;
+    const uint8_t* m_record = nullptr;
+    uint64_t m_value = 0;
+    uint32_t m_field = 0;
+    int m_type = 0;
+    bool m_failed = false;
+};
+
+// Writers for the stages that re-encode parts of a message
+inline void AppendVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline void AppendTag(std::string& out, uint32_t field, int wireType) {
+    AppendVarint(out, (static_cast<uint64_t>(field) << 3) | static_cast<uint64_t>(wireType));
+}
+
+// GroundTruth.moving_object[i]: id, type, base and the first assigned lane,
+// plus the encoded object itself so a caller that needs the rest (vehicle
+// attributes, model reference) can parse just this slice into an osi3::MovingObject.
+struct ScannedObject {
+    uint64_t id = 0;
+    int type = 0;  // osi3::MovingObject::Type
+    bool hasLane = false;  // assigned_lane_id or moving_object_classification.assigned_lane_id
+    uint64_t laneId = 0;   // the first of them
+    bool hasBase = false;
+    double dimension[3] = {0, 0, 0};    // length, width, height
+    double position[3] = {0, 0, 0};
+    double orientation[3] = {0, 0, 0};  // roll, pitch, yaw
+    double velocity[3] = {0, 0, 0};
+    double acceleration[3] = {0, 0, 0};
+
+    const uint8_t* data = nullptr;  // encoded osi3::MovingObject, inside the scanned buffer
+    size_t size = 0;
+};
+
+// Result of ScanSensorView. Reuse one instance across steps: the object vector
+// keeps its capacity, so scanning does not allocate once it has grown.
+struct SensorViewScan {
+    bool hasHostVehicleId = false;  // SensorView.host_vehicle_id
+    uint64_t hostVehicleId = 0;
+    bool hasGroundTruthHostVehicleId = false;  // SensorView.global_ground_truth.host_vehicle_id
+    uint64_t groundTruthHostVehicleId = 0;
+    std::vector<ScannedObject> movingObjects;  // global_ground_truth.moving_object, in message order
+};
+
+// Decodes SensorView.host_vehicle_id, global_ground_truth.host_vehicle_id and
+// global_ground_truth.moving_object[*].{id, type, base, lane assignment};
+// everything else is skipped.
+// Returns false on malformed input. Pointers in the result refer into data.
+bool ScanSensorView(const void* data, size_t size, SensorViewScan& scan);
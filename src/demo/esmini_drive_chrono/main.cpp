@@ -3,11 +3,13 @@
 #include <vector>
 #include <filesystem>
 #include <array>
+#include <set>
 #include <iomanip>
 #include <chrono>
 #include "FmuHelper.h"
 #include "OsiHelper.h"
 #include "DemoConfiguration.h"
+#include "ObjectTable.h"
 
 // OSI Ptrs
 #include "osi_sensorview.pb.h"
@@ -40,6 +42,21 @@ void GetQuatVariable(FmuHelper& fmu, const std::string& prefix, double* q) {
     fmu.GetVariable(prefix + ".e3", q[3]);
 }
 
+// Wheel variable prefixes of a vehicle FMU: every "<id>" that declares <id>.pos.x,
+// <id>.lin_vel.x and <id>.force.x, in modelDescription order
+std::vector<std::string> FindWheelIds(const FmuHelper& fmu) {
+    std::vector<std::string> names = fmu.GetVariableNames();
+    std::set<std::string> declared(names.begin(), names.end());
+    std::vector<std::string> ids;
+    const std::string marker = ".lin_vel.x";
+    for (const auto& n : names) {
+        if (n.size() <= marker.size() || n.compare(n.size() - marker.size(), marker.size(), marker) != 0) continue;
+        std::string id = n.substr(0, n.size() - marker.size());
+        if (declared.count(id + ".pos.x") && declared.count(id + ".force.x")) ids.push_back(id);
+    }
+    return ids;
+}
+
 int main(int argc, char* argv[]) {
     // -------------------------------------------------------------------------
     // Configuration
@@ -107,13 +124,19 @@ int main(int argc, char* argv[]) {
         FmuHelper vehicle_fmu("WheeledVehicleFMU", vehicle_fmu_file, v_unpack);
         FmuHelper powertrain_fmu("PowertrainFMU", powertrain_fmu_file, p_unpack);
 
+        // Wheel topology from the vehicle FMU; one tire / terrain instance per wheel
+        std::vector<std::string> wheel_ids = FindWheelIds(vehicle_fmu);
+        if (wheel_ids.empty()) throw std::runtime_error("Vehicle FMU declares no wheels");
+        int num_wheels = static_cast<int>(wheel_ids.size());
+        std::cout << "Vehicle has " << num_wheels << " wheels" << std::endl;
+
         std::vector<FmuHelper*> tires;
         std::vector<FmuHelper*> terrains;
         
         std::string t_prefix = config.GetString("tire.unpack_dir_prefix", "./tmp_tire_");
         std::string tr_prefix = config.GetString("terrain.unpack_dir_prefix", "./tmp_terrain_");
 
-        for(int i=0; i<4; ++i) {
+        for(int i=0; i<num_wheels; ++i) {
             std::string t_dir = std::filesystem::absolute(t_prefix + std::to_string(i)).string();
             std::string tr_dir = std::filesystem::absolute(tr_prefix + std::to_string(i)).string();
             ensure_dir(t_dir);
@@ -198,23 +221,26 @@ int main(int argc, char* argv[]) {
             void* ptr = DecodeOSMPPointer(sv_lo, sv_hi);
             osi3::SensorView sv;
             if (sv.ParseFromArray(ptr, sv_sz)) {
-                if (sv.has_global_ground_truth() && sv.global_ground_truth().moving_object_size() > 0) {
-                     // As per user request: Use the first moving object
-                     const auto& obj = sv.global_ground_truth().moving_object(0);
-                     if (obj.has_base()) {
-                         initial_pos[0] = obj.base().position().x();
-                         initial_pos[1] = obj.base().position().y();
-                         initial_pos[2] = obj.base().position().z();
-                         
-                         initial_rot[0] = obj.base().orientation().roll();
-                         initial_rot[1] = obj.base().orientation().pitch();
-                         initial_rot[2] = obj.base().orientation().yaw();
-                         
-                         std::cout << "[Scenario Init] Found Ego Initial State: Pos(" 
-                                   << initial_pos[0] << ", " << initial_pos[1] << ", " << initial_pos[2] << ") "
-                                   << "Rot(" << initial_rot[0] << ", " << initial_rot[1] << ", " << initial_rot[2] << ")" << std::endl;
-                         found_ego = true;
-                     }
+                // The ego is the object named by host_vehicle_id (SensorView, then ground truth);
+                // the first moving object only when neither is set
+                ObjectTable objects;
+                objects.Build(sv);
+                const uint32_t row = objects.EgoRow();
+                if (row != ObjectTable::kNoRow) {
+                     initial_pos[0] = objects.x[row];
+                     initial_pos[1] = objects.y[row];
+                     initial_pos[2] = objects.z[row];
+
+                     initial_rot[0] = objects.roll[row];
+                     initial_rot[1] = objects.pitch[row];
+                     initial_rot[2] = objects.yaw[row];
+
+                     std::cout << "[Scenario Init] Found Ego Initial State (id " << objects.id[row] << "): Pos("
+                               << initial_pos[0] << ", " << initial_pos[1] << ", " << initial_pos[2] << ") "
+                               << "Rot(" << initial_rot[0] << ", " << initial_rot[1] << ", " << initial_rot[2] << ")" << std::endl;
+                     found_ego = true;
+                } else if (objects.HasHostVehicleId()) {
+                     std::cerr << "[Scenario Init] host_vehicle_id names no moving object; keeping the default initial state" << std::endl;
                 }
             } else {
                  std::cerr << "[Error] Failed to parse initial OSI SensorView!" << std::endl;
@@ -313,7 +339,6 @@ int main(int argc, char* argv[]) {
         std::cout << std::string(80, '=') << std::endl;
         
         double time = start_time;
-        std::string wheel_ids[4] = {"wheel_FL", "wheel_FR", "wheel_RL", "wheel_RR"};
         int step_count = 0;
 
         while (time < t_end) {
@@ -374,7 +399,7 @@ int main(int argc, char* argv[]) {
 
             // Tires & Terrains
             std::cout << "[DEBUG] Exchanging Wheel/Tire variables..." << std::endl;
-            for(int i=0; i<4; ++i) {
+            for(int i=0; i<num_wheels; ++i) {
                 // Vehicle -> Tire
                 double w_pos[3], w_rot[4], w_lin_vel[3], w_ang_vel[3];
                 GetVecVariable(vehicle_fmu, wheel_ids[i] + ".pos", w_pos);
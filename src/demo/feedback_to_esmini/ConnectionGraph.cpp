@@ -0,0 +1,617 @@
+#include "ConnectionGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// Up to this many stateful instances every order is tried, which also lets the
+// stage count break ties. Larger groups are ordered per strongly connected component.
+const size_t kExhaustiveLimit = 8;
+// Components up to this size are ordered exactly (dynamic programming over subsets)
+const size_t kExactLimit = 16;
+}
+
+ScheduleOptions ScheduleOptions::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    ScheduleOptions o;
+    o.optimize = config.GetString(root + ".mode", "optimized") != "manual";
+
+    auto ft = config.Get(root + ".feedthrough");
+    if (ft.type == MiniJSON::Type::Array) {
+        o.feedthrough.clear();
+        for (auto& v : ft.a_val) o.feedthrough.push_back(v.as_string());
+    }
+
+    auto weights = config.Get(root + ".weights");
+    if (weights.type == MiniJSON::Type::Object) {
+        for (auto& [kind, v] : weights.o_val) o.weights[kind] = v.as_double();
+    }
+
+    auto manual = config.Get(root + ".manual");
+    if (manual.type == MiniJSON::Type::Array) {
+        for (auto& stage : manual.a_val) {
+            std::vector<std::string> roles;
+            for (auto& r : stage.a_val) roles.push_back(r.as_string());
+            o.manual.push_back(roles);
+        }
+    }
+    return o;
+}
+
+MemoOptions MemoOptions::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    MemoOptions o;
+    o.enabled = config.GetBool(root + ".enabled", false);
+
+    auto roles = config.Get(root + ".roles");
+    if (roles.type != MiniJSON::Type::Object) return o;
+    for (auto& [role, v] : roles.o_val) {
+        std::string base = root + ".roles." + role;
+        MemoPolicy p;
+        p.tolerance = config.GetDouble(base + ".tolerance", 0.0);
+        p.refresh = static_cast<int>(config.GetDouble(base + ".refresh", 0.0));
+        auto tol = config.Get(base + ".tolerances");
+        if (tol.type == MiniJSON::Type::Object) {
+            for (auto& [name, t] : tol.o_val) p.tolerances[name] = t.as_double();
+        }
+        o.roles[role] = p;
+    }
+    return o;
+}
+
+int ConnectionGraph::AddInstance(FmuHelper* fmu, const std::string& role) {
+    Instance inst;
+    inst.fmu = fmu;
+    inst.role = role;
+    m_instances.push_back(inst);
+    return static_cast<int>(m_instances.size()) - 1;
+}
+
+int ConnectionGraph::AddInstance(NativeComponent* component, const std::string& role) {
+    Instance inst;
+    inst.component = component;
+    inst.role = role;
+    m_instances.push_back(inst);
+    return static_cast<int>(m_instances.size()) - 1;
+}
+
+const std::string& ConnectionGraph::GetName(int instance) const {
+    const Instance& inst = m_instances[instance];
+    return inst.fmu ? inst.fmu->GetInstanceName() : inst.component->GetName();
+}
+
+fmi2_status_t ConnectionGraph::DoStep(int instance, double time, double step) {
+    Instance& inst = m_instances[instance];
+    Memo& memo = inst.memo;
+    if (!memo.enabled) return inst.fmu ? inst.fmu->DoStep(time, step) : inst.component->DoStep(time, step);
+    if (memo.skip) return fmi2_status_ok;
+
+    // Skipped steps are caught up in one variable-size step so that the FMU's
+    // communication points stay contiguous (a stateless FMU gives the same result)
+    double start = memo.valid && memo.lastEnd <= time ? memo.lastEnd : time;
+    double end = time + step;
+    fmi2_status_t status = inst.fmu ? inst.fmu->DoStep(start, end - start) : inst.component->DoStep(start, end - start);
+    memo.valid = status == fmi2_status_ok || status == fmi2_status_warning;
+    if (memo.valid) {
+        memo.lastEnd = end;
+        ReadOutputs(inst);
+    }
+    return status;
+}
+
+void ConnectionGraph::ReadOutputs(Instance& inst) {
+    Memo& memo = inst.memo;
+    if (inst.fmu) {
+        inst.fmu->GetReals(memo.outputVrs, memo.cache.data());
+    } else {
+        for (size_t k = 0; k < memo.outputPtrs.size(); ++k) memo.cache[k] = *memo.outputPtrs[k];
+    }
+}
+
+int ConnectionGraph::AddConnection(int from, int to, const std::string& kind,
+                                   const std::vector<std::string>& outputs, const std::vector<std::string>& inputs) {
+    if (outputs.size() != inputs.size()) {
+        throw std::runtime_error("Connection " + kind + ": output/input count mismatch");
+    }
+    Connection c;
+    c.from = from;
+    c.to = to;
+    c.kind = kind;
+    c.outputs = outputs;
+    c.inputs = inputs;
+    m_connections.push_back(c);
+
+    int index = static_cast<int>(m_connections.size()) - 1;
+    m_instances[to].inputs.push_back(index);
+    return index;
+}
+
+void ConnectionGraph::SetFilter(int connection, Filter filter) {
+    m_connections[connection].filter = std::move(filter);
+}
+
+void ConnectionGraph::PullInputs(int instance) {
+    Instance& inst = m_instances[instance];
+    Memo& memo = inst.memo;
+
+    size_t offset = 0;
+    bool within = memo.valid;
+    for (int ci : inst.inputs) {
+        Connection& c = m_connections[ci];
+        const Instance& from = m_instances[c.from];
+        double* values = c.buffer.data();
+
+        if (from.memo.enabled) {
+            for (size_t k = 0; k < c.cacheIndex.size(); ++k) values[k] = from.memo.cache[c.cacheIndex[k]];
+        } else if (from.fmu) {
+            from.fmu->GetReals(c.outputVrs, values);
+        } else {
+            for (size_t k = 0; k < c.outputPtrs.size(); ++k) values[k] = *c.outputPtrs[k];
+        }
+        if (c.filter) c.filter(values);
+
+        if (!memo.enabled) {
+            PushInputs(c, values);
+            continue;
+        }
+        for (size_t k = 0; k < c.buffer.size(); ++k, ++offset) {
+            memo.current[offset] = values[k];
+            within = within && std::fabs(values[k] - memo.evaluated[offset]) <= memo.tolerance[offset];
+        }
+    }
+    if (!memo.enabled) return;
+
+    bool refresh = within && memo.refresh > 0 && memo.sinceRefresh >= memo.refresh;
+    memo.skip = within && !refresh;
+    if (memo.skip) {
+        ++memo.hits;
+        ++memo.sinceRefresh;
+        return;
+    }
+
+    // Real step: hand the inputs over and remember them as the new reference
+    if (refresh) ++memo.refreshes;
+    else ++memo.misses;
+    memo.sinceRefresh = 0;
+    memo.evaluated = memo.current;
+    for (int ci : inst.inputs) PushInputs(m_connections[ci], m_connections[ci].buffer.data());
+}
+
+void ConnectionGraph::PushInputs(const Connection& c, const double* values) {
+    const Instance& to = m_instances[c.to];
+    if (to.fmu) {
+        to.fmu->SetReals(c.inputVrs, values);
+    } else {
+        for (size_t k = 0; k < c.inputPtrs.size(); ++k) *c.inputPtrs[k] = values[k];
+    }
+}
+
+void ConnectionGraph::SetMemoization(const MemoOptions& options) {
+    for (auto& c : m_connections) c.cacheIndex.clear();
+    for (auto& inst : m_instances) inst.memo = Memo();
+    if (!options.enabled) return;
+
+    for (int i = 0; i < GetInstanceCount(); ++i) {
+        Instance& inst = m_instances[i];
+        auto it = options.roles.find(inst.role);
+        if (it == options.roles.end()) continue;
+        const MemoPolicy& policy = it->second;
+
+        if (inst.fmu && !inst.fmu->CanHandleVariableStepSize()) {
+            printf("[Memo] Warning: %s cannot handle variable step sizes; not memoized\n", GetName(i).c_str());
+            continue;
+        }
+
+        Memo& memo = inst.memo;
+        memo.enabled = true;
+        memo.refresh = policy.refresh;
+        for (int ci : inst.inputs) {
+            for (auto& name : m_connections[ci].inputs) {
+                auto t = policy.tolerances.find(name);
+                if (t == policy.tolerances.end()) t = policy.tolerances.find(name.substr(name.find_last_of('.') + 1));
+                memo.tolerance.push_back(t != policy.tolerances.end() ? t->second : policy.tolerance);
+            }
+        }
+        memo.evaluated.assign(memo.tolerance.size(), 0.0);
+        memo.current.assign(memo.tolerance.size(), 0.0);
+
+        // Cache every output some connection reads
+        for (auto& c : m_connections) {
+            if (c.from != i) continue;
+            for (auto& name : c.outputs) {
+                auto pos = std::find(memo.outputs.begin(), memo.outputs.end(), name);
+                if (pos == memo.outputs.end()) {
+                    memo.outputs.push_back(name);
+                    if (inst.fmu) memo.outputVrs.push_back(inst.fmu->GetValueReference(name));
+                    else memo.outputPtrs.push_back(inst.component->GetOutput(name));
+                    pos = memo.outputs.end() - 1;
+                }
+                c.cacheIndex.push_back(static_cast<size_t>(pos - memo.outputs.begin()));
+            }
+        }
+        memo.cache.assign(memo.outputs.size(), 0.0);
+        // Until the first real step the cache holds whatever the instance reports now
+        ReadOutputs(inst);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Analysis
+// -----------------------------------------------------------------------------
+
+void ConnectionGraph::Build(const ScheduleOptions& options) {
+    const int n = GetInstanceCount();
+
+    for (auto& inst : m_instances) {
+        inst.feedthrough = std::find(options.feedthrough.begin(), options.feedthrough.end(), inst.role) != options.feedthrough.end();
+    }
+
+    m_totalWeight = 0.0;
+    for (auto& c : m_connections) {
+        auto it = options.weights.find(c.kind);
+        if (it != options.weights.end()) c.weight = it->second;
+        m_totalWeight += c.weight;
+
+        c.outputVrs.clear();
+        c.inputVrs.clear();
+        c.outputPtrs.clear();
+        c.inputPtrs.clear();
+        const Instance& from = m_instances[c.from];
+        const Instance& to = m_instances[c.to];
+        for (auto& name : c.outputs) {
+            if (from.fmu) {
+                c.outputVrs.push_back(from.fmu->GetValueReference(name));
+            } else if (const double* p = from.component->GetOutput(name)) {
+                c.outputPtrs.push_back(p);
+            } else {
+                throw std::runtime_error("Connection " + c.kind + ": " + from.component->GetName() + " has no output " + name);
+            }
+        }
+        for (auto& name : c.inputs) {
+            if (to.fmu) {
+                c.inputVrs.push_back(to.fmu->GetValueReference(name));
+            } else if (double* p = to.component->GetInput(name)) {
+                c.inputPtrs.push_back(p);
+            } else {
+                throw std::runtime_error("Connection " + c.kind + ": " + to.component->GetName() + " has no input " + name);
+            }
+        }
+        c.buffer.assign(c.outputs.size(), 0.0);
+    }
+
+    // Algebraic loops: cycles among feed-through instances
+    std::vector<int> ft;
+    std::vector<std::vector<double>> ftWeight(n, std::vector<double>(n, 0.0));
+    for (int i = 0; i < n; ++i) {
+        if (m_instances[i].feedthrough) ft.push_back(i);
+    }
+    for (auto& c : m_connections) {
+        if (m_instances[c.from].feedthrough && m_instances[c.to].feedthrough) ftWeight[c.from][c.to] += c.weight;
+    }
+    m_algebraicLoops.clear();
+    for (auto& comp : StronglyConnected(ft, ftWeight)) {
+        if (comp.size() > 1 || ftWeight[comp[0]][comp[0]] > 0.0) m_algebraicLoops.push_back(comp);
+    }
+
+    m_hasManual = !options.manual.empty();
+    if (m_hasManual) m_manual = EvaluateLevels(ManualLevels(options.manual));
+
+    Evaluation result;
+    if (options.optimize) {
+        result = Evaluate(InsertFeedthrough(OptimizeOrder()));
+    } else {
+        if (!m_hasManual) throw std::runtime_error("Schedule mode 'manual' requires a 'manual' stage list");
+        result = m_manual;
+    }
+    m_optimized = options.optimize;
+    m_level = result.level;
+    m_cost = result.cost;
+
+    // Levels -> stages (empty levels of a manual list are dropped)
+    m_stages.assign(result.stages, {});
+    for (int i = 0; i < n; ++i) m_stages[m_level[i]].push_back(i);
+    m_stages.erase(std::remove_if(m_stages.begin(), m_stages.end(),
+                                  [](const std::vector<int>& s) { return s.empty(); }),
+                   m_stages.end());
+}
+
+std::vector<int> ConnectionGraph::OptimizeOrder() const {
+    const int n = GetInstanceCount();
+
+    std::vector<int> nodes;
+    for (int i = 0; i < n; ++i) {
+        if (!m_instances[i].feedthrough) nodes.push_back(i);
+    }
+
+    if (nodes.size() <= kExhaustiveLimit) {
+        std::vector<int> perm = nodes;
+        std::vector<int> best = nodes;
+        Evaluation bestEval = Evaluate(InsertFeedthrough(best));
+        while (std::next_permutation(perm.begin(), perm.end())) {
+            Evaluation e = Evaluate(InsertFeedthrough(perm));
+            if (e.cost < bestEval.cost - 1e-12 ||
+                (e.cost < bestEval.cost + 1e-12 && e.stages < bestEval.stages)) {
+                best = perm;
+                bestEval = e;
+            }
+        }
+        return best;
+    }
+
+    // Dependencies between stateful instances, looking through feed-through ones:
+    // u -> F1 -> ... -> v counts as u -> v with the weakest weight on the path
+    std::vector<std::vector<double>> weight(n, std::vector<double>(n, 0.0));
+    for (int u : nodes) {
+        std::vector<bool> visited(n, false);
+        std::function<void(int, double)> walk = [&](int at, double w) {
+            for (auto& c : m_connections) {
+                if (c.from != at || visited[c.to]) continue;
+                double pw = std::min(w, c.weight);
+                if (m_instances[c.to].feedthrough) {
+                    visited[c.to] = true;
+                    walk(c.to, pw);
+                } else if (c.to != u) {
+                    weight[u][c.to] += pw;
+                }
+            }
+        };
+        walk(u, std::numeric_limits<double>::max());
+    }
+
+    std::vector<int> order;
+    for (auto& comp : StronglyConnected(nodes, weight)) {
+        auto part = OrderComponent(comp, weight);
+        order.insert(order.end(), part.begin(), part.end());
+    }
+    return order;
+}
+
+std::vector<int> ConnectionGraph::InsertFeedthrough(const std::vector<int>& order) const {
+    const int n = GetInstanceCount();
+    const double inf = std::numeric_limits<double>::infinity();
+    const double gap = 1e-3;
+
+    std::vector<double> key(n, inf);
+    for (size_t p = 0; p < order.size(); ++p) key[order[p]] = static_cast<double>(p);
+
+    // Feed-through instances go right before their first consumer
+    for (int iter = 0; iter < n; ++iter) {
+        for (int f = 0; f < n; ++f) {
+            if (!m_instances[f].feedthrough) continue;
+            double k = inf;
+            for (auto& c : m_connections) {
+                if (c.from == f && c.to != f) k = std::min(k, key[c.to] - gap);
+            }
+            key[f] = k;
+        }
+    }
+    // ... or, without consumers, right after their last producer
+    for (int f = 0; f < n; ++f) {
+        if (!m_instances[f].feedthrough || key[f] < inf) continue;
+        double k = -1.0;
+        for (auto& c : m_connections) {
+            if (c.to == f && c.from != f && key[c.from] < inf) k = std::max(k, key[c.from]);
+        }
+        key[f] = k + 0.5;
+    }
+
+    std::vector<int> all(n);
+    for (int i = 0; i < n; ++i) all[i] = i;
+    std::stable_sort(all.begin(), all.end(), [&](int a, int b) { return key[a] < key[b]; });
+    return all;
+}
+
+ConnectionGraph::Evaluation ConnectionGraph::Evaluate(const std::vector<int>& order) const {
+    const int n = GetInstanceCount();
+    std::vector<int> pos(n, 0);
+    for (int p = 0; p < n; ++p) pos[order[p]] = p;
+
+    // A connection along the order forces the consumer into a later stage
+    std::vector<int> level(n, 0);
+    for (int v : order) {
+        for (int ci : m_instances[v].inputs) {
+            const Connection& c = m_connections[ci];
+            if (pos[c.from] < pos[v]) level[v] = std::max(level[v], level[c.from] + 1);
+        }
+    }
+    return EvaluateLevels(level);
+}
+
+ConnectionGraph::Evaluation ConnectionGraph::EvaluateLevels(const std::vector<int>& level) const {
+    Evaluation e;
+    e.level = level;
+    for (int l : level) e.stages = std::max(e.stages, l + 1);
+    for (auto& c : m_connections) {
+        if (level[c.from] >= level[c.to]) e.cost += c.weight;
+    }
+    return e;
+}
+
+std::vector<int> ConnectionGraph::ManualLevels(const std::vector<std::vector<std::string>>& stages) const {
+    const int n = GetInstanceCount();
+    std::vector<int> level(n, static_cast<int>(stages.size()));
+    for (int i = 0; i < n; ++i) {
+        for (size_t s = 0; s < stages.size(); ++s) {
+            if (std::find(stages[s].begin(), stages[s].end(), m_instances[i].role) != stages[s].end()) {
+                level[i] = static_cast<int>(s);
+                break;
+            }
+        }
+        if (level[i] == static_cast<int>(stages.size())) {
+            printf("[Schedule] Warning: role '%s' is not listed in the manual schedule, stepped last\n",
+                   m_instances[i].role.c_str());
+        }
+    }
+    return level;
+}
+
+// Tarjan's algorithm; components are returned in topological order
+std::vector<std::vector<int>> ConnectionGraph::StronglyConnected(const std::vector<int>& nodes,
+                                                                 const std::vector<std::vector<double>>& weight) const {
+    const int n = GetInstanceCount();
+    std::vector<int> index(n, -1), low(n, 0);
+    std::vector<bool> onStack(n, false);
+    std::vector<int> stack;
+    std::vector<std::vector<int>> comps;
+    int counter = 0;
+
+    std::function<void(int)> visit = [&](int v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v);
+        onStack[v] = true;
+        for (int w : nodes) {
+            if (weight[v][w] <= 0.0) continue;
+            if (index[w] < 0) {
+                visit(w);
+                low[v] = std::min(low[v], low[w]);
+            } else if (onStack[w]) {
+                low[v] = std::min(low[v], index[w]);
+            }
+        }
+        if (low[v] == index[v]) {
+            std::vector<int> comp;
+            int w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                onStack[w] = false;
+                comp.push_back(w);
+            } while (w != v);
+            std::sort(comp.begin(), comp.end());
+            comps.push_back(comp);
+        }
+    };
+
+    for (int v : nodes) {
+        if (index[v] < 0) visit(v);
+    }
+    std::reverse(comps.begin(), comps.end());
+    return comps;
+}
+
+// Minimum feedback arc order of one component: exact for small components,
+// otherwise the greedy heuristic of Eades, Lin and Smyth
+std::vector<int> ConnectionGraph::OrderComponent(const std::vector<int>& nodes,
+                                                 const std::vector<std::vector<double>>& weight) const {
+    const size_t k = nodes.size();
+    if (k <= 1) return nodes;
+
+    if (k <= kExactLimit) {
+        // dp[mask]: least delayed weight when the nodes of `mask` come first
+        const size_t full = (size_t(1) << k) - 1;
+        std::vector<double> dp(full + 1, std::numeric_limits<double>::infinity());
+        std::vector<int> last(full + 1, -1);
+        dp[0] = 0.0;
+        for (size_t mask = 0; mask < full; ++mask) {
+            if (dp[mask] == std::numeric_limits<double>::infinity()) continue;
+            for (size_t x = 0; x < k; ++x) {
+                if (mask & (size_t(1) << x)) continue;
+                // Connections from x to instances already placed become delays
+                double add = 0.0;
+                for (size_t u = 0; u < k; ++u) {
+                    if (mask & (size_t(1) << u)) add += weight[nodes[x]][nodes[u]];
+                }
+                size_t next = mask | (size_t(1) << x);
+                if (dp[mask] + add < dp[next]) {
+                    dp[next] = dp[mask] + add;
+                    last[next] = static_cast<int>(x);
+                }
+            }
+        }
+        std::vector<int> order;
+        for (size_t mask = full; mask; mask &= ~(size_t(1) << last[mask])) order.push_back(nodes[last[mask]]);
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+
+    std::vector<int> head, tail;
+    std::vector<int> rest = nodes;
+    auto flow = [&](int v, bool in) {
+        double s = 0.0;
+        for (int u : rest) s += in ? weight[u][v] : weight[v][u];
+        return s;
+    };
+    while (!rest.empty()) {
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            for (size_t i = 0; i < rest.size(); ++i) {
+                int v = rest[i];
+                if (flow(v, false) <= 0.0) {
+                    tail.push_back(v);
+                } else if (flow(v, true) <= 0.0) {
+                    head.push_back(v);
+                } else {
+                    continue;
+                }
+                rest.erase(rest.begin() + i);
+                moved = true;
+                break;
+            }
+        }
+        if (rest.empty()) break;
+        auto best = std::max_element(rest.begin(), rest.end(), [&](int a, int b) {
+            return flow(a, false) - flow(a, true) < flow(b, false) - flow(b, true);
+        });
+        head.push_back(*best);
+        rest.erase(best);
+    }
+    head.insert(head.end(), tail.rbegin(), tail.rend());
+    return head;
+}
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+
+void ConnectionGraph::PrintMemoization() const {
+    for (int i = 0; i < GetInstanceCount(); ++i) {
+        const Memo& memo = m_instances[i].memo;
+        if (!memo.enabled) continue;
+        uint64_t total = memo.hits + memo.misses + memo.refreshes;
+        printf("[Memo] %s: %llu steps, %llu reused (%.1f%%), %llu evaluated, %llu forced refreshes\n",
+               GetName(i).c_str(), static_cast<unsigned long long>(total), static_cast<unsigned long long>(memo.hits),
+               total ? 100.0 * memo.hits / total : 0.0, static_cast<unsigned long long>(memo.misses),
+               static_cast<unsigned long long>(memo.refreshes));
+    }
+}
+
+void ConnectionGraph::PrintSchedule() const {
+    printf("[Schedule] %d instances, %zu connections, %s order\n",
+           GetInstanceCount(), m_connections.size(), m_optimized ? "optimized" : "manual");
+
+    std::string ft;
+    for (int i = 0; i < GetInstanceCount(); ++i) {
+        if (m_instances[i].feedthrough) ft += (ft.empty() ? "" : ", ") + GetName(i);
+    }
+    printf("[Schedule]   Feed-through: %s\n", ft.empty() ? "none" : ft.c_str());
+
+    if (m_algebraicLoops.empty()) {
+        printf("[Schedule]   Algebraic loops: none\n");
+    }
+    for (auto& loop : m_algebraicLoops) {
+        std::string names;
+        for (int i : loop) names += (names.empty() ? "" : " -> ") + GetName(i);
+        printf("[Schedule]   Algebraic loop (broken with a one-step delay): %s\n", names.c_str());
+    }
+
+    for (size_t s = 0; s < m_stages.size(); ++s) {
+        std::string names;
+        for (int i : m_stages[s]) names += (names.empty() ? "" : ", ") + GetName(i);
+        printf("[Schedule]   Stage %zu: %s\n", s, names.c_str());
+    }
+
+    printf("[Schedule]   Delayed connections: weight %.2f of %.2f\n", m_cost, m_totalWeight);
+    for (auto& c : m_connections) {
+        if (m_level[c.from] < m_level[c.to]) continue;
+        printf("[Schedule]     %s -> %s (%s, weight %.2f)\n",
+               GetName(c.from).c_str(), GetName(c.to).c_str(),
+               c.kind.c_str(), c.weight);
+    }
+    if (m_optimized && m_hasManual) {
+        printf("[Schedule]   Manual order for comparison: delayed weight %.2f, %d stages\n",
+               m_manual.cost, m_manual.stages);
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FmuHelper.h"
+#include "DemoConfiguration.h"
+
+// Settings read from "simulation.schedule" in demo_config.json
+struct ScheduleOptions {
+    bool optimize = true;                                // false: run the `manual` stages as given
+    std::vector<std::string> feedthrough = {"terrain"};  // roles whose outputs depend directly on their inputs
+    std::map<std::string, double> weights;               // connection kind -> cost of a one-step delay (default 1)
+    std::vector<std::vector<std::string>> manual;        // stages as lists of roles
+
+    static ScheduleOptions FromConfig(const DemoConfiguration& config, const std::string& root);
+};
+
+// Output memoization for instances with declared stateless semantics, read from
+// "simulation.memoization" in demo_config.json. A role listed there promises
+// that its outputs depend only on its current inputs.
+struct MemoPolicy {
+    double tolerance = 0.0;                    // max. absolute input change that reuses the outputs
+    std::map<std::string, double> tolerances;  // per input name, or per last name component ("z")
+    int refresh = 0;                           // force a real step after this many hits (0: never)
+};
+
+struct MemoOptions {
+    bool enabled = false;
+    std::map<std::string, MemoPolicy> roles;
+
+    static MemoOptions FromConfig(const DemoConfiguration& config, const std::string& root);
+};
+
+// In-process component that takes part in the schedule like an FMU instance.
+// Variables are plain doubles addressed by name; the addresses must stay valid.
+class NativeComponent {
+public:
+    virtual ~NativeComponent() = default;
+    virtual const std::string& GetName() const = 0;
+    virtual double* GetInput(const std::string& name) = 0;          // nullptr if unknown
+    virtual const double* GetOutput(const std::string& name) = 0;   // nullptr if unknown
+    virtual fmi2_status_t DoStep(double time, double step) = 0;
+};
+
+// Static Gauss-Seidel schedule for a group of co-simulated FMUs.
+//
+// A connection copies output variables of one instance to input variables of
+// another right before the consumer's stage is stepped. The consumer therefore
+// sees the value of the current substep when the producer runs in an earlier
+// stage, and the value of the previous substep (a one-step coupling delay)
+// otherwise. Build() picks the stages that minimize the summed weight of delayed
+// connections and, among equally good orders, the number of stages. Instances
+// of one stage are not connected to each other and can be stepped in parallel.
+//
+// Feed-through instances (outputs depend directly on inputs, e.g. stateless
+// terrain queries) are placed right before their first consumer. A cycle made
+// only of feed-through instances is an algebraic loop: no order resolves it, so
+// it is broken with a delay and reported.
+class ConnectionGraph {
+public:
+    using Filter = std::function<void(double* values)>;
+
+    int AddInstance(FmuHelper* fmu, const std::string& role);
+    int AddInstance(NativeComponent* component, const std::string& role);
+    int AddConnection(int from, int to, const std::string& kind,
+                      const std::vector<std::string>& outputs, const std::vector<std::string>& inputs);
+
+    // Called on the copied values before they are set on the consumer
+    void SetFilter(int connection, Filter filter);
+
+    void Build(const ScheduleOptions& options);
+
+    // Call after Build(). Memoized instances skip DoStep while all their inputs
+    // stay within tolerance of the inputs of their last real step; consumers
+    // then read the cached outputs instead of querying the instance.
+    void SetMemoization(const MemoOptions& options);
+
+    // Copies all connections into `instance` (call on the master thread)
+    void PullInputs(int instance);
+
+    void PrintSchedule() const;
+    void PrintMemoization() const;
+
+    int GetInstanceCount() const { return static_cast<int>(m_instances.size()); }
+    FmuHelper* GetFmu(int instance) const { return m_instances[instance].fmu; }  // nullptr for native components
+    const std::string& GetName(int instance) const;
+    fmi2_status_t DoStep(int instance, double time, double step);
+    const std::vector<std::vector<int>>& GetStages() const { return m_stages; }
+
+private:
+    struct Memo {
+        bool enabled = false;
+        int refresh = 0;
+        std::vector<double> tolerance;   // per input value, in connection order
+        std::vector<double> evaluated;   // inputs of the last real step
+        std::vector<double> current;
+        std::vector<std::string> outputs;
+        std::vector<fmi2_value_reference_t> outputVrs;
+        std::vector<const double*> outputPtrs;
+        std::vector<double> cache;
+
+        bool valid = false;   // cache holds the outputs of `evaluated`
+        bool skip = false;    // decided by PullInputs for the next DoStep
+        int sinceRefresh = 0;
+        double lastEnd = 0.0;
+        uint64_t hits = 0, misses = 0, refreshes = 0;
+    };
+
+    struct Instance {
+        FmuHelper* fmu = nullptr;
+        NativeComponent* component = nullptr;
+        std::string role;
+        bool feedthrough = false;
+        std::vector<int> inputs;  // connections into this instance
+        Memo memo;
+    };
+
+    struct Connection {
+        int from, to;
+        std::string kind;
+        std::vector<std::string> outputs, inputs;
+        double weight = 1.0;
+        Filter filter;
+
+        std::vector<fmi2_value_reference_t> outputVrs, inputVrs;  // FMU side
+        std::vector<const double*> outputPtrs;                     // native side
+        std::vector<double*> inputPtrs;
+        std::vector<size_t> cacheIndex;                            // memoized producer's cache
+        std::vector<double> buffer;
+    };
+
+    struct Evaluation {
+        double cost = 0.0;
+        int stages = 0;
+        std::vector<int> level;
+    };
+
+    void ReadOutputs(Instance& inst);
+    void PushInputs(const Connection& c, const double* values);
+
+    std::vector<int> OptimizeOrder() const;
+    std::vector<int> InsertFeedthrough(const std::vector<int>& order) const;
+    Evaluation Evaluate(const std::vector<int>& order) const;
+    Evaluation EvaluateLevels(const std::vector<int>& level) const;
+    std::vector<int> ManualLevels(const std::vector<std::vector<std::string>>& stages) const;
+    std::vector<std::vector<int>> StronglyConnected(const std::vector<int>& nodes,
+                                                    const std::vector<std::vector<double>>& weight) const;
+    std::vector<int> OrderComponent(const std::vector<int>& nodes,
+                                    const std::vector<std::vector<double>>& weight) const;
+
+    std::vector<Instance> m_instances;
+    std::vector<Connection> m_connections;
+
+    bool m_optimized = false;
+    std::vector<int> m_level;
+    std::vector<std::vector<int>> m_stages;
+    double m_cost = 0.0;
+    double m_totalWeight = 0.0;
+    std::vector<std::vector<int>> m_algebraicLoops;
+
+    bool m_hasManual = false;
+    Evaluation m_manual;
+};
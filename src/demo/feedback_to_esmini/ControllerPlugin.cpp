@@ -0,0 +1,117 @@
+#include "ControllerPlugin.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+
+std::string LastLoaderError() {
+#ifdef _WIN32
+    return "error " + std::to_string(GetLastError());
+#else
+    const char* err = dlerror();
+    return err ? err : "unknown error";
+#endif
+}
+
+}  // namespace
+
+ControllerPlugin::ControllerPlugin(const std::string& library, const ControllerParameters& parameters)
+    : m_library(library) {
+#ifdef _WIN32
+    m_handle = reinterpret_cast<void*>(LoadLibraryA(library.c_str()));
+#else
+    m_handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+    if (!m_handle) throw std::runtime_error("Cannot load controller plugin " + library + ": " + LastLoaderError());
+
+    try {
+        auto version = reinterpret_cast<int (*)()>(Symbol("GtNativeControllerApiVersion"));
+        auto create = reinterpret_cast<CreateFn>(Symbol("GtNativeControllerCreate"));
+        m_destroy = reinterpret_cast<DestroyFn>(Symbol("GtNativeControllerDestroy"));
+        if (version() != GT_NATIVE_CONTROLLER_API_VERSION) {
+            throw std::runtime_error("Controller plugin " + library + " has API version " + std::to_string(version()) +
+                                     ", expected " + std::to_string(GT_NATIVE_CONTROLLER_API_VERSION));
+        }
+        m_controller = create(parameters);
+        if (!m_controller) throw std::runtime_error("Controller plugin " + library + " returned no controller");
+    } catch (...) {
+        Unload();
+        throw;
+    }
+
+    printf("[Controller] Loaded native controller %s (%zu parameters)\n", library.c_str(), parameters.size());
+}
+
+ControllerPlugin::~ControllerPlugin() {
+    if (m_controller) m_destroy(m_controller);
+    Unload();
+}
+
+void* ControllerPlugin::Symbol(const char* name) const {
+#ifdef _WIN32
+    void* sym = reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(m_handle), name));
+#else
+    void* sym = dlsym(m_handle, name);
+#endif
+    if (!sym) throw std::runtime_error("Controller plugin " + m_library + " does not export " + name);
+    return sym;
+}
+
+void ControllerPlugin::Unload() {
+    if (!m_handle) return;
+#ifdef _WIN32
+    FreeLibrary(reinterpret_cast<HMODULE>(m_handle));
+#else
+    dlclose(m_handle);
+#endif
+    m_handle = nullptr;
+}
+
+bool ControllerPlugin::Step(double time, double step, const osi3::SensorView& view, const StaticGroundTruth& map,
+                            const std::vector<const osi3::SensorData*>& sensors, const ControllerEgoState& ego,
+                            ControlCommand& command) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = m_controller->Step(time, step, view, map, sensors, ego, command);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    ++m_steps;
+    m_totalUs += us;
+    if (us > m_maxUs) m_maxUs = us;
+    return ok;
+}
+
+void ControllerPlugin::PrintStats() const {
+    printf("[Controller] %s: %llu steps, mean %.2f us, max %.2f us per step\n", m_library.c_str(),
+           static_cast<unsigned long long>(m_steps), m_steps ? m_totalUs / m_steps : 0.0, m_maxUs);
+}
+
+std::unique_ptr<ControllerPlugin> ControllerPlugin::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    std::string library = config.GetString(root + ".native.library", "");
+    if (library.empty()) throw std::runtime_error("Missing config: " + root + ".native.library");
+
+    ControllerParameters parameters;
+    auto val = config.Get(root + ".native.parameters");
+    if (val.type == MiniJSON::Type::Object) {
+        for (auto& [key, v] : val.o_val) {
+            if (v.type == MiniJSON::Type::String) {
+                parameters[key] = v.s_val;
+            } else if (v.type == MiniJSON::Type::Number) {
+                char buf[32];
+                snprintf(buf, sizeof(buf), "%.17g", v.n_val);
+                parameters[key] = buf;
+            } else if (v.type == MiniJSON::Type::Boolean) {
+                parameters[key] = v.b_val ? "true" : "false";
+            }
+        }
+    }
+    return std::make_unique<ControllerPlugin>(std::filesystem::absolute(library).string(), parameters);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "DemoConfiguration.h"
+#include "NativeController.h"
+
+// Host side of the native controller plugin API (NativeController.h).
+//
+// Loads the shared library, checks its API version and owns the controller
+// instance it creates. The library stays loaded for the lifetime of this
+// object. Step() times each controller call for PrintStats().
+class ControllerPlugin {
+public:
+    // Throws std::runtime_error if the library cannot be loaded, lacks an entry
+    // point, has another API version or fails to create the controller
+    ControllerPlugin(const std::string& library, const ControllerParameters& parameters);
+    ~ControllerPlugin();
+
+    ControllerPlugin(const ControllerPlugin&) = delete;
+    ControllerPlugin& operator=(const ControllerPlugin&) = delete;
+
+    bool Step(double time, double step, const osi3::SensorView& view, const StaticGroundTruth& map,
+              const std::vector<const osi3::SensorData*>& sensors, const ControllerEgoState& ego,
+              ControlCommand& command);
+    void PrintStats() const;
+
+    // Reads "<root>.native.library" (relative to the working directory) and "<root>.native.parameters"
+    static std::unique_ptr<ControllerPlugin> FromConfig(const DemoConfiguration& config, const std::string& root);
+
+private:
+    using CreateFn = NativeController* (*)(const ControllerParameters&);
+    using DestroyFn = void (*)(NativeController*);
+
+    void* Symbol(const char* name) const;
+    void Unload();
+
+    std::string m_library;
+    void* m_handle = nullptr;
+    DestroyFn m_destroy = nullptr;
+    NativeController* m_controller = nullptr;
+
+    uint64_t m_steps = 0;
+    double m_totalUs = 0.0, m_maxUs = 0.0;
+};
@@ -0,0 +1,466 @@
+#include "CrgSurface.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+std::string Lower(std::string s) {
+    for (auto& ch : s) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return s;
+}
+
+std::string Trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// Strips a trailing "! comment"
+std::string StripComment(const std::string& s) {
+    size_t bang = s.find('!');
+    return Trim(bang == std::string::npos ? s : s.substr(0, bang));
+}
+
+const size_t kChunkRows = 64;
+
+}  // namespace
+
+CrgSurface::CrgSurface(const std::string& path, const Placement& placement, size_t numSlots)
+    : m_name(std::filesystem::path(path).filename().string()), m_placement(placement),
+      m_hint(numSlots, std::numeric_limits<size_t>::max()) {
+    m_file = std::make_unique<MappedFile>(path);
+    const char* text = reinterpret_cast<const char*>(m_file->GetData());
+    const size_t size = m_file->GetSize();
+
+    size_t dataOffset = 0;
+    ParseHeader(text, size, dataOffset);
+
+    if (m_encoding == Encoding::Parsed) {
+        ParseAscii(text + dataOffset, size - dataOffset, m_rowBytes == 8 * static_cast<size_t>(m_channels) ? 20 : 10);
+        // The text is no longer needed once parsed
+        m_file.reset();
+    } else {
+        if (dataOffset + m_rows * m_rowBytes > size) {
+            throw std::runtime_error("CRG: " + path + " is truncated (" + std::to_string(m_rows) + " rows expected)");
+        }
+        m_data = reinterpret_cast<const unsigned char*>(text + dataOffset);
+    }
+
+    // The first chunk; Update() integrates the rest as the wheels reach it
+    ExtendReferenceLine();
+
+    printf("[Terrain] CRG %s: u %.1f..%.1f m (%zu rows), v %.2f..%.2f m (%zu long sections), %s\n",
+           m_name.c_str(), m_u0, m_u0 + (m_rows - 1) * m_du, m_rows, m_v.front(), m_v.back(), m_v.size(),
+           m_encoding == Encoding::Parsed ? "ASCII (parsed)" : "binary (memory-mapped)");
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+void CrgSurface::ParseHeader(const char* text, size_t size, size_t& dataOffset) {
+    std::string section;
+    std::string format;
+    std::vector<std::string> channels;
+    double endU = std::numeric_limits<double>::quiet_NaN();
+    bool hasEndZ = false;
+
+    size_t pos = 0;
+    bool dataFound = false;
+    while (pos < size) {
+        size_t eol = pos;
+        while (eol < size && text[eol] != '\n') ++eol;
+        std::string line(text + pos, eol - pos);
+        pos = eol + 1;
+
+        if (line.compare(0, 4, "$$$$") == 0) {
+            dataFound = true;
+            break;
+        }
+        if (line.empty() || line[0] == '*') continue;
+        if (line[0] == '$') {
+            std::string name = Lower(StripComment(line.substr(1)));
+            section = name.substr(0, name.find_first_of(" \t"));
+            continue;
+        }
+
+        if (section == "road_crg") {
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key = Lower(Trim(line.substr(0, eq)));
+            double value = std::strtod(StripComment(line.substr(eq + 1)).c_str(), nullptr);
+            if (key == "reference_line_start_u") m_u0 = value;
+            else if (key == "reference_line_end_u") endU = value;
+            else if (key == "reference_line_increment") m_du = value;
+            else if (key == "reference_line_start_x") m_startX = value;
+            else if (key == "reference_line_start_y") m_startY = value;
+            else if (key == "reference_line_start_z") m_startZ = value;
+            else if (key == "reference_line_end_z") { m_endZ = value; hasEndZ = true; }
+            else if (key == "reference_line_start_phi") m_startPhi = value;
+            else if (key == "long_section_v_right") m_vRight = value;
+            else if (key == "long_section_v_left") m_vLeft = value;
+            else if (key == "long_section_v_increment") m_vIncrement = value;
+        } else if (section == "kd_definition") {
+            std::string entry = StripComment(line);
+            if (entry.compare(0, 2, "#:") == 0) format = Trim(entry.substr(2));
+            else if (entry.compare(0, 2, "D:") == 0) channels.push_back(Lower(Trim(entry.substr(2, entry.find(',') - 2))));
+        }
+    }
+    if (!dataFound) throw std::runtime_error("CRG: " + m_name + " has no data section");
+    dataOffset = pos;
+    if (!hasEndZ) m_endZ = m_startZ;
+
+    if (!(m_du > 0.0) || !(endU > m_u0)) throw std::runtime_error("CRG: " + m_name + " has an invalid reference line");
+    m_rows = static_cast<size_t>(std::llround((endU - m_u0) / m_du)) + 1;
+
+    m_channels = static_cast<int>(channels.size());
+    size_t valueBytes = 4;
+    if (format == "KRBI") m_encoding = Encoding::Float32BE;
+    else if (format == "KDBI") { m_encoding = Encoding::Float64BE; valueBytes = 8; }
+    else if (format == "LRFI") m_encoding = Encoding::Parsed;
+    else if (format == "LDFI") { m_encoding = Encoding::Parsed; valueBytes = 8; }
+    else throw std::runtime_error("CRG: " + m_name + " uses unsupported data format '" + format + "'");
+    m_rowBytes = valueBytes * channels.size();
+
+    // Channel roles; long sections are either "at v = <v>" or numbered from v_right
+    std::vector<std::pair<double, int>> sections;
+    std::vector<int> numbered;
+    for (int ch = 0; ch < m_channels; ++ch) {
+        const std::string& name = channels[ch];
+        const std::string at = "long section at v =";
+        if (name == "reference line phi") m_phiChannel = ch;
+        else if (name == "reference line slope") m_slopeChannel = ch;
+        else if (name == "reference line banking") m_bankChannel = ch;
+        else if (name.compare(0, at.size(), at) == 0) sections.emplace_back(std::strtod(name.c_str() + at.size(), nullptr), ch);
+        else if (name.compare(0, 12, "long section") == 0) numbered.push_back(ch);
+    }
+    if (!numbered.empty()) {
+        double inc = m_vIncrement > 0.0 ? m_vIncrement
+                     : numbered.size() > 1 ? (m_vLeft - m_vRight) / (numbered.size() - 1) : 0.0;
+        for (size_t k = 0; k < numbered.size(); ++k) sections.emplace_back(m_vRight + k * inc, numbered[k]);
+    }
+    if (sections.empty()) throw std::runtime_error("CRG: " + m_name + " has no long sections");
+
+    std::sort(sections.begin(), sections.end());
+    for (auto& s : sections) {
+        m_v.push_back(s.first);
+        m_zChannels.push_back(s.second);
+    }
+}
+
+// IPLOS formatted records: fixed-width fields, 80 columns per line, every record
+// starts on a new line. Non-numeric fields (*unused*, *missing*) become NaN.
+void CrgSurface::ParseAscii(const char* text, size_t size, int width) {
+    const int perLine = 80 / width;
+    m_parsed.clear();
+    m_parsed.reserve(m_rows * m_channels);
+
+    size_t pos = 0;
+    size_t rows = 0;
+    while (rows < m_rows && pos < size) {
+        for (int ch = 0; ch < m_channels && pos < size;) {
+            size_t eol = pos;
+            while (eol < size && text[eol] != '\n') ++eol;
+            std::string line(text + pos, eol - pos);
+            pos = eol + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            for (int f = 0; f < perLine && ch < m_channels; ++f, ++ch) {
+                std::string field = static_cast<size_t>(f * width) < line.size() ? line.substr(f * width, width) : "";
+                char* end = nullptr;
+                double value = std::strtod(field.c_str(), &end);
+                m_parsed.push_back(end != field.c_str() ? static_cast<float>(value)
+                                                        : std::numeric_limits<float>::quiet_NaN());
+            }
+        }
+        if (m_parsed.size() == (rows + 1) * m_channels) ++rows;
+    }
+    m_parsed.resize(rows * m_channels);
+    if (rows < 2) throw std::runtime_error("CRG: " + m_name + " has fewer than two data records");
+    m_rows = rows;
+}
+
+// Integrates the reference line from the heading and slope channels, one chunk
+// of rows per call. Row 0 of these channels is unused; row r holds the values of
+// the segment ending at r.
+bool CrgSurface::ExtendReferenceLine() {
+    if (m_refX.empty()) {
+        m_refX.push_back(m_startX);
+        m_refY.push_back(m_startY);
+        m_refZ.push_back(m_startZ);
+        m_refPhi = m_startPhi;
+    }
+    const size_t b = m_refX.size() - 1;
+    if (b + 1 >= m_rows) return false;
+    const size_t end = std::min(b + kChunkRows, m_rows - 1);
+
+    const double defaultSlope = (m_endZ - m_startZ) / ((m_rows - 1) * m_du);
+    for (size_t r = b + 1; r <= end; ++r) {
+        if (m_phiChannel >= 0) {
+            double p = Sample(r, m_phiChannel);
+            if (std::isfinite(p)) m_refPhi = p;
+        }
+        double slope = defaultSlope;
+        if (m_slopeChannel >= 0) {
+            slope = Sample(r, m_slopeChannel);
+            if (!std::isfinite(slope)) slope = 0.0;
+        }
+        m_refX.push_back(m_refX[r - 1] + m_du * std::cos(m_refPhi));
+        m_refY.push_back(m_refY[r - 1] + m_du * std::sin(m_refPhi));
+        m_refZ.push_back(m_refZ[r - 1] + m_du * slope);
+    }
+
+    // Bounding circle of the chunk, widened by the road half width
+    const double width = std::max(std::fabs(m_v.front()), std::fabs(m_v.back()));
+    Chunk c;
+    c.begin = b;
+    c.end = end;
+    double x0 = m_refX[b], x1 = x0, y0 = m_refY[b], y1 = y0;
+    for (size_t r = b; r <= end; ++r) {
+        x0 = std::min(x0, m_refX[r]);
+        x1 = std::max(x1, m_refX[r]);
+        y0 = std::min(y0, m_refY[r]);
+        y1 = std::max(y1, m_refY[r]);
+    }
+    c.cx = 0.5 * (x0 + x1);
+    c.cy = 0.5 * (y0 + y1);
+    c.radius = 0.5 * std::hypot(x1 - x0, y1 - y0) + width;
+    m_chunks.push_back(c);
+    return true;
+}
+
+double CrgSurface::Sample(size_t row, int channel) const {
+    switch (m_encoding) {
+        case Encoding::Float32BE: {
+            const unsigned char* b = m_data + row * m_rowBytes + 4 * static_cast<size_t>(channel);
+            uint32_t bits = (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+        case Encoding::Float64BE: {
+            const unsigned char* b = m_data + row * m_rowBytes + 8 * static_cast<size_t>(channel);
+            uint64_t bits = 0;
+            for (int k = 0; k < 8; ++k) bits = (bits << 8) | b[k];
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+        case Encoding::Parsed:
+            break;
+    }
+    return m_parsed[row * m_channels + channel];
+}
+
+// -----------------------------------------------------------------------------
+// Query
+// -----------------------------------------------------------------------------
+
+bool CrgSurface::SearchChunks(double px, double py, size_t& segment) const {
+    double bestDist = std::numeric_limits<double>::infinity();
+    for (const Chunk& c : m_chunks) {
+        double dx = px - c.cx, dy = py - c.cy;
+        if (dx * dx + dy * dy > c.radius * c.radius) continue;
+        for (size_t k = c.begin; k < c.end; ++k) {
+            double sx = m_refX[k + 1] - m_refX[k], sy = m_refY[k + 1] - m_refY[k];
+            double ox = px - m_refX[k], oy = py - m_refY[k];
+            double t = std::min(std::max((ox * sx + oy * sy) / (sx * sx + sy * sy), 0.0), 1.0);
+            double ex = ox - t * sx, ey = oy - t * sy;
+            double d = ex * ex + ey * ey;
+            if (d < bestDist) {
+                bestDist = d;
+                segment = k;
+            }
+        }
+    }
+    return bestDist < std::numeric_limits<double>::infinity();
+}
+
+bool CrgSurface::NearChunk(const Chunk& c, double px, double py) const {
+    double dx = px - c.cx, dy = py - c.cy;
+    if (dx * dx + dy * dy > c.radius * c.radius) return false;
+    const double width = std::max(std::fabs(m_v.front()), std::fabs(m_v.back()));
+    for (size_t k = c.begin; k < c.end; ++k) {
+        double sx = m_refX[k + 1] - m_refX[k], sy = m_refY[k + 1] - m_refY[k];
+        double ox = px - m_refX[k], oy = py - m_refY[k];
+        double t = std::min(std::max((ox * sx + oy * sy) / (sx * sx + sy * sy), 0.0), 1.0);
+        double ex = ox - t * sx, ey = oy - t * sy;
+        if (ex * ex + ey * ey <= width * width) return true;
+    }
+    return false;
+}
+
+bool CrgSurface::Locate(double px, double py, size_t& segment, double& t, double& v, size_t& hint) const {
+    const size_t segments = m_refX.size() - 1;
+
+    auto project = [&](size_t k) {
+        double sx = m_refX[k + 1] - m_refX[k], sy = m_refY[k + 1] - m_refY[k];
+        double ox = px - m_refX[k], oy = py - m_refY[k];
+        double len2 = sx * sx + sy * sy;
+        t = (ox * sx + oy * sy) / len2;
+        v = (sx * oy - sy * ox) / std::sqrt(len2);  // positive to the left
+    };
+    auto onRoad = [&]() { return v >= m_v.front() && v <= m_v.back(); };
+
+    // Walk from the last segment of this slot; stop when the projection falls
+    // into the segment or flips back and forth across a joint
+    bool found = false;
+    if (hint < segments) {
+        size_t k = hint;
+        int last = 0;
+        for (int step = 0; step < 32; ++step) {
+            project(k);
+            int dir = (t < 0.0 && k > 0) ? -1 : (t > 1.0 && k + 1 < segments) ? 1 : 0;
+            if (dir == 0 || dir == -last) {
+                found = onRoad();
+                segment = k;
+                break;
+            }
+            k += dir;
+            last = dir;
+        }
+    }
+    if (!found) {
+        if (!SearchChunks(px, py, segment)) return false;
+        project(segment);
+    }
+    hint = segment;
+
+    // Before the start, or past the last integrated row (the end of the road once complete)
+    if ((segment == 0 && t < 0.0) || (segment + 1 == segments && t > 1.0)) return false;
+    t = std::min(std::max(t, 0.0), 1.0);
+    return onRoad();
+}
+
+void CrgSurface::Update(size_t n, const double* x, const double* y) {
+    const double c = std::cos(m_placement.yaw), s = std::sin(m_placement.yaw);
+    for (size_t i = 0; i < n; ++i) {
+        double dx = x[i] - m_placement.x, dy = y[i] - m_placement.y;
+        double lx = c * dx + s * dy;
+        double ly = -s * dx + c * dy;
+
+        size_t scratch = std::numeric_limits<size_t>::max();
+        size_t& hint = i < m_hint.size() ? m_hint[i] : scratch;
+        size_t k = 0;
+        double t = 0.0, v = 0.0;
+        if (Locate(lx, ly, k, t, v, hint)) continue;
+        while (ExtendReferenceLine()) {
+            if (NearChunk(m_chunks.back(), lx, ly)) break;
+        }
+    }
+}
+
+void CrgSurface::PrintStats() const {
+    printf("[Terrain] CRG %s: reference line integrated for %zu of %zu rows\n",
+           m_name.c_str(), m_refX.size(), m_rows);
+}
+
+void CrgSurface::Query(size_t first, size_t n, const double* x, const double* y, double* top,
+                       double* height, double* nx, double* ny, double* nz, double* mu) const {
+    const double c = std::cos(m_placement.yaw), s = std::sin(m_placement.yaw);
+    const double invDu = 1.0 / m_du;
+    const size_t columns = m_v.size();
+    const size_t noHint = std::numeric_limits<size_t>::max();
+
+    const size_t chunk = 64;
+    size_t row[chunk];
+    double fu[chunk], fv[chunk], vv[chunk], invDv[chunk], hx[chunk], hy[chunk];
+    double g00[chunk], g10[chunk], g01[chunk], g11[chunk], b0[chunk], b1[chunk];
+    bool covered[chunk];
+
+    for (size_t base = 0; base < n; base += chunk) {
+        const size_t m = std::min(chunk, n - base);
+
+        // Pass 1: project onto the reference line (scalar, data dependent walk)
+        size_t col[chunk];
+        for (size_t i = 0; i < m; ++i) {
+            double dx = x[base + i] - m_placement.x, dy = y[base + i] - m_placement.y;
+            double lx = c * dx + s * dy;
+            double ly = -s * dx + c * dy;
+
+            size_t slot = first + base + i;
+            size_t scratch = noHint;
+            size_t& hint = slot < m_hint.size() ? m_hint[slot] : scratch;
+
+            size_t k = 0;
+            double t = 0.0, v = 0.0;
+            covered[i] = Locate(lx, ly, k, t, v, hint);
+            if (!covered[i]) {
+                k = 0;
+                t = 0.0;
+                v = m_v.front();
+            }
+
+            size_t j = static_cast<size_t>(std::upper_bound(m_v.begin(), m_v.end(), v) - m_v.begin());
+            j = j > 0 ? j - 1 : 0;
+            size_t j1 = std::min(j + 1, columns - 1);
+            double span = m_v[j1] - m_v[j];
+
+            row[i] = k;
+            col[i] = j;
+            fu[i] = t;
+            vv[i] = v;
+            invDv[i] = span > 0.0 ? 1.0 / span : 0.0;
+            fv[i] = span > 0.0 ? (v - m_v[j]) * invDv[i] : 0.0;
+
+            double sx = (m_refX[k + 1] - m_refX[k]) * invDu, sy = (m_refY[k + 1] - m_refY[k]) * invDu;
+            hx[i] = c * sx - s * sy;  // segment heading in the world
+            hy[i] = s * sx + c * sy;
+        }
+
+        // Pass 2: gather the four grid samples and the banking of both rows
+        for (size_t i = 0; i < m; ++i) {
+            size_t j = col[i], j1 = std::min(j + 1, columns - 1);
+            auto grid = [&](size_t r, size_t cc) {
+                double z = Sample(r, m_zChannels[cc]);
+                return std::isfinite(z) ? z : 0.0;
+            };
+            g00[i] = grid(row[i], j);
+            g01[i] = grid(row[i], j1);
+            g10[i] = grid(row[i] + 1, j);
+            g11[i] = grid(row[i] + 1, j1);
+            double bank0 = m_bankChannel >= 0 ? Sample(row[i], m_bankChannel) : 0.0;
+            double bank1 = m_bankChannel >= 0 ? Sample(row[i] + 1, m_bankChannel) : 0.0;
+            b0[i] = std::isfinite(bank0) ? bank0 : 0.0;
+            b1[i] = std::isfinite(bank1) ? bank1 : 0.0;
+        }
+
+        // Pass 3: bilinear height and normal over SoA arrays, branch free
+        for (size_t i = 0; i < m; ++i) {
+            const double u = fu[i], w = fv[i], v = vv[i];
+            const double z0 = m_refZ[row[i]], z1 = m_refZ[row[i] + 1];
+
+            double grid = (1 - u) * ((1 - w) * g00[i] + w * g01[i]) + u * ((1 - w) * g10[i] + w * g11[i]);
+            double bank = (1 - u) * b0[i] + u * b1[i];
+            double zi = z0 + u * (z1 - z0) + v * bank + grid;
+
+            double dzdu = ((z1 - z0) + v * (b1[i] - b0[i]) + (1 - w) * (g10[i] - g00[i]) + w * (g11[i] - g01[i])) * invDu;
+            double dzdv = bank + ((1 - u) * (g01[i] - g00[i]) + u * (g11[i] - g10[i])) * invDv[i];
+
+            // World gradient from the along-road (heading) and lateral (left) slopes
+            double gx = dzdu * hx[i] - dzdv * hy[i];
+            double gy = dzdu * hy[i] + dzdv * hx[i];
+            double inv = 1.0 / std::sqrt(gx * gx + gy * gy + 1.0);
+            double wz = m_placement.z + zi;
+
+            bool take = covered[i] && wz > top[base + i];
+            top[base + i] = take ? wz : top[base + i];
+            height[base + i] = take ? wz : height[base + i];
+            nx[base + i] = take ? -gx * inv : nx[base + i];
+            ny[base + i] = take ? -gy * inv : ny[base + i];
+            nz[base + i] = take ? inv : nz[base + i];
+            mu[base + i] = take ? m_placement.mu : mu[base + i];
+        }
+    }
+}
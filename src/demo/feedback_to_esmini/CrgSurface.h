@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "NativeTerrain.h"
+
+// OpenCRG road surface (crg_roads/*.crg of the Terrain FMU resources).
+//
+// Binary files (KRBI/KDBI, big-endian float/double records) are memory-mapped
+// and read in place, so multi-kilometre roads are paged in only where wheels
+// actually drive. ASCII files (LRFI/LDFI) are small hand-written examples and
+// are parsed into memory. The reference line is integrated from the
+// heading/slope channels (one point per u row) lazily, in chunks of 64 rows
+// with a bounding circle that index the road for the (x, y) -> (u, v)
+// projection: Update() extends it chunk by chunk until every query point lies
+// on an integrated chunk, so only rows up to the wheels are read. A point off
+// the road integrates the rest of the line once. Each query slot remembers its
+// last reference-line segment, so per-step projections are a short walk along
+// the line.
+//
+// Height = reference-line z + v * banking + bilinear grid value; the normal
+// follows from the same bilinear patch. Points outside [u_start, u_end] x
+// [v_right, v_left] are not covered. NaN grid values count as 0 (no offset from
+// the reference line). $ROAD_CRG_MODS are not applied; the file is placed with
+// the `placement` given here instead.
+class CrgSurface : public TerrainSurface {
+public:
+    struct Placement {
+        double x = 0.0, y = 0.0, z = 0.0;  // world position of the CRG origin
+        double yaw = 0.0;                  // rotation of the CRG frame [rad]
+        double mu = 0.8;
+    };
+
+    // Throws std::runtime_error on unreadable or malformed files
+    CrgSurface(const std::string& path, const Placement& placement, size_t numSlots);
+
+    const std::string& GetName() const override { return m_name; }
+    void Query(size_t first, size_t n, const double* x, const double* y, double* top,
+               double* height, double* nx, double* ny, double* nz, double* mu) const override;
+    void Update(size_t n, const double* x, const double* y) override;
+    void PrintStats() const override;
+
+private:
+    enum class Encoding { Float32BE, Float64BE, Parsed };
+
+    struct Chunk {
+        size_t begin, end;  // segments [begin, end)
+        double cx, cy, radius;
+    };
+
+    void ParseHeader(const char* text, size_t size, size_t& dataOffset);
+    void ParseAscii(const char* text, size_t size, int width);
+    // Integrates the next chunk of the reference line; false once the line is complete
+    bool ExtendReferenceLine();
+
+    double Sample(size_t row, int channel) const;
+    // Reference-line segment and (u, v) of a point in the CRG frame; false if not covered
+    bool Locate(double px, double py, size_t& segment, double& t, double& v, size_t& hint) const;
+    bool SearchChunks(double px, double py, size_t& segment) const;
+    // Whether a point (CRG frame) lies within the road half width of a chunk's segments
+    bool NearChunk(const Chunk& c, double px, double py) const;
+
+    std::string m_name;
+    Placement m_placement;
+
+    std::unique_ptr<MappedFile> m_file;
+    const unsigned char* m_data = nullptr;  // first record
+    Encoding m_encoding = Encoding::Float32BE;
+    std::vector<float> m_parsed;            // ASCII formats
+    int m_channels = 0;
+    size_t m_rowBytes = 0;
+    size_t m_rows = 0;
+
+    // Header
+    double m_u0 = 0.0, m_du = 0.0;
+    double m_startX = 0.0, m_startY = 0.0, m_startZ = 0.0, m_endZ = 0.0;
+    double m_startPhi = 0.0;
+    double m_vRight = 0.0, m_vLeft = 0.0, m_vIncrement = 0.0;
+    int m_phiChannel = -1, m_slopeChannel = -1, m_bankChannel = -1;
+    std::vector<int> m_zChannels;   // long sections, sorted by v
+    std::vector<double> m_v;
+
+    // Reference line (CRG frame), one point per integrated row
+    std::vector<double> m_refX, m_refY, m_refZ;
+    double m_refPhi = 0.0;  // heading at the last integrated row
+
+    std::vector<Chunk> m_chunks;
+
+    mutable std::vector<size_t> m_hint;  // last segment per query slot
+};
@@ -11,15 +11,17 @@
 #include <stdexcept>
 
 // Minimal JSON Parser for Configuration
-// Supports: Object, String, Number, Boolean, Null
-// Does NOT support: Array (simplification for config map), Escaped characters in strings (basic)
+// Supports: Object, Array, String, Number, Boolean, Null, // and /* */ comments
+// (as used by Chrono data files)
+// Does NOT support: Escaped characters in strings (basic)
 
 namespace MiniJSON {
 
-enum class Type { Null, Object, String, Number, Boolean };
+enum class Type { Null, Object, Array, String, Number, Boolean };
 
 struct Value;
 using Object = std::map<std::string, Value>;
+using Array = std::vector<Value>;
 
 struct Value {
     Type type = Type::Null;
@@ -27,12 +29,14 @@ struct Value {
     double n_val = 0.0;
     bool b_val = false;
     Object o_val;
+    Array a_val;
 
     Value() = default;
     Value(std::string s) : type(Type::String), s_val(s) {}
     Value(double n) : type(Type::Number), n_val(n) {}
     Value(bool b) : type(Type::Boolean), b_val(b) {}
     Value(Object o) : type(Type::Object), o_val(o) {}
+    Value(Array a) : type(Type::Array), a_val(a) {}
 
     // Helpers
     std::string as_string() const {
@@ -66,7 +70,19 @@ class Parser {
     size_t pos = 0;
 
     void skip_whitespace() {
-        while (pos < str.size() && std::isspace(str[pos])) pos++;
+        while (pos < str.size()) {
+            if (std::isspace(static_cast<unsigned char>(str[pos]))) {
+                pos++;
+            } else if (str.compare(pos, 2, "//") == 0) {
+                pos = str.find('\n', pos);
+                if (pos == std::string::npos) pos = str.size();
+            } else if (str.compare(pos, 2, "/*") == 0) {
+                pos = str.find("*/", pos + 2);
+                pos = (pos == std::string::npos) ? str.size() : pos + 2;
+            } else {
+                break;
+            }
+        }
     }
 
     char peek() {
@@ -111,6 +127,7 @@ class Parser {
     Value parse_value() {
         char c = peek();
         if (c == '{') return parse_object();
+        if (c == '[') return parse_array();
         if (c == '"') return parse_string();
         if (isdigit(c) || c == '-') return parse_number();
         if (str.substr(pos, 4) == "true") { pos += 4; return true; }
@@ -141,6 +158,25 @@ class Parser {
         return obj;
     }
 
+    Value parse_array() {
+        expect('[');
+        Array arr;
+        if (peek() == ']') {
+            get();
+            return arr;
+        }
+        while (true) {
+            arr.push_back(parse_value());
+            char c = peek();
+            if (c == ']') {
+                get();
+                break;
+            }
+            expect(',');
+        }
+        return arr;
+    }
+
 public:
     Parser(const std::string& s) : str(s) {}
     Value parse() { return parse_value(); }
@@ -0,0 +1,140 @@
+// Example native controller plugin (gt_example_controller): follows the
+// centerline of the ego's assigned lane with pure pursuit and holds a target
+// speed, falling back to a constant time gap behind the nearest object ahead
+// in the same lane. With host sensors configured, that object is taken from
+// their detections; otherwise from the ground truth.
+//
+// Parameters (drivecontroller.native.parameters):
+//   target_speed [m/s] 15, time_gap [s] 1.8, min_gap [m] 5, lookahead_time [s] 1.0,
+//   min_lookahead [m] 6, wheelbase [m] 3.4, max_steer [rad] 0.6 (road wheel angle
+//   at steering = 1), speed_gain [1/s] 0.5, gap_gain [1/s^2] 0.2, max_accel [m/s^2] 3,
+//   max_decel [m/s^2] 8, lane_half_width [m] 1.75
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "NativeController.h"
+#include "osi_groundtruth.pb.h"
+
+namespace {
+
+double Param(const ControllerParameters& p, const char* key, double fallback) {
+    auto it = p.find(key);
+    return it == p.end() ? fallback : std::stod(it->second);
+}
+
+double Clamp(double v, double lo, double hi) { return std::min(std::max(v, lo), hi); }
+
+class ExampleController : public NativeController {
+public:
+    explicit ExampleController(const ControllerParameters& p)
+        : m_targetSpeed(Param(p, "target_speed", 15.0)), m_timeGap(Param(p, "time_gap", 1.8)),
+          m_minGap(Param(p, "min_gap", 5.0)), m_lookaheadTime(Param(p, "lookahead_time", 1.0)),
+          m_minLookahead(Param(p, "min_lookahead", 6.0)), m_wheelbase(Param(p, "wheelbase", 3.4)),
+          m_maxSteer(Param(p, "max_steer", 0.6)), m_speedGain(Param(p, "speed_gain", 0.5)),
+          m_gapGain(Param(p, "gap_gain", 0.2)), m_maxAccel(Param(p, "max_accel", 3.0)),
+          m_maxDecel(Param(p, "max_decel", 8.0)), m_laneHalfWidth(Param(p, "lane_half_width", 1.75)) {}
+
+    bool Step(double, double, const osi3::SensorView& view, const StaticGroundTruth& map,
+              const std::vector<const osi3::SensorData*>& sensors, const ControllerEgoState& ego,
+              ControlCommand& command) override {
+        const osi3::GroundTruth& gt = view.global_ground_truth();
+        double c = std::cos(ego.yaw), s = std::sin(ego.yaw);
+
+        // Longitudinal: speed keeping, limited by the gap to the nearest object ahead in the lane
+        double accel = m_speedGain * (m_targetSpeed - ego.speed);
+        double halfLength = ego.object ? 0.5 * ego.object->base().dimension().length() : 0.0;
+        double gap = std::numeric_limits<double>::max(), leadSpeed = 0.0;
+        auto consider = [&](double ahead, double lateral, double length, double speed) {
+            if (ahead <= 0.0 || std::abs(lateral) > m_laneHalfWidth) return;
+            double g = ahead - halfLength - 0.5 * length;
+            if (g < gap) gap = g, leadSpeed = speed;
+        };
+        if (!sensors.empty()) {
+            // Detections are in the sensor frame, velocities relative to the ego
+            for (const osi3::SensorData* data : sensors) {
+                const auto& mount = data->mounting_position();
+                double mc = std::cos(mount.orientation().yaw()), ms = std::sin(mount.orientation().yaw());
+                for (const auto& obj : data->moving_object()) {
+                    const auto& p = obj.base().position();
+                    const auto& v = obj.base().velocity();
+                    consider(mount.position().x() + mc * p.x() - ms * p.y(), mount.position().y() + ms * p.x() + mc * p.y(),
+                             obj.base().dimension().length(), ego.speed + mc * v.x() - ms * v.y());
+                }
+            }
+        } else {
+            for (const auto& obj : gt.moving_object()) {
+                if (obj.id().value() == ego.id) continue;
+                double dx = obj.base().position().x() - ego.pos[0], dy = obj.base().position().y() - ego.pos[1];
+                consider(c * dx + s * dy, -s * dx + c * dy, obj.base().dimension().length(),
+                         c * obj.base().velocity().x() + s * obj.base().velocity().y());
+            }
+        }
+        if (gap < std::numeric_limits<double>::max()) {
+            double desired = m_minGap + m_timeGap * ego.speed;
+            accel = std::min(accel, m_gapGain * (gap - desired) + m_speedGain * (leadSpeed - ego.speed));
+        }
+        command.throttle = Clamp(accel / m_maxAccel, 0.0, 1.0);
+        command.brake = Clamp(-accel / m_maxDecel, 0.0, 1.0);
+
+        // Lateral: pure pursuit on the assigned lane's centerline, walked in the direction of travel
+        command.steering = 0.0;
+        const osi3::Lane* lane = FindLane(map, ego);
+        if (!lane || lane->classification().centerline_size() < 2) return true;
+        const auto& line = lane->classification().centerline();
+        int n = line.size(), nearest = 0;
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < n; ++i) {
+            double d = std::hypot(line[i].x() - ego.pos[0], line[i].y() - ego.pos[1]);
+            if (d < best) best = d, nearest = i;
+        }
+        int next = nearest + 1 < n ? nearest + 1 : nearest - 1;
+        double tx = line[next].x() - line[nearest].x(), ty = line[next].y() - line[nearest].y();
+        int dir = (next > nearest) == (c * tx + s * ty >= 0.0) ? 1 : -1;
+
+        double lookahead = std::max(m_minLookahead, m_lookaheadTime * ego.speed);
+        int i = nearest;
+        while (i + dir >= 0 && i + dir < n &&
+               std::hypot(line[i].x() - ego.pos[0], line[i].y() - ego.pos[1]) < lookahead) {
+            i += dir;
+        }
+        double dx = line[i].x() - ego.pos[0], dy = line[i].y() - ego.pos[1];
+        double ld = std::hypot(dx, dy);
+        if (ld < 1e-3) return true;
+        double alpha = std::atan2(-s * dx + c * dy, c * dx + s * dy);
+        double delta = std::atan(2.0 * m_wheelbase * std::sin(alpha) / ld);
+        command.steering = Clamp(delta / m_maxSteer, -1.0, 1.0);
+        return true;
+    }
+
+private:
+    const osi3::Lane* FindLane(const StaticGroundTruth& map, const ControllerEgoState& ego) {
+        if (!map.groundTruth || !ego.object || ego.object->assigned_lane_id_size() == 0) return nullptr;
+        const osi3::GroundTruth& gt = *map.groundTruth;
+        uint64_t id = ego.object->assigned_lane_id(0).value();
+        // Lane order is fixed for a map generation; re-scan only when the cached index misses
+        if (m_mapGeneration != map.generation) {
+            m_mapGeneration = map.generation;
+            m_laneIndex = 0;
+        }
+        if (m_laneIndex < gt.lane_size() && gt.lane(m_laneIndex).id().value() == id) return &gt.lane(m_laneIndex);
+        for (int i = 0; i < gt.lane_size(); ++i) {
+            if (gt.lane(i).id().value() == id) {
+                m_laneIndex = i;
+                return &gt.lane(i);
+            }
+        }
+        return nullptr;
+    }
+
+    double m_targetSpeed, m_timeGap, m_minGap, m_lookaheadTime, m_minLookahead;
+    double m_wheelbase, m_maxSteer, m_speedGain, m_gapGain, m_maxAccel, m_maxDecel, m_laneHalfWidth;
+    uint64_t m_mapGeneration = 0;
+    int m_laneIndex = 0;
+};
+
+}  // namespace
+
+GT_NATIVE_CONTROLLER(ExampleController)
@@ -128,6 +128,32 @@ fmi2_status_t FmuHelper::DoStep(double currentCommunicationPoint, double communi
     return fmi2_import_do_step(m_fmu, currentCommunicationPoint, communicationStepSize, noSetFMUStatePriorToCurrentPoint ? fmi2_true : fmi2_false);
 }
 
+bool FmuHelper::CanGetAndSetState() const {
+    return fmi2_import_get_capability(m_fmu, fmi2_cs_canGetAndSetFMUstate) != 0;
+}
+
+bool FmuHelper::CanHandleVariableStepSize() const {
+    return fmi2_import_get_capability(m_fmu, fmi2_cs_canHandleVariableCommunicationStepSize) != 0;
+}
+
+bool FmuHelper::GetState(fmi2_FMU_state_t& state) {
+    return fmi2_import_get_fmu_state(m_fmu, &state) == fmi2_status_ok;
+}
+
+bool FmuHelper::SetState(fmi2_FMU_state_t state) {
+    return fmi2_import_set_fmu_state(m_fmu, state) == fmi2_status_ok;
+}
+
+void FmuHelper::FreeState(fmi2_FMU_state_t& state) {
+    if (state) fmi2_import_free_fmu_state(m_fmu, &state);
+    state = nullptr;
+}
+
+bool FmuHelper::GetLastSuccessfulTime(double& time) {
+    // Only defined after DoStep returned fmi2Discard
+    return fmi2_import_get_real_status(m_fmu, fmi2_last_successful_time, &time) == fmi2_status_ok;
+}
+
 fmi2_value_reference_t FmuHelper::GetValueReference(const std::string& name) {
     if (m_vrCache.find(name) != m_vrCache.end()) {
         return m_vrCache[name];
@@ -166,6 +192,16 @@ bool FmuHelper::SetVariable(const std::string& name, const std::string& value) {
     return fmi2_import_set_string(m_fmu, &vr, 1, &val) == fmi2_status_ok;
 }
 
+bool FmuHelper::GetReals(const std::vector<fmi2_value_reference_t>& vrs, double* values) {
+    if (vrs.empty()) return true;
+    return fmi2_import_get_real(m_fmu, vrs.data(), vrs.size(), values) == fmi2_status_ok;
+}
+
+bool FmuHelper::SetReals(const std::vector<fmi2_value_reference_t>& vrs, const double* values) {
+    if (vrs.empty()) return true;
+    return fmi2_import_set_real(m_fmu, vrs.data(), vrs.size(), values) == fmi2_status_ok;
+}
+
 bool FmuHelper::GetVariable(const std::string& name, double& value) {
     fmi2_value_reference_t vr = GetValueReference(name);
     return fmi2_import_get_real(m_fmu, &vr, 1, &value) == fmi2_status_ok;
@@ -203,6 +239,18 @@ std::string FmuHelper::GetTypesPlatform() const {
     return fmi2_import_get_types_platform(m_fmu);
 }
 
+std::vector<std::string> FmuHelper::GetVariableNames() const {
+    std::vector<std::string> names;
+    fmi2_import_variable_list_t* varList = fmi2_import_get_variable_list(m_fmu, 0);
+    size_t numVars = fmi2_import_get_variable_list_size(varList);
+    names.reserve(numVars);
+    for (size_t i = 0; i < numVars; ++i) {
+        names.push_back(fmi2_import_get_variable_name(fmi2_import_get_variable(varList, i)));
+    }
+    fmi2_import_free_variable_list(varList);
+    return names;
+}
+
 void FmuHelper::DebugPrintVariables() {
     printf("DEBUG: Variables for %s:\n", m_instanceName.c_str());
     fmi2_import_variable_list_t* varList = fmi2_import_get_variable_list(m_fmu, 0);
@@ -20,6 +20,14 @@ public:
     // Simulation Step
     fmi2_status_t DoStep(double currentCommunicationPoint, double communicationStepSize, bool noSetFMUStatePriorToCurrentPoint = true);
 
+    // Step rejection handling
+    bool CanGetAndSetState() const;
+    bool CanHandleVariableStepSize() const;
+    bool GetState(fmi2_FMU_state_t& state);
+    bool SetState(fmi2_FMU_state_t state);
+    void FreeState(fmi2_FMU_state_t& state);
+    bool GetLastSuccessfulTime(double& time);
+
     // Variable Access
     bool SetVariable(const std::string& name, double value);
     bool SetVariable(const std::string& name, int value);
@@ -31,7 +39,16 @@ public:
     bool GetVariable(const std::string& name, bool& value);
     bool GetVariable(const std::string& name, std::string& value);
 
+    // Batched Real access with value references resolved once up front
+    fmi2_value_reference_t GetValueReference(const std::string& name);
+    bool GetReals(const std::vector<fmi2_value_reference_t>& vrs, double* values);
+    bool SetReals(const std::vector<fmi2_value_reference_t>& vrs, const double* values);
+
+    // Variable names in modelDescription order
+    std::vector<std::string> GetVariableNames() const;
+
     // Helpers
+    const std::string& GetInstanceName() const { return m_instanceName; }
     std::string GetVersion() const;
     std::string GetTypesPlatform() const;
     // Debug
@@ -39,7 +56,6 @@ public:
 
 private:
     void ParseModelDescription();
-    fmi2_value_reference_t GetValueReference(const std::string& name);
 
     std::string m_instanceName;
     std::string m_fmuPath;
@@ -0,0 +1,135 @@
+#include "GroundTruthCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "DemoConfiguration.h"
+#include "OsiArena.h"
+#include "OsiWireScanner.h"
+
+namespace {
+
+constexpr uint32_t kSensorViewGlobalGroundTruth = 7;
+
+// GroundTruth fields that stay constant within a scenario (osi_groundtruth.proto)
+bool IsStaticField(uint32_t field) {
+    switch (field) {
+    case 4:   // stationary_object
+    case 6:   // traffic_sign
+    case 8:   // road_marking
+    case 9:   // lane_boundary
+    case 10:  // lane
+    case 13:  // country_code
+    case 14:  // proj_string
+    case 15:  // map_reference
+    case 16:  // model_reference
+    case 17:  // reference_line
+    case 18:  // logical_lane_boundary
+    case 19:  // logical_lane
+        return true;
+    default:
+        return false;  // timestamp, host_vehicle_id, moving_object, traffic_light, occupant, environmental_conditions, ...
+    }
+}
+
+// FNV-1a style, a word at a time: only has to notice changes, not resist attacks
+uint64_t Hash(uint64_t h, const uint8_t* p, size_t n) {
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+        h ^= h >> 32;
+    }
+    for (; n > 0; ++p, --n) h = (h ^ *p) * 0x100000001b3ull;
+    return h;
+}
+
+}  // namespace
+
+GroundTruthCache::Options GroundTruthCache::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.verifyInterval = static_cast<int>(config.GetDouble(root + ".verify_interval", o.verifyInterval));
+    return o;
+}
+
+GroundTruthCache::GroundTruthCache(const Options& options) : m_options(options) {}
+
+GroundTruthCache::~GroundTruthCache() = default;
+
+osi3::SensorView* GroundTruthCache::Split(const void* data, size_t size, OsiArena& arena) {
+    if (!data || size == 0) return nullptr;
+    ++m_frames;
+    bool verify = m_generation == 0 || (m_options.verifyInterval > 0 && m_frames % m_options.verifyInterval == 0);
+
+    // Everything but the static sections is copied verbatim; the ground truth
+    // occurrences are merged into one trailing global_ground_truth field
+    Fingerprint fp;
+    fp.hash = 0xcbf29ce484222325ull;
+    m_dynamicGroundTruth.clear();
+    m_dynamic.clear();
+
+    WireReader view(data, size);
+    while (view.Next()) {
+        if (view.Field() != kSensorViewGlobalGroundTruth || view.Type() != WireReader::kLength) {
+            m_dynamic.append(reinterpret_cast<const char*>(view.Record()), view.RecordSize());
+            continue;
+        }
+        WireReader gt = view.Message();
+        while (gt.Next()) {
+            uint32_t f = gt.Field();
+            if (f >= kFields || !IsStaticField(f)) {
+                m_dynamicGroundTruth.append(reinterpret_cast<const char*>(gt.Record()), gt.RecordSize());
+                continue;
+            }
+            ++fp.records[f];
+            fp.bytes[f] += gt.RecordSize();
+            if (verify) fp.hash = Hash(fp.hash, gt.Record(), gt.RecordSize());
+        }
+        if (gt.Failed()) return nullptr;
+    }
+    if (view.Failed()) return nullptr;
+
+    AppendTag(m_dynamic, kSensorViewGlobalGroundTruth, WireReader::kLength);
+    AppendVarint(m_dynamic, m_dynamicGroundTruth.size());
+    m_dynamic += m_dynamicGroundTruth;
+
+    m_staticBytes = 0;
+    for (uint64_t b : fp.bytes) m_staticBytes += b;
+    m_dynamicBytes = m_dynamic.size();
+
+    bool changed = m_generation == 0 || fp.records != m_fingerprint.records || fp.bytes != m_fingerprint.bytes ||
+                   (verify && fp.hash != m_fingerprint.hash);
+    if (verify) ++m_verified;
+    if (changed) {
+        // Rare: collect (and hash) the static sections in a second pass and decode them once
+        m_staticScratch.clear();
+        fp.hash = 0xcbf29ce484222325ull;
+        WireReader again(data, size);
+        while (again.Next()) {
+            if (again.Field() != kSensorViewGlobalGroundTruth || again.Type() != WireReader::kLength) continue;
+            WireReader gt = again.Message();
+            while (gt.Next()) {
+                if (gt.Field() < kFields && IsStaticField(gt.Field())) {
+                    m_staticScratch.append(reinterpret_cast<const char*>(gt.Record()), gt.RecordSize());
+                    fp.hash = Hash(fp.hash, gt.Record(), gt.RecordSize());
+                }
+            }
+        }
+        auto rebuilt = std::make_unique<osi3::GroundTruth>();
+        if (!rebuilt->ParseFromString(m_staticScratch)) return nullptr;
+        m_static = std::move(rebuilt);
+        std::string().swap(m_staticScratch);  // map-sized, not needed until the next change
+        ++m_generation;
+        ++m_rebuilds;
+        m_fingerprint = fp;
+        if (m_rebuilds > 1) printf("[OSI] Static ground truth changed at frame %llu, rebuilt\n", static_cast<unsigned long long>(m_frames));
+    }
+
+    return arena.ParseSensorView(m_dynamic.data(), static_cast<int>(m_dynamic.size()));
+}
+
+void GroundTruthCache::PrintStats() const {
+    printf("[OSI] Ground truth cache: %llu frames, static %.1f KiB cached (%llu builds, %llu verified frames), dynamic %.1f KiB per frame\n",
+           static_cast<unsigned long long>(m_frames), m_staticBytes / 1024.0, static_cast<unsigned long long>(m_rebuilds),
+           static_cast<unsigned long long>(m_verified), m_dynamicBytes / 1024.0);
+}
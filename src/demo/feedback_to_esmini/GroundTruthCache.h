@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "osi_groundtruth.pb.h"
+#include "osi_sensorview.pb.h"
+
+class DemoConfiguration;
+class OsiArena;
+
+// The part of a GroundTruth that does not change within a scenario: lanes, lane
+// boundaries, road markings, traffic signs, stationary objects, reference lines,
+// logical lanes and the map / projection references.
+struct StaticGroundTruth {
+    uint64_t generation = 0;                         // changes whenever the content changes; 0 = none yet
+    const osi3::GroundTruth* groundTruth = nullptr;  // static fields only; valid while the generation is unchanged
+};
+
+// Host-side split of esmini's SensorView into static and dynamic ground truth.
+//
+// esmini repeats the whole map in every SensorView. Split() walks the encoded
+// view: the static GroundTruth sections are fingerprinted and, on the first
+// frame or when the fingerprint changes, decoded once into a cached message;
+// everything else (moving objects, traffic lights, environment, the SensorView
+// fields) is decoded on the OSI arena. Per-step decoding then scales with the
+// number of moving objects instead of the map size.
+//
+// The fingerprint taken every frame is the record count and encoded size of
+// each static section. Every verify_interval frames (and on the first) the
+// static bytes are also hashed, which catches same-size edits.
+class GroundTruthCache {
+public:
+    struct Options {
+        int verifyInterval = 100;  // frames between content hashes; <= 0 hashes only the first frame
+
+        // "simulation.ground_truth_cache": verify_interval
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    explicit GroundTruthCache(const Options& options);
+    ~GroundTruthCache();
+
+    // SensorView with the dynamic ground truth only, allocated on the arena;
+    // nullptr on empty or undecodable input
+    osi3::SensorView* Split(const void* data, size_t size, OsiArena& arena);
+
+    StaticGroundTruth Static() const { return {m_generation, m_static.get()}; }
+
+    void PrintStats() const;
+
+private:
+    // Indexed by GroundTruth field number
+    static constexpr size_t kFields = 20;
+    struct Fingerprint {
+        std::array<uint64_t, kFields> records{};
+        std::array<uint64_t, kFields> bytes{};
+        uint64_t hash = 0;
+    };
+
+    Options m_options;
+    std::unique_ptr<osi3::GroundTruth> m_static;
+    uint64_t m_generation = 0;
+    Fingerprint m_fingerprint;
+
+    std::string m_dynamic;             // encoded SensorView without the static sections, reused
+    std::string m_dynamicGroundTruth;  // its global_ground_truth payload, reused
+    std::string m_staticScratch;       // encoded static sections, only while rebuilding
+
+    uint64_t m_frames = 0, m_rebuilds = 0, m_verified = 0;
+    uint64_t m_staticBytes = 0, m_dynamicBytes = 0;  // last frame
+};
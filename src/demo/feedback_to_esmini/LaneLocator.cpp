@@ -0,0 +1,334 @@
+#include "LaneLocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "osi_lane.pb.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Caps the dense grid; a larger map gets coarser cells
+constexpr double kMaxCells = 4.0e6;
+// Centerline points sampled per lane for the half-width estimate
+constexpr size_t kWidthSamples = 16;
+
+double WrapAngle(double a) {
+    a = std::fmod(a + kPi, 2.0 * kPi);
+    if (a < 0.0) a += 2.0 * kPi;
+    return a - kPi;
+}
+
+double DistanceToPolyline(const google::protobuf::RepeatedPtrField<osi3::LaneBoundary::BoundaryPoint>& line,
+                          double x, double y) {
+    double best = -1.0;
+    for (int i = 0; i + 1 < line.size(); ++i) {
+        double ax = line[i].position().x(), ay = line[i].position().y();
+        double dx = line[i + 1].position().x() - ax, dy = line[i + 1].position().y() - ay;
+        double len2 = dx * dx + dy * dy;
+        double u = len2 > 0.0 ? std::clamp(((x - ax) * dx + (y - ay) * dy) / len2, 0.0, 1.0) : 0.0;
+        double d = std::hypot(x - ax - u * dx, y - ay - u * dy);
+        if (best < 0.0 || d < best) best = d;
+    }
+    return best;
+}
+
+}  // namespace
+
+LaneLocator::Options LaneLocator::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.enabled = config.GetBool(root + ".enabled", o.enabled);
+    o.cellSize = config.GetDouble(root + ".cell_size", o.cellSize);
+    o.searchRadius = config.GetDouble(root + ".search_radius", o.searchRadius);
+    o.defaultHalfWidth = config.GetDouble(root + ".default_half_width", o.defaultHalfWidth);
+    return o;
+}
+
+LaneLocator::LaneLocator(const Options& options) : m_options(options) {
+    if (!(m_options.cellSize > 0.0)) throw std::runtime_error("Lane localization cell_size must be positive");
+    if (!(m_options.searchRadius > 0.0)) throw std::runtime_error("Lane localization search_radius must be positive");
+}
+
+void LaneLocator::SetMap(const StaticGroundTruth& map) {
+    if (!map.groundTruth || map.generation == m_generation) return;
+    m_generation = map.generation;
+    // Lane indices change with the map; the next query starts from the grid
+    m_last = Location{};
+    Build(*map.groundTruth);
+}
+
+void LaneLocator::Build(const osi3::GroundTruth& gt) {
+    auto start = std::chrono::steady_clock::now();
+    m_lanes.clear();
+    m_neighbours.clear();
+    m_segments.clear();
+
+    std::unordered_map<uint64_t, int> boundaries;
+    for (int i = 0; i < gt.lane_boundary_size(); ++i) boundaries[gt.lane_boundary(i).id().value()] = i;
+    std::unordered_map<uint64_t, uint32_t> laneIndex;
+
+    // Segments of every centerline, in point order
+    std::vector<int> source;  // GroundTruth.lane index per entry of m_lanes
+    for (int i = 0; i < gt.lane_size(); ++i) {
+        const osi3::Lane& osiLane = gt.lane(i);
+        const auto& line = osiLane.classification().centerline();
+        if (line.size() < 2) continue;
+
+        Lane lane;
+        lane.id = osiLane.id().value();
+        lane.first = static_cast<uint32_t>(m_segments.size());
+        lane.forward = !osiLane.classification().has_centerline_is_driving_direction() ||
+                       osiLane.classification().centerline_is_driving_direction();
+        uint32_t index = static_cast<uint32_t>(m_lanes.size());
+        double s = 0.0;
+        for (int p = 0; p + 1 < line.size(); ++p) {
+            Segment seg;
+            seg.ax = line[p].x(), seg.ay = line[p].y();
+            seg.dx = line[p + 1].x() - seg.ax, seg.dy = line[p + 1].y() - seg.ay;
+            seg.length = std::hypot(seg.dx, seg.dy);
+            if (seg.length <= 0.0) continue;  // repeated point
+            seg.s0 = s;
+            seg.lane = index;
+            s += seg.length;
+            m_segments.push_back(seg);
+        }
+        lane.count = static_cast<uint32_t>(m_segments.size()) - lane.first;
+        if (lane.count == 0) continue;
+
+        // Half width: mean distance from sampled centerline points to the lane's boundaries
+        double sum[2] = {0.0, 0.0};
+        int n[2] = {0, 0};
+        const google::protobuf::RepeatedPtrField<osi3::Identifier>* sides[2] = {
+            &osiLane.classification().left_lane_boundary_id(), &osiLane.classification().right_lane_boundary_id()};
+        int side = 0;
+        for (const auto* ids : sides) {
+            size_t stride = std::max<size_t>(1, static_cast<size_t>(line.size()) / kWidthSamples);
+            for (int p = 0; p < line.size(); p += static_cast<int>(stride)) {
+                double best = -1.0;
+                for (const auto& id : *ids) {
+                    auto it = boundaries.find(id.value());
+                    if (it == boundaries.end()) continue;
+                    double d = DistanceToPolyline(gt.lane_boundary(it->second).boundary_line(), line[p].x(), line[p].y());
+                    if (d >= 0.0 && (best < 0.0 || d < best)) best = d;
+                }
+                if (best >= 0.0) sum[side] += best, ++n[side];
+            }
+            ++side;
+        }
+        if (n[0] && n[1]) lane.halfWidth = 0.5 * (sum[0] / n[0] + sum[1] / n[1]);
+        else if (n[0] || n[1]) lane.halfWidth = (sum[0] + sum[1]) / (n[0] + n[1]);
+        else lane.halfWidth = m_options.defaultHalfWidth;
+
+        laneIndex[lane.id] = index;
+        source.push_back(i);
+        m_lanes.push_back(lane);
+    }
+
+    // Antecessors / successors and adjacent lanes
+    for (size_t l = 0; l < m_lanes.size(); ++l) {
+        const auto& cls = gt.lane(source[l]).classification();
+        m_lanes[l].neighbourBegin = static_cast<uint32_t>(m_neighbours.size());
+        auto add = [&](const osi3::Identifier& id) {
+            auto it = laneIndex.find(id.value());
+            if (it == laneIndex.end() || it->second == l) return;
+            auto begin = m_neighbours.begin() + m_lanes[l].neighbourBegin;
+            if (std::find(begin, m_neighbours.end(), it->second) == m_neighbours.end()) m_neighbours.push_back(it->second);
+        };
+        for (const auto& pair : cls.lane_pairing()) {
+            if (pair.has_antecessor_lane_id()) add(pair.antecessor_lane_id());
+            if (pair.has_successor_lane_id()) add(pair.successor_lane_id());
+        }
+        for (const auto& id : cls.left_adjacent_lane_id()) add(id);
+        for (const auto& id : cls.right_adjacent_lane_id()) add(id);
+        m_lanes[l].neighbourCount = static_cast<uint32_t>(m_neighbours.size()) - m_lanes[l].neighbourBegin;
+    }
+
+    // Dense grid over the bounding box of all segments
+    m_cols = m_rows = 0;
+    m_cellStart.assign(1, 0);
+    m_cellSegments.clear();
+    if (!m_segments.empty()) {
+        double minX = m_segments[0].ax, maxX = minX, minY = m_segments[0].ay, maxY = minY;
+        for (const auto& seg : m_segments) {
+            minX = std::min({minX, seg.ax, seg.ax + seg.dx}), maxX = std::max({maxX, seg.ax, seg.ax + seg.dx});
+            minY = std::min({minY, seg.ay, seg.ay + seg.dy}), maxY = std::max({maxY, seg.ay, seg.ay + seg.dy});
+        }
+        m_cellSize = m_options.cellSize;
+        double cells = (std::floor((maxX - minX) / m_cellSize) + 1.0) * (std::floor((maxY - minY) / m_cellSize) + 1.0);
+        if (cells > kMaxCells) m_cellSize *= std::sqrt(cells / kMaxCells);
+        m_originX = minX, m_originY = minY;
+        m_cols = static_cast<int32_t>(std::floor((maxX - minX) / m_cellSize)) + 1;
+        m_rows = static_cast<int32_t>(std::floor((maxY - minY) / m_cellSize)) + 1;
+
+        // Each segment goes into every cell of its bounding box; count, then fill
+        auto range = [&](const Segment& seg, int32_t& i0, int32_t& j0, int32_t& i1, int32_t& j1) {
+            i0 = static_cast<int32_t>((std::min(seg.ax, seg.ax + seg.dx) - m_originX) / m_cellSize);
+            i1 = static_cast<int32_t>((std::max(seg.ax, seg.ax + seg.dx) - m_originX) / m_cellSize);
+            j0 = static_cast<int32_t>((std::min(seg.ay, seg.ay + seg.dy) - m_originY) / m_cellSize);
+            j1 = static_cast<int32_t>((std::max(seg.ay, seg.ay + seg.dy) - m_originY) / m_cellSize);
+            i1 = std::min(i1, m_cols - 1), j1 = std::min(j1, m_rows - 1);
+        };
+        m_cellStart.assign(static_cast<size_t>(m_cols) * m_rows + 1, 0);
+        for (const auto& seg : m_segments) {
+            int32_t i0, j0, i1, j1;
+            range(seg, i0, j0, i1, j1);
+            for (int32_t j = j0; j <= j1; ++j)
+                for (int32_t i = i0; i <= i1; ++i) ++m_cellStart[static_cast<size_t>(j) * m_cols + i + 1];
+        }
+        for (size_t c = 1; c < m_cellStart.size(); ++c) m_cellStart[c] += m_cellStart[c - 1];
+        m_cellSegments.resize(m_cellStart.back());
+        std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (uint32_t k = 0; k < m_segments.size(); ++k) {
+            int32_t i0, j0, i1, j1;
+            range(m_segments[k], i0, j0, i1, j1);
+            for (int32_t j = j0; j <= j1; ++j)
+                for (int32_t i = i0; i <= i1; ++i) m_cellSegments[fill[static_cast<size_t>(j) * m_cols + i]++] = k;
+        }
+    }
+
+    ++m_builds;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("[Lane] Indexed %zu lanes, %zu segments in %d x %d cells of %.1f m (%.1f ms)\n", m_lanes.size(),
+           m_segments.size(), m_cols, m_rows, m_cellSize, ms);
+}
+
+LaneLocator::Candidate LaneLocator::Project(uint32_t segment, double x, double y) const {
+    const Segment& seg = m_segments[segment];
+    const Lane& lane = m_lanes[seg.lane];
+    double px = x - seg.ax, py = y - seg.ay;
+    double u = (px * seg.dx + py * seg.dy) / (seg.length * seg.length);
+    // Only the lane's first and last segments may project beyond the centerline
+    bool beyond = (u < 0.0 && segment == lane.first) || (u > 1.0 && segment == lane.first + lane.count - 1);
+    double uc = std::clamp(u, 0.0, 1.0);
+
+    Candidate c;
+    c.valid = true;
+    c.segment = segment;
+    c.s = seg.s0 + uc * seg.length;
+    c.distance = std::hypot(px - uc * seg.dx, py - uc * seg.dy);
+    c.t = (seg.dx * py - seg.dy * px) >= 0.0 ? c.distance : -c.distance;
+    c.inside = !beyond && c.distance <= lane.halfWidth;
+    return c;
+}
+
+// On a lane, inside beats outside; then the closer centerline wins
+bool LaneLocator::Better(const Candidate& a, const Candidate& b) {
+    if (!b.valid) return a.valid;
+    if (!a.valid) return false;
+    if (a.inside != b.inside) return a.inside;
+    return a.distance < b.distance;
+}
+
+LaneLocator::Candidate LaneLocator::WalkLane(uint32_t lane, uint32_t from, double x, double y) const {
+    const Lane& l = m_lanes[lane];
+    uint32_t last = l.first + l.count - 1;
+    from = std::clamp(from, l.first, last);
+    Candidate best = Project(from, x, y);
+    // Downhill on the centerline distance; the ego only moves a few segments per step
+    for (uint32_t k = from + 1; k <= last; ++k) {
+        Candidate c = Project(k, x, y);
+        if (c.distance >= best.distance) break;
+        best = c;
+    }
+    for (uint32_t k = from; k-- > l.first;) {
+        Candidate c = Project(k, x, y);
+        if (c.distance >= best.distance) break;
+        best = c;
+    }
+    return best;
+}
+
+LaneLocator::Candidate LaneLocator::ScanLane(uint32_t lane, double x, double y) const {
+    const Lane& l = m_lanes[lane];
+    Candidate best;
+    for (uint32_t k = l.first; k < l.first + l.count; ++k) {
+        Candidate c = Project(k, x, y);
+        if (Better(c, best)) best = c;
+    }
+    return best;
+}
+
+LaneLocator::Candidate LaneLocator::SearchGrid(double x, double y) const {
+    Candidate best;
+    if (m_cols == 0) return best;
+    double r = m_options.searchRadius;
+    int32_t i0 = static_cast<int32_t>(std::floor((x - r - m_originX) / m_cellSize));
+    int32_t i1 = static_cast<int32_t>(std::floor((x + r - m_originX) / m_cellSize));
+    int32_t j0 = static_cast<int32_t>(std::floor((y - r - m_originY) / m_cellSize));
+    int32_t j1 = static_cast<int32_t>(std::floor((y + r - m_originY) / m_cellSize));
+    i0 = std::max(i0, 0), j0 = std::max(j0, 0);
+    i1 = std::min(i1, m_cols - 1), j1 = std::min(j1, m_rows - 1);
+    for (int32_t j = j0; j <= j1; ++j) {
+        for (int32_t i = i0; i <= i1; ++i) {
+            size_t cell = static_cast<size_t>(j) * m_cols + i;
+            for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                Candidate c = Project(m_cellSegments[k], x, y);
+                if (c.distance <= r && Better(c, best)) best = c;
+            }
+        }
+    }
+    return best;
+}
+
+const LaneLocator::Location& LaneLocator::Locate(double x, double y, double yaw) {
+    auto start = std::chrono::steady_clock::now();
+    ++m_queries;
+
+    Candidate best;
+    bool coherent = false;
+    if (!std::isfinite(x) || !std::isfinite(y) || m_lanes.empty()) {
+        m_last = Location{};
+        return m_last;
+    }
+    if (m_last.valid) {
+        // Previous lane first: staying on it wins over an overlapping neighbour
+        uint32_t lane = m_segments[m_lastSegment].lane;
+        best = WalkLane(lane, m_lastSegment, x, y);
+        if (!best.inside) {
+            const Lane& l = m_lanes[lane];
+            for (uint32_t n = l.neighbourBegin; n < l.neighbourBegin + l.neighbourCount; ++n) {
+                Candidate c = ScanLane(m_neighbours[n], x, y);
+                if (Better(c, best)) best = c;
+            }
+        }
+        coherent = best.inside;
+    }
+    if (!coherent) {
+        ++m_searches;
+        Candidate found = SearchGrid(x, y);
+        if (Better(found, best)) best = found;
+        if (best.valid && best.distance > m_options.searchRadius) best = Candidate{};
+    } else {
+        ++m_coherent;
+    }
+
+    m_last = Location{};
+    if (best.valid) {
+        const Segment& seg = m_segments[best.segment];
+        const Lane& lane = m_lanes[seg.lane];
+        m_last.valid = true;
+        m_last.onLane = best.inside;
+        m_last.laneId = lane.id;
+        m_last.s = best.s;
+        m_last.t = best.t;
+        m_last.heading = std::atan2(seg.dy, seg.dx) + (lane.forward ? 0.0 : kPi);
+        m_last.heading = WrapAngle(m_last.heading);
+        m_last.headingError = WrapAngle(yaw - m_last.heading);
+        m_last.halfWidth = lane.halfWidth;
+        m_lastSegment = best.segment;
+    }
+    m_totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return m_last;
+}
+
+void LaneLocator::PrintStats() const {
+    if (!m_queries) return;
+    printf("[Lane] %llu queries, %.1f%% resolved from the previous lane, %llu grid searches, %llu index builds, mean %.2f us\n",
+           static_cast<unsigned long long>(m_queries), 100.0 * m_coherent / m_queries,
+           static_cast<unsigned long long>(m_searches), static_cast<unsigned long long>(m_builds),
+           m_totalUs / m_queries);
+}
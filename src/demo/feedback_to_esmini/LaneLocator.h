@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+#include "GroundTruthCache.h"
+
+// Maps a position onto esmini's lanes: lane id plus s / t along the lane's
+// centerline.
+//
+// Built once per static ground truth generation: the centerlines of
+// GroundTruth.lane are cut into segments and binned into a dense grid over the
+// map's bounding box (the map is static and bounded, unlike the objects in
+// SpatialGrid). Each lane's half width is estimated from its left / right
+// lane_boundary polylines.
+//
+// Locate() is temporally coherent. It first walks the previous lane from the
+// previous segment, then tries that lane's antecessors, successors and adjacent
+// lanes. Only when the position is on none of them does it fall back to a grid
+// query within `search_radius`.
+class LaneLocator {
+public:
+    struct Options {
+        bool enabled = false;
+        double cellSize = 10.0;         // [m]
+        double searchRadius = 10.0;     // [m] grid fallback; farther positions are not located
+        double defaultHalfWidth = 1.75; // [m] for lanes without boundaries
+
+        // "simulation.lane_localization": enabled, cell_size, search_radius, default_half_width
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    struct Location {
+        bool valid = false;   // a lane centerline is within search_radius
+        bool onLane = false;  // within the lane's half width and between its ends
+        uint64_t laneId = 0;
+        double s = 0.0;             // [m] along the centerline, in centerline point order
+        double t = 0.0;             // [m] lateral offset, positive to the left of the centerline
+        double heading = 0.0;       // [rad] lane direction in its driving direction
+        double headingError = 0.0;  // [rad] yaw - heading, wrapped to [-pi, pi]
+        double halfWidth = 0.0;
+    };
+
+    // Throws std::runtime_error on a non-positive cell size or search radius
+    explicit LaneLocator(const Options& options);
+
+    bool IsEnabled() const { return m_options.enabled; }
+
+    // Rebuilds the index when the generation changes
+    void SetMap(const StaticGroundTruth& map);
+    bool HasMap() const { return !m_lanes.empty(); }
+
+    const Location& Locate(double x, double y, double yaw);
+    const Location& Last() const { return m_last; }
+
+    void PrintStats() const;
+
+private:
+    struct Lane {
+        uint64_t id = 0;
+        uint32_t first = 0, count = 0;  // segments
+        uint32_t neighbourBegin = 0, neighbourCount = 0;
+        double halfWidth = 0.0;
+        bool forward = true;  // centerline_is_driving_direction
+    };
+
+    struct Segment {
+        double ax, ay, dx, dy;
+        double length, s0;
+        uint32_t lane;
+    };
+
+    struct Candidate {
+        uint32_t segment = 0;
+        double s = 0.0, t = 0.0, distance = 0.0;
+        bool inside = false;
+        bool valid = false;
+    };
+
+    void Build(const osi3::GroundTruth& gt);
+    Candidate Project(uint32_t segment, double x, double y) const;
+    Candidate WalkLane(uint32_t lane, uint32_t from, double x, double y) const;
+    Candidate ScanLane(uint32_t lane, double x, double y) const;
+    Candidate SearchGrid(double x, double y) const;
+    static bool Better(const Candidate& a, const Candidate& b);
+
+    Options m_options;
+    uint64_t m_generation = 0;
+
+    std::vector<Lane> m_lanes;
+    std::vector<uint32_t> m_neighbours;  // lane indices, ranges per lane
+    std::vector<Segment> m_segments;
+
+    // Dense grid: cell (i, j) holds m_cellSegments[m_cellStart[j * cols + i] .. m_cellStart[... + 1])
+    double m_cellSize = 0.0, m_originX = 0.0, m_originY = 0.0;
+    int32_t m_cols = 0, m_rows = 0;
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cellSegments;
+
+    Location m_last;
+    uint32_t m_lastSegment = 0;
+
+    uint64_t m_queries = 0, m_coherent = 0, m_searches = 0, m_builds = 0;
+    double m_totalUs = 0.0;
+};
@@ -0,0 +1,493 @@
+#include "MeshSurface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char kCacheMagic[8] = {'G', 'T', 'B', 'V', 'H', '0', '0', '1'};
+const size_t kLeafSize = 4;    // always split above this many triangles...
+const size_t kMaxLeaf = 16;    // ...unless SAH prefers a leaf, up to this many
+const int kBins = 16;
+const double kTraversalCost = 1.0;
+const double kEdgeEps = 1e-9;  // barycentric slack so shared edges never leak
+
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+struct Box {
+    double minX = std::numeric_limits<double>::infinity(), minY = minX, minZ = minX;
+    double maxX = -minX, maxY = -minX, maxZ = -minX;
+
+    void Grow(const Box& b) {
+        minX = std::min(minX, b.minX); minY = std::min(minY, b.minY); minZ = std::min(minZ, b.minZ);
+        maxX = std::max(maxX, b.maxX); maxY = std::max(maxY, b.maxY); maxZ = std::max(maxZ, b.maxZ);
+    }
+    // Footprint seen by a vertical ray; the perimeter term keeps flat strips from costing nothing
+    double Area() const {
+        if (!(maxX >= minX)) return 0.0;
+        double w = maxX - minX, h = maxY - minY;
+        return w * h + 1e-3 * (w + h);
+    }
+};
+
+struct TriBounds {
+    Box box;
+    double cx, cy;
+};
+
+template <typename Node>
+struct Builder {
+    const std::vector<TriBounds>& tris;
+    std::vector<uint32_t>& order;
+    std::vector<Node>& nodes;
+    size_t depth = 0;
+
+    void Split(size_t begin, size_t end, size_t level) {
+        depth = std::max(depth, level);
+        Box bounds, centroids;
+        for (size_t k = begin; k < end; ++k) {
+            const TriBounds& t = tris[order[k]];
+            bounds.Grow(t.box);
+            Box c;
+            c.minX = c.maxX = t.cx;
+            c.minY = c.maxY = t.cy;
+            c.minZ = c.maxZ = 0.0;
+            centroids.Grow(c);
+        }
+
+        const size_t index = nodes.size();
+        nodes.push_back(Node{bounds.minX, bounds.minY, bounds.maxX, bounds.maxY, bounds.minZ, bounds.maxZ,
+                             static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)});
+        const size_t count = end - begin;
+        if (count <= kLeafSize) return;
+
+        // Binned SAH along the wider centroid extent
+        bool alongX = centroids.maxX - centroids.minX >= centroids.maxY - centroids.minY;
+        double lo = alongX ? centroids.minX : centroids.minY;
+        double extent = (alongX ? centroids.maxX : centroids.maxY) - lo;
+        auto binOf = [&](const TriBounds& t) {
+            double c = alongX ? t.cx : t.cy;
+            return std::min(kBins - 1, static_cast<int>((c - lo) / extent * kBins));
+        };
+
+        size_t mid = begin;
+        if (extent > 0.0) {
+            Box binBox[kBins];
+            size_t binCount[kBins] = {};
+            for (size_t k = begin; k < end; ++k) {
+                int b = binOf(tris[order[k]]);
+                binBox[b].Grow(tris[order[k]].box);
+                ++binCount[b];
+            }
+
+            double rightArea[kBins];
+            size_t rightCount[kBins];
+            Box acc;
+            size_t n = 0;
+            for (int b = kBins - 1; b > 0; --b) {
+                acc.Grow(binBox[b]);
+                n += binCount[b];
+                rightArea[b] = acc.Area();
+                rightCount[b] = n;
+            }
+
+            double bestCost = std::numeric_limits<double>::infinity();
+            int bestBin = -1;
+            acc = Box();
+            n = 0;
+            for (int b = 1; b < kBins; ++b) {
+                acc.Grow(binBox[b - 1]);
+                n += binCount[b - 1];
+                if (n == 0 || rightCount[b] == 0) continue;
+                double cost = acc.Area() * n + rightArea[b] * rightCount[b];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestBin = b;
+                }
+            }
+
+            // Costs scaled by the node area: leaf N * A against traversal A + sum(A_child * N_child)
+            double leafCost = bounds.Area() * count;
+            if (count <= kMaxLeaf && (bestBin < 0 || leafCost <= kTraversalCost * bounds.Area() + bestCost)) return;
+            if (bestBin >= 0) {
+                mid = std::partition(order.begin() + begin, order.begin() + end,
+                                     [&](uint32_t t) { return binOf(tris[t]) < bestBin; }) - order.begin();
+            }
+        }
+
+        // Coincident centroids or no usable bin boundary: split in the middle
+        if (mid == begin || mid == end) {
+            mid = begin + count / 2;
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](uint32_t a, uint32_t b) {
+                return alongX ? tris[a].cx < tris[b].cx : tris[a].cy < tris[b].cy;
+            });
+        }
+
+        nodes[index].count = 0;
+        Split(begin, mid, level + 1);
+        nodes[index].first = static_cast<uint32_t>(nodes.size());
+        Split(mid, end, level + 1);
+    }
+};
+
+}  // namespace
+
+void MeshSurface::Triangles::Resize(size_t n) {
+    for (auto* a : Arrays()) a->resize(n);
+}
+
+std::vector<std::vector<double>*> MeshSurface::Triangles::Arrays() {
+    return {&x0, &y0, &z0, &e1x, &e1y, &e1z, &e2x, &e2y, &e2z, &invDet, &nx, &ny, &nz};
+}
+
+MeshSurface::MeshSurface(const std::string& objFile, const Placement& placement, size_t numSlots,
+                         const std::string& cacheDir)
+    : m_name(std::filesystem::path(objFile).filename().string()), m_placement(placement), m_lastHit(numSlots, -1) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::ifstream f(objFile, std::ios::binary);
+    if (!f) throw std::runtime_error("Terrain: cannot open mesh " + objFile);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    std::string text = ss.str();
+
+    // The cache key covers everything the hierarchy depends on
+    uint64_t key = Fnv1a(text.data(), text.size());
+    const double place[7] = {placement.x, placement.y, placement.z, placement.e0, placement.e1, placement.e2, placement.e3};
+    key = Fnv1a(place, sizeof(place), key);
+    key = Fnv1a(kCacheMagic, sizeof(kCacheMagic), key);
+
+    std::string cachePath;
+    if (!cacheDir.empty()) {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        cachePath = (std::filesystem::path(cacheDir) / (std::string(hex) + ".bvh")).string();
+        m_fromCache = ReadCache(cachePath, key);
+    }
+
+    if (!m_fromCache) {
+        std::vector<double> vertices;
+        std::vector<uint32_t> indices;
+        ParseObj(text, vertices, indices);
+        if (indices.empty()) throw std::runtime_error("Terrain: no triangles in mesh " + objFile);
+
+        // Place the mesh in the world frame once, instead of transforming every query
+        double q0 = placement.e0, q1 = placement.e1, q2 = placement.e2, q3 = placement.e3;
+        double norm = std::sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        if (norm > 0.0) { q0 /= norm; q1 /= norm; q2 /= norm; q3 /= norm; } else { q0 = 1.0; }
+        const double r[9] = {1 - 2 * (q2 * q2 + q3 * q3), 2 * (q1 * q2 - q0 * q3), 2 * (q1 * q3 + q0 * q2),
+                             2 * (q1 * q2 + q0 * q3), 1 - 2 * (q1 * q1 + q3 * q3), 2 * (q2 * q3 - q0 * q1),
+                             2 * (q1 * q3 - q0 * q2), 2 * (q2 * q3 + q0 * q1), 1 - 2 * (q1 * q1 + q2 * q2)};
+        for (size_t v = 0; v + 2 < vertices.size(); v += 3) {
+            double lx = vertices[v], ly = vertices[v + 1], lz = vertices[v + 2];
+            vertices[v] = placement.x + r[0] * lx + r[1] * ly + r[2] * lz;
+            vertices[v + 1] = placement.y + r[3] * lx + r[4] * ly + r[5] * lz;
+            vertices[v + 2] = placement.z + r[6] * lx + r[7] * ly + r[8] * lz;
+        }
+
+        Build(vertices, indices);
+        if (!cachePath.empty()) WriteCache(cachePath, key);
+    }
+    if (m_tris.Size() == 0) throw std::runtime_error("Terrain: mesh " + objFile + " has no triangle visible from above");
+
+    m_loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    printf("[Terrain] Mesh %s: %zu triangles, %zu BVH nodes, %s in %.1f ms\n", m_name.c_str(), m_tris.Size(),
+           m_nodes.size(), m_fromCache ? "loaded from cache" : "built", m_loadMs);
+}
+
+// -----------------------------------------------------------------------------
+// Query
+// -----------------------------------------------------------------------------
+
+void MeshSurface::Query(size_t first, size_t n, const double* x, const double* y, double* top,
+                        double* height, double* nx, double* ny, double* nz, double* mu) const {
+    const Triangles& T = m_tris;
+    double hitZ[64];
+    int64_t hitTri[64];
+    unsigned char active[64];
+    const size_t chunk = sizeof(hitZ) / sizeof(hitZ[0]);
+
+    for (size_t base = 0; base < n; base += chunk) {
+        const size_t m = std::min(chunk, n - base);
+        const double* px = x + base;
+        const double* py = y + base;
+        int64_t* last = m_lastHit.data() + first + base;
+
+        // Temporal coherence: last step's triangle gives a lower bound that prunes the traversal
+        for (size_t i = 0; i < m; ++i) {
+            hitZ[i] = -std::numeric_limits<double>::infinity();
+            hitTri[i] = -1;
+            int64_t k = last[i];
+            if (k < 0) continue;
+            double dx = px[i] - T.x0[k], dy = py[i] - T.y0[k];
+            double u = (dx * T.e2y[k] - dy * T.e2x[k]) * T.invDet[k];
+            double v = (dy * T.e1x[k] - dx * T.e1y[k]) * T.invDet[k];
+            if (u >= -kEdgeEps && v >= -kEdgeEps && u + v <= 1.0 + kEdgeEps) {
+                hitZ[i] = T.z0[k] + u * T.e1z[k] + v * T.e2z[k];
+                hitTri[i] = k;
+            }
+        }
+
+        // Packet traversal: each node and triangle is tested against all points in one SoA pass
+        uint32_t* stack = m_stack.data();
+        size_t sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            const uint32_t index = stack[--sp];
+            const Node& node = m_nodes[index];
+            ++m_nodeVisits;
+
+            unsigned char any = 0;
+            for (size_t i = 0; i < m; ++i) {
+                unsigned char a = (px[i] >= node.minX) & (px[i] <= node.maxX) & (py[i] >= node.minY) &
+                                  (py[i] <= node.maxY) & (node.maxZ > hitZ[i]);
+                active[i] = a;
+                any |= a;
+            }
+            if (!any) continue;
+
+            if (node.count == 0) {
+                // Visit the child reaching higher first; the other is then often pruned by its top
+                uint32_t left = index + 1, right = node.first;
+                if (m_nodes[left].maxZ > m_nodes[right].maxZ) std::swap(left, right);
+                stack[sp++] = left;
+                stack[sp++] = right;
+                continue;
+            }
+
+            for (size_t k = node.first, end = node.first + node.count; k < end; ++k) {
+                const double x0 = T.x0[k], y0 = T.y0[k], z0 = T.z0[k];
+                const double e1x = T.e1x[k], e1y = T.e1y[k], e1z = T.e1z[k];
+                const double e2x = T.e2x[k], e2y = T.e2y[k], e2z = T.e2z[k], inv = T.invDet[k];
+                for (size_t i = 0; i < m; ++i) {
+                    double dx = px[i] - x0, dy = py[i] - y0;
+                    double u = (dx * e2y - dy * e2x) * inv;
+                    double v = (dy * e1x - dx * e1y) * inv;
+                    double z = z0 + u * e1z + v * e2z;
+                    bool hit = active[i] && u >= -kEdgeEps && v >= -kEdgeEps && u + v <= 1.0 + kEdgeEps && z > hitZ[i];
+                    hitZ[i] = hit ? z : hitZ[i];
+                    hitTri[i] = hit ? static_cast<int64_t>(k) : hitTri[i];
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m; ++i) {
+            int64_t k = hitTri[i];
+            size_t o = base + i;
+            m_hintHits += k >= 0 && k == last[i];
+            if (k < 0) continue;
+            last[i] = k;
+            if (!(hitZ[i] > top[o])) continue;
+            top[o] = hitZ[i];
+            height[o] = hitZ[i];
+            nx[o] = T.nx[k];
+            ny[o] = T.ny[k];
+            nz[o] = T.nz[k];
+            mu[o] = m_placement.mu;
+        }
+        m_queries += m;
+    }
+}
+
+void MeshSurface::PrintStats() const {
+    if (m_queries == 0) return;
+    printf("[Terrain] Mesh %s: %llu queries, %.1f BVH nodes visited per query, %.1f%% answered by the last triangle\n",
+           m_name.c_str(), static_cast<unsigned long long>(m_queries), static_cast<double>(m_nodeVisits) / m_queries,
+           100.0 * m_hintHits / m_queries);
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+// Vertices ("v x y z") and faces ("f a b c ...", fan-triangulated; "a/t/n" and
+// negative indices allowed). Everything else is ignored.
+void MeshSurface::ParseObj(const std::string& text, std::vector<double>& vertices, std::vector<uint32_t>& indices) {
+    const char* p = text.c_str();
+    const char* end = p + text.size();
+    std::vector<int64_t> face;
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        while (p < eol && (*p == ' ' || *p == '\t')) ++p;
+
+        if (eol - p > 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            char* q = const_cast<char*>(p + 2);
+            for (int c = 0; c < 3; ++c) vertices.push_back(std::strtod(q, &q));
+        } else if (eol - p > 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            face.clear();
+            const char* q = p + 2;
+            while (q < eol) {
+                while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) ++q;
+                if (q >= eol) break;
+                char* after = nullptr;
+                long long idx = std::strtoll(q, &after, 10);
+                if (after == q) break;
+                face.push_back(idx);
+                q = after;
+                while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') ++q;  // skip /t/n
+            }
+
+            const int64_t count = static_cast<int64_t>(vertices.size() / 3);
+            for (auto& idx : face) {
+                idx = idx < 0 ? count + idx : idx - 1;
+                if (idx < 0 || idx >= count) throw std::runtime_error("Terrain: OBJ face references a missing vertex");
+            }
+            for (size_t k = 2; k < face.size(); ++k) {
+                indices.push_back(static_cast<uint32_t>(face[0]));
+                indices.push_back(static_cast<uint32_t>(face[k - 1]));
+                indices.push_back(static_cast<uint32_t>(face[k]));
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+void MeshSurface::Build(const std::vector<double>& vertices, const std::vector<uint32_t>& indices) {
+    // Walls (no XY footprint) can never be hit by a vertical ray
+    std::vector<TriBounds> bounds;
+    std::vector<uint32_t> kept;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const double* a = &vertices[3 * indices[t]];
+        const double* b = &vertices[3 * indices[t + 1]];
+        const double* c = &vertices[3 * indices[t + 2]];
+        double det = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+        if (std::fabs(det) < 1e-14) continue;
+
+        TriBounds tb;
+        tb.box.minX = std::min({a[0], b[0], c[0]}); tb.box.maxX = std::max({a[0], b[0], c[0]});
+        tb.box.minY = std::min({a[1], b[1], c[1]}); tb.box.maxY = std::max({a[1], b[1], c[1]});
+        tb.box.minZ = std::min({a[2], b[2], c[2]}); tb.box.maxZ = std::max({a[2], b[2], c[2]});
+        tb.cx = (a[0] + b[0] + c[0]) / 3.0;
+        tb.cy = (a[1] + b[1] + c[1]) / 3.0;
+        bounds.push_back(tb);
+        kept.push_back(static_cast<uint32_t>(t));
+    }
+
+    std::vector<uint32_t> order(bounds.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = static_cast<uint32_t>(k);
+    m_nodes.clear();
+    m_nodes.reserve(bounds.empty() ? 0 : 2 * bounds.size() / kLeafSize + 1);
+    size_t depth = 0;
+    if (!bounds.empty()) {
+        Builder<Node> builder{bounds, order, m_nodes};
+        builder.Split(0, order.size(), 0);
+        depth = builder.depth;
+    }
+
+    m_tris.Resize(order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        size_t t = kept[order[k]];
+        const double* a = &vertices[3 * indices[t]];
+        const double* b = &vertices[3 * indices[t + 1]];
+        const double* c = &vertices[3 * indices[t + 2]];
+        double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        double n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        double s = (n[2] < 0.0 ? -1.0 : 1.0) / len;  // n[2] is the XY determinant, never 0 here
+
+        m_tris.x0[k] = a[0]; m_tris.y0[k] = a[1]; m_tris.z0[k] = a[2];
+        m_tris.e1x[k] = e1[0]; m_tris.e1y[k] = e1[1]; m_tris.e1z[k] = e1[2];
+        m_tris.e2x[k] = e2[0]; m_tris.e2y[k] = e2[1]; m_tris.e2z[k] = e2[2];
+        m_tris.invDet[k] = 1.0 / n[2];
+        m_tris.nx[k] = n[0] * s; m_tris.ny[k] = n[1] * s; m_tris.nz[k] = n[2] * s;
+    }
+    m_stack.assign(depth + 2, 0);
+}
+
+// Cache layout (native endianness, local use only): magic, key, node count,
+// triangle count, nodes, then the triangle arrays one after another
+bool MeshSurface::ReadCache(const std::string& path, uint64_t key) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    char magic[sizeof(kCacheMagic)];
+    uint64_t fileKey = 0, nodeCount = 0, triCount = 0;
+    f.read(magic, sizeof(magic));
+    f.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+    f.read(reinterpret_cast<char*>(&nodeCount), sizeof(nodeCount));
+    f.read(reinterpret_cast<char*>(&triCount), sizeof(triCount));
+    if (!f || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0 || fileKey != key) return false;
+    if (nodeCount > UINT32_MAX || triCount > UINT32_MAX) return false;
+
+    const uint64_t expected = sizeof(magic) + 3 * sizeof(uint64_t) + nodeCount * sizeof(Node) +
+                              triCount * m_tris.Arrays().size() * sizeof(double);
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) != expected || ec) return false;
+
+    // Any rejection leaves no partial hierarchy behind for the rebuild
+    auto reject = [this]() {
+        m_nodes.clear();
+        m_tris.Resize(0);
+        m_stack.clear();
+        return false;
+    };
+
+    m_nodes.resize(nodeCount);
+    f.read(reinterpret_cast<char*>(m_nodes.data()), nodeCount * sizeof(Node));
+    m_tris.Resize(triCount);
+    for (auto* a : m_tris.Arrays()) f.read(reinterpret_cast<char*>(a->data()), triCount * sizeof(double));
+    if (!f || m_nodes.empty()) return reject();
+
+    // Every inner node's children follow it (left = next node, right = first) and every
+    // leaf range lies within the triangles, so the traversal cannot loop or read past the end.
+    // The same forward pass finds the depth for the traversal stack.
+    const size_t n = m_nodes.size();
+    std::vector<uint32_t> level(n, 0);
+    uint32_t depth = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Node& node = m_nodes[i];
+        depth = std::max(depth, level[i]);
+        if (node.count != 0) {
+            if (static_cast<uint64_t>(node.first) + node.count > triCount) return reject();
+            continue;
+        }
+        if (!(i + 1 < n && node.first > i + 1 && node.first < n)) return reject();
+        level[i + 1] = level[node.first] = level[i] + 1;
+    }
+    m_stack.assign(depth + 2, 0);
+    return true;
+}
+
+void MeshSurface::WriteCache(const std::string& path, uint64_t key) {
+    // Written under a temporary name and renamed, so a concurrent reader never sees a partial file
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        uint64_t nodeCount = m_nodes.size(), triCount = m_tris.Size();
+        f.write(kCacheMagic, sizeof(kCacheMagic));
+        f.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        f.write(reinterpret_cast<const char*>(&nodeCount), sizeof(nodeCount));
+        f.write(reinterpret_cast<const char*>(&triCount), sizeof(triCount));
+        f.write(reinterpret_cast<const char*>(m_nodes.data()), nodeCount * sizeof(Node));
+        for (auto* a : m_tris.Arrays()) f.write(reinterpret_cast<const char*>(a->data()), triCount * sizeof(double));
+        if (!f) {
+            printf("[Terrain] Warning: cannot write BVH cache %s\n", tmp.c_str());
+            f.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) printf("[Terrain] Warning: cannot write BVH cache %s (%s)\n", path.c_str(), ec.message().c_str());
+}
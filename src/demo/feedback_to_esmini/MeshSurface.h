@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NativeTerrain.h"
+
+// Triangle-mesh terrain patch (RigidMesh.json "Mesh Filename", or the Terrain
+// FMU's `obj_file` parameter).
+//
+// The OBJ triangle soup is placed in the world at load and indexed by a
+// bounding volume hierarchy built with a binned SAH over the XY footprint, the
+// probability that a vertical ray hits a node. Hierarchy and triangles are
+// cached on disk under the 64-bit hash of the OBJ bytes and the placement, so
+// large scanned tracks are parsed and built once.
+//
+// Queries are vertical ray casts returning the highest hit, like Chrono's
+// RigidTerrain. A batch is traversed as one packet: every node is tested
+// against all points in one SoA pass and skipped when no point is inside its
+// footprint below its top. Each query slot first re-tests the triangle it hit
+// in the previous step, which usually yields the final height and prunes most
+// of the traversal. Face normals are returned pointing up.
+class MeshSurface : public TerrainSurface {
+public:
+    struct Placement {
+        double x = 0.0, y = 0.0, z = 0.0;               // patch location
+        double e0 = 1.0, e1 = 0.0, e2 = 0.0, e3 = 0.0;  // patch orientation (quaternion)
+        double mu = 0.8;
+    };
+
+    // Throws std::runtime_error on unreadable or empty meshes. An empty cacheDir disables the disk cache.
+    MeshSurface(const std::string& objFile, const Placement& placement, size_t numSlots, const std::string& cacheDir);
+
+    const std::string& GetName() const override { return m_name; }
+    void Query(size_t first, size_t n, const double* x, const double* y, double* top,
+               double* height, double* nx, double* ny, double* nz, double* mu) const override;
+    void PrintStats() const override;
+
+private:
+    struct Node {
+        double minX, minY, maxX, maxY, minZ, maxZ;
+        uint32_t first;  // leaf: first triangle; inner: right child (left child is the next node)
+        uint32_t count;  // triangles in a leaf, 0 for inner nodes
+    };
+
+    // Triangles in BVH order, SoA: vertex 0, edges 1 and 2, XY inverse determinant, unit normal
+    struct Triangles {
+        std::vector<double> x0, y0, z0, e1x, e1y, e1z, e2x, e2y, e2z, invDet, nx, ny, nz;
+        size_t Size() const { return x0.size(); }
+        void Resize(size_t n);
+        std::vector<std::vector<double>*> Arrays();
+    };
+
+    static void ParseObj(const std::string& text, std::vector<double>& vertices, std::vector<uint32_t>& indices);
+    void Build(const std::vector<double>& vertices, const std::vector<uint32_t>& indices);
+    bool ReadCache(const std::string& path, uint64_t key);
+    void WriteCache(const std::string& path, uint64_t key);
+
+    std::string m_name;
+    Placement m_placement;
+    std::vector<Node> m_nodes;
+    Triangles m_tris;
+
+    mutable std::vector<int64_t> m_lastHit;  // per query slot, -1 if none
+    mutable std::vector<uint32_t> m_stack;   // traversal stack, depth + 2 entries
+    bool m_fromCache = false;
+    double m_loadMs = 0.0;
+    mutable uint64_t m_queries = 0, m_nodeVisits = 0, m_hintHits = 0;
+};
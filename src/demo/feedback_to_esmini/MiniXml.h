@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Minimal XML reader for OpenDRIVE / OpenSCENARIO files: elements and their
+// attributes only. Text content, entities and DTDs are skipped.
+namespace MiniXml {
+
+struct Element {
+    std::string name;
+    std::map<std::string, std::string> attributes;
+    std::vector<Element> children;
+
+    const Element* Child(const std::string& childName) const {
+        for (auto& c : children) {
+            if (c.name == childName) return &c;
+        }
+        return nullptr;
+    }
+
+    std::vector<const Element*> Children(const std::string& childName) const {
+        std::vector<const Element*> result;
+        for (auto& c : children) {
+            if (c.name == childName) result.push_back(&c);
+        }
+        return result;
+    }
+
+    std::string Text(const std::string& attr, const std::string& def = "") const {
+        auto it = attributes.find(attr);
+        return it != attributes.end() ? it->second : def;
+    }
+
+    double Number(const std::string& attr, double def = 0.0) const {
+        auto it = attributes.find(attr);
+        if (it == attributes.end()) return def;
+        char* end = nullptr;
+        double v = std::strtod(it->second.c_str(), &end);
+        return end != it->second.c_str() ? v : def;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string& text) : m_text(text) {}
+
+    Element Parse() {
+        Element root;
+        std::vector<Element*> stack{&root};
+
+        while (m_pos < m_text.size()) {
+            size_t lt = m_text.find('<', m_pos);
+            if (lt == std::string::npos) break;
+            m_pos = lt;
+
+            if (StartsWith("<?")) { SkipPast("?>"); continue; }
+            if (StartsWith("<!--")) { SkipPast("-->"); continue; }
+            if (StartsWith("<![CDATA[")) { SkipPast("]]>"); continue; }
+            if (StartsWith("<!")) { SkipPast(">"); continue; }
+
+            if (StartsWith("</")) {
+                m_pos += 2;
+                std::string name = ReadName();
+                SkipPast(">");
+                if (stack.size() < 2 || stack.back()->name != name) {
+                    throw std::runtime_error("XML: unexpected </" + name + ">");
+                }
+                stack.pop_back();
+                continue;
+            }
+
+            ++m_pos;
+            Element e;
+            e.name = ReadName();
+            bool selfClosing = false;
+            while (true) {
+                SkipSpace();
+                if (m_pos >= m_text.size()) throw std::runtime_error("XML: unterminated <" + e.name + ">");
+                if (StartsWith("/>")) { m_pos += 2; selfClosing = true; break; }
+                if (m_text[m_pos] == '>') { ++m_pos; break; }
+
+                std::string attr = ReadName();
+                if (attr.empty()) throw std::runtime_error("XML: malformed attribute in <" + e.name + ">");
+                SkipSpace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != '=') throw std::runtime_error("XML: expected '=' after " + attr);
+                ++m_pos;
+                SkipSpace();
+                char quote = m_pos < m_text.size() ? m_text[m_pos] : '\0';
+                if (quote != '"' && quote != '\'') throw std::runtime_error("XML: unquoted value of " + attr);
+                size_t close = m_text.find(quote, m_pos + 1);
+                if (close == std::string::npos) throw std::runtime_error("XML: unterminated value of " + attr);
+                e.attributes[attr] = m_text.substr(m_pos + 1, close - m_pos - 1);
+                m_pos = close + 1;
+            }
+
+            stack.back()->children.push_back(std::move(e));
+            if (!selfClosing) stack.push_back(&stack.back()->children.back());
+        }
+        if (stack.size() != 1) throw std::runtime_error("XML: <" + stack.back()->name + "> is not closed");
+        if (root.children.empty()) throw std::runtime_error("XML: no root element");
+        return std::move(root.children.front());
+    }
+
+private:
+    bool StartsWith(const char* s) const { return m_text.compare(m_pos, std::char_traits<char>::length(s), s) == 0; }
+
+    void SkipPast(const char* s) {
+        size_t p = m_text.find(s, m_pos);
+        m_pos = p == std::string::npos ? m_text.size() : p + std::char_traits<char>::length(s);
+    }
+
+    void SkipSpace() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+    }
+
+    std::string ReadName() {
+        size_t start = m_pos;
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == '=' || c == '>' || c == '/') break;
+            ++m_pos;
+        }
+        return m_text.substr(start, m_pos - start);
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+inline Element ParseFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    std::string text = ss.str();
+    return Parser(text).Parse();
+}
+
+}  // namespace MiniXml
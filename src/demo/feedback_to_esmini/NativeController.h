@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GroundTruthCache.h"
+#include "osi_sensordata.pb.h"
+#include "osi_sensorview.pb.h"
+
+// Plugin interface for in-process driver controllers (drivecontroller.backend = "native").
+//
+// A plugin is a shared library exporting the entry points declared by
+// GT_NATIVE_CONTROLLER. Each step the host decodes the esmini SensorView once
+// and hands the controller a const reference to it, together with the state of
+// the vehicle model; the controller returns the same throttle / brake /
+// steering signals the DriveController FMU produces.
+//
+// The view's ground truth holds only the dynamic part (moving objects, traffic
+// lights, environment); lanes, boundaries, signs etc. come separately as the
+// StaticGroundTruth the host decoded once (see GroundTruthCache.h). Its
+// generation only changes when the map does, so anything derived from it can
+// be cached until then. Next to the ground truth come the outputs of the
+// host's idealized sensors ("drivecontroller.sensors", see SensorModel.h), one
+// SensorData per configured sensor with detections in the sensor frame; the
+// list is empty when none are configured. The view and the sensor data are only
+// valid during Step.
+//
+// Plugins are C++ and share the host's ABI: build them with the same compiler
+// and protobuf, against the same generated OSI headers, and resolve OSI /
+// protobuf symbols from the executable (see gt_example_controller in
+// CMakeLists.txt) instead of linking a second copy.
+
+#define GT_NATIVE_CONTROLLER_API_VERSION 3
+
+// Chassis reference frame of the vehicle model, world coordinates
+struct ControllerEgoState {
+    uint64_t id = 0;                              // moving object id of the ego in the SensorView
+    const osi3::MovingObject* object = nullptr;   // ego entry in the view's ground truth, if present
+    double pos[3] = {};
+    double rot[4] = {1.0, 0.0, 0.0, 0.0};         // quaternion e0..e3
+    double posDt[3] = {};
+    double yaw = 0.0, speed = 0.0;
+};
+
+// Same ranges as the DriveController FMU outputs: throttle, brake in [0, 1], steering in [-1, 1]
+struct ControlCommand {
+    double throttle = 0.0, brake = 0.0, steering = 0.0;
+};
+
+// "drivecontroller.native.parameters", scalar values as strings
+using ControllerParameters = std::map<std::string, std::string>;
+
+class NativeController {
+public:
+    virtual ~NativeController() = default;
+
+    // Returning false aborts the run like a failed DriveController step
+    virtual bool Step(double time, double step, const osi3::SensorView& view, const StaticGroundTruth& map,
+                      const std::vector<const osi3::SensorData*>& sensors, const ControllerEgoState& ego,
+                      ControlCommand& command) = 0;
+};
+
+#ifdef _WIN32
+#define GT_NATIVE_CONTROLLER_EXPORT extern "C" __declspec(dllexport)
+#else
+#define GT_NATIVE_CONTROLLER_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+// Exports the plugin entry points for a NativeController subclass constructible from ControllerParameters
+#define GT_NATIVE_CONTROLLER(Type)                                                                    \
+    GT_NATIVE_CONTROLLER_EXPORT int GtNativeControllerApiVersion() { return GT_NATIVE_CONTROLLER_API_VERSION; } \
+    GT_NATIVE_CONTROLLER_EXPORT NativeController* GtNativeControllerCreate(const ControllerParameters& p) \
+    {                                                                                                 \
+        return new Type(p);                                                                           \
+    }                                                                                                 \
+    GT_NATIVE_CONTROLLER_EXPORT void GtNativeControllerDestroy(NativeController* c) { delete c; }
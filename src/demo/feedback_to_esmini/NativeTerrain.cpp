@@ -0,0 +1,446 @@
+#include "NativeTerrain.h"
+
+#include "CrgSurface.h"
+#include "MeshSurface.h"
+#include "OpenDriveSurface.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+NativeTerrain::NativeTerrain(const std::string& name, int numQueries)
+    : m_name(name),
+      m_qx(numQueries, 0.0), m_qy(numQueries, 0.0), m_qz(numQueries, 0.0),
+      m_height(numQueries, 0.0), m_nx(numQueries, 0.0), m_ny(numQueries, 0.0), m_nz(numQueries, 1.0),
+      m_mu(numQueries, m_friction) {
+    for (int i = 0; i < numQueries; ++i) {
+        std::string q = "query_point_" + std::to_string(i);
+        std::string n = "normal_" + std::to_string(i);
+        m_inputs[q + ".x"] = &m_qx[i];
+        m_inputs[q + ".y"] = &m_qy[i];
+        m_inputs[q + ".z"] = &m_qz[i];
+        m_outputs["height_" + std::to_string(i)] = &m_height[i];
+        m_outputs[n + ".x"] = &m_nx[i];
+        m_outputs[n + ".y"] = &m_ny[i];
+        m_outputs[n + ".z"] = &m_nz[i];
+        m_outputs["mu_" + std::to_string(i)] = &m_mu[i];
+    }
+}
+
+double* NativeTerrain::GetInput(const std::string& name) {
+    auto it = m_inputs.find(name);
+    return it != m_inputs.end() ? it->second : nullptr;
+}
+
+const double* NativeTerrain::GetOutput(const std::string& name) {
+    auto it = m_outputs.find(name);
+    return it != m_outputs.end() ? it->second : nullptr;
+}
+
+fmi2_status_t NativeTerrain::DoStep(double /*time*/, double /*step*/) {
+    for (auto& surface : m_surfaces) surface->Update(m_qx.size(), m_qx.data(), m_qy.data());
+    Query(m_qx.size(), m_qx.data(), m_qy.data(), m_height.data(), m_nx.data(), m_ny.data(), m_nz.data(), m_mu.data());
+    return fmi2_status_ok;
+}
+
+void NativeTerrain::PrintStats() const {
+    for (auto& mesh : m_meshes) mesh->PrintStats();
+    for (auto& surface : m_surfaces) surface->PrintStats();
+}
+
+// -----------------------------------------------------------------------------
+// Query
+// -----------------------------------------------------------------------------
+
+// Patches form the outer loop and queries the inner one, so every inner loop is
+// a straight SoA pass with selects instead of branches that the compiler can
+// vectorize. Overlapping patches resolve to the highest surface, like Chrono's
+// downward ray cast.
+void NativeTerrain::Query(size_t n, const double* x, const double* y,
+                          double* height, double* nx, double* ny, double* nz, double* mu) const {
+    const double lowest = -std::numeric_limits<double>::infinity();
+    double best[64];
+    const size_t chunk = sizeof(best) / sizeof(best[0]);
+
+    for (size_t base = 0; base < n; base += chunk) {
+        const size_t m = std::min(chunk, n - base);
+        const double* px = x + base;
+        const double* py = y + base;
+        double* h = height + base;
+        double* ox = nx + base;
+        double* oy = ny + base;
+        double* oz = nz + base;
+        double* om = mu + base;
+
+        for (size_t i = 0; i < m; ++i) {
+            best[i] = lowest;
+            h[i] = 0.0;
+            ox[i] = 0.0;
+            oy[i] = 0.0;
+            oz[i] = 1.0;
+            om[i] = m_friction;
+        }
+
+        for (const Patch& p : m_patches) {
+            const double c = p.cosYaw, s = p.sinYaw;
+
+            if (p.type != PatchType::HeightMap) {
+                const bool bounded = p.type == PatchType::Box;
+                for (size_t i = 0; i < m; ++i) {
+                    double dx = px[i] - p.x0, dy = py[i] - p.y0;
+                    double lx = c * dx + s * dy;
+                    double ly = -s * dx + c * dy;
+                    bool inside = !bounded || (std::fabs(lx) <= p.halfX && std::fabs(ly) <= p.halfY);
+                    bool take = inside && p.z0 > best[i];
+                    best[i] = take ? p.z0 : best[i];
+                    h[i] = take ? p.z0 : h[i];
+                    ox[i] = take ? 0.0 : ox[i];
+                    oy[i] = take ? 0.0 : oy[i];
+                    oz[i] = take ? 1.0 : oz[i];
+                    om[i] = take ? p.mu : om[i];
+                }
+                continue;
+            }
+
+            const double* z = p.z.data();
+            const int cols = p.cols, rows = p.rows;
+            const double invDx = 1.0 / p.dx, invDy = 1.0 / p.dy;
+            for (size_t i = 0; i < m; ++i) {
+                double dx = px[i] - p.x0, dy = py[i] - p.y0;
+                double lx = c * dx + s * dy;
+                double ly = -s * dx + c * dy;
+                bool inside = std::fabs(lx) <= p.halfX && std::fabs(ly) <= p.halfY;
+
+                // Grid coordinates (column along +X, row along -Y), clamped into the grid
+                double fx = std::min(std::max((lx + p.halfX) * invDx, 0.0), cols - 1.0);
+                double fy = std::min(std::max((p.halfY - ly) * invDy, 0.0), rows - 1.0);
+                int ix = std::min(static_cast<int>(fx), cols - 2);
+                int iy = std::min(static_cast<int>(fy), rows - 2);
+                double u = fx - ix, v = fy - iy;
+
+                const double* r0 = z + static_cast<size_t>(iy) * cols + ix;
+                const double* r1 = r0 + cols;
+                double z00 = r0[0], z10 = r0[1], z01 = r1[0], z11 = r1[1];
+
+                double zi = (1 - v) * ((1 - u) * z00 + u * z10) + v * ((1 - u) * z01 + u * z11);
+                double dzdx = ((1 - v) * (z10 - z00) + v * (z11 - z01)) * invDx;
+                double dzdy = -((1 - u) * (z01 - z00) + u * (z11 - z10)) * invDy;
+
+                // Normal (-dz/dx, -dz/dy, 1) in the patch frame, rotated back to the world
+                double inv = 1.0 / std::sqrt(dzdx * dzdx + dzdy * dzdy + 1.0);
+                double lnx = -dzdx * inv, lny = -dzdy * inv;
+                double wz = p.z0 + zi;
+
+                bool take = inside && wz > best[i];
+                best[i] = take ? wz : best[i];
+                h[i] = take ? wz : h[i];
+                ox[i] = take ? c * lnx - s * lny : ox[i];
+                oy[i] = take ? s * lnx + c * lny : oy[i];
+                oz[i] = take ? inv : oz[i];
+                om[i] = take ? p.mu : om[i];
+            }
+        }
+        for (const auto& mesh : m_meshes) mesh->Query(base, m, px, py, best, h, ox, oy, oz, om);
+
+        // Surfaces override the patches where they cover; the highest surface wins
+        if (!m_surfaces.empty()) {
+            for (size_t i = 0; i < m; ++i) best[i] = lowest;
+            for (const auto& surface : m_surfaces) surface->Query(base, m, px, py, best, h, ox, oy, oz, om);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+void NativeTerrain::AddSurface(std::unique_ptr<TerrainSurface> surface) {
+    m_surfaces.push_back(std::move(surface));
+}
+
+void NativeTerrain::LoadFlat(double friction) {
+    m_friction = friction;
+    m_patches.clear();
+    m_meshes.clear();
+    Patch p;
+    p.type = PatchType::Plane;
+    p.mu = friction;
+    m_patches.push_back(p);
+    std::fill(m_mu.begin(), m_mu.end(), friction);
+    printf("[Terrain] %s: flat plane, mu=%.2f\n", m_name.c_str(), friction);
+}
+
+void NativeTerrain::LoadJson(const std::string& jsonFile, const std::string& dataPath, double friction) {
+    m_friction = friction;
+    m_patches.clear();
+    m_meshes.clear();
+
+    std::ifstream in(jsonFile);
+    if (!in) throw std::runtime_error("Terrain: cannot read " + jsonFile);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (std::filesystem::path(jsonFile).filename() == "RigidSlope20.json") {
+        // Chrono's RigidSlope20.json lacks the comma after "Height Map Filename"
+        const std::string key = "\"terrain/height_maps/slope.bmp\"";
+        size_t at = text.find(key);
+        size_t next = at == std::string::npos ? at : text.find_first_not_of(" \t\r\n", at + key.size());
+        if (next != std::string::npos && text[next] == '"') text.insert(at + key.size(), ",");
+    }
+    DemoConfiguration json;
+    try {
+        json.root = MiniJSON::Parse(text);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Terrain: cannot parse " + jsonFile + ": " + e.what());
+    }
+    std::string jsonDir = std::filesystem::path(jsonFile).parent_path().string();
+
+    auto patches = json.Get("Patches");
+    if (patches.type != MiniJSON::Type::Array) throw std::runtime_error("Terrain: no Patches in " + jsonFile);
+
+    auto vec = [](const MiniJSON::Value& obj, const std::string& key) {
+        std::vector<double> out;
+        auto it = obj.o_val.find(key);
+        if (it != obj.o_val.end()) {
+            for (auto& v : it->second.a_val) out.push_back(v.as_double());
+        }
+        return out;
+    };
+
+    for (auto& entry : patches.a_val) {
+        auto geom_it = entry.o_val.find("Geometry");
+        if (geom_it == entry.o_val.end()) throw std::runtime_error("Terrain: patch without Geometry in " + jsonFile);
+        const MiniJSON::Value& geom = geom_it->second;
+        auto mesh = geom.o_val.find("Mesh Filename");
+
+        Patch p;
+        auto loc = vec(entry, "Location");
+        if (loc.size() == 3) {
+            p.x0 = loc[0];
+            p.y0 = loc[1];
+            p.z0 = loc[2];
+        }
+        auto rot = vec(entry, "Orientation");  // e0, e1, e2, e3
+        if (rot.size() == 4) {
+            if (mesh == geom.o_val.end() && (std::fabs(rot[1]) > 1e-9 || std::fabs(rot[2]) > 1e-9)) {
+                printf("[Terrain] Warning: patch roll/pitch is ignored, only the yaw of Orientation is used\n");
+            }
+            double yaw = std::atan2(2.0 * (rot[0] * rot[3] + rot[1] * rot[2]), 1.0 - 2.0 * (rot[2] * rot[2] + rot[3] * rot[3]));
+            p.cosYaw = std::cos(yaw);
+            p.sinYaw = std::sin(yaw);
+        }
+
+        p.mu = friction;
+        auto mat = entry.o_val.find("Contact Material");
+        if (mat != entry.o_val.end()) {
+            auto cof = mat->second.o_val.find("Coefficient of Friction");
+            if (cof != mat->second.o_val.end()) p.mu = cof->second.as_double();
+        }
+
+        if (mesh != geom.o_val.end()) {
+            // Mesh patches keep their full orientation; the vertices are placed in the world at load
+            MeshSurface::Placement placement;
+            placement.x = p.x0;
+            placement.y = p.y0;
+            placement.z = p.z0;
+            if (rot.size() == 4) {
+                placement.e0 = rot[0];
+                placement.e1 = rot[1];
+                placement.e2 = rot[2];
+                placement.e3 = rot[3];
+            }
+            placement.mu = p.mu;
+            m_meshes.push_back(std::make_unique<MeshSurface>(Resolve(mesh->second.s_val, dataPath, jsonDir), placement,
+                                                             m_qx.size(), m_meshCache));
+            continue;
+        }
+
+        auto dims = vec(geom, "Dimensions");
+        auto hm = geom.o_val.find("Height Map Filename");
+        if (dims.size() >= 2) {
+            p.type = PatchType::Box;
+            p.halfX = 0.5 * dims[0];
+            p.halfY = 0.5 * dims[1];
+        } else if (hm != geom.o_val.end()) {
+            auto size = vec(geom, "Size");
+            auto range = vec(geom, "Height Range");
+            if (size.size() != 2 || range.size() != 2) throw std::runtime_error("Terrain: height map needs Size and Height Range");
+
+            std::vector<double> gray;
+            LoadBmpGray(Resolve(hm->second.s_val, dataPath, jsonDir), p.cols, p.rows, gray);
+            if (p.cols < 2 || p.rows < 2) throw std::runtime_error("Terrain: height map must be at least 2x2 pixels");
+
+            p.type = PatchType::HeightMap;
+            p.halfX = 0.5 * size[0];
+            p.halfY = 0.5 * size[1];
+            p.dx = size[0] / (p.cols - 1);
+            p.dy = size[1] / (p.rows - 1);
+            p.z.resize(gray.size());
+            for (size_t k = 0; k < gray.size(); ++k) p.z[k] = range[0] + gray[k] * (range[1] - range[0]);
+        } else {
+            throw std::runtime_error("Terrain: unsupported patch geometry in " + jsonFile +
+                                     " (the native backend handles box, height-map and mesh patches)");
+        }
+        m_patches.push_back(std::move(p));
+    }
+
+    std::fill(m_mu.begin(), m_mu.end(), friction);
+    printf("[Terrain] %s: %zu patches from %s\n", m_name.c_str(), m_patches.size() + m_meshes.size(), jsonFile.c_str());
+}
+
+void NativeTerrain::LoadMesh(const std::string& objFile, double friction) {
+    m_friction = friction;
+    m_patches.clear();
+    m_meshes.clear();
+    MeshSurface::Placement placement;
+    placement.mu = friction;
+    m_meshes.push_back(std::make_unique<MeshSurface>(objFile, placement, m_qx.size(), m_meshCache));
+    std::fill(m_mu.begin(), m_mu.end(), friction);
+}
+
+// Chrono data files name resources relative to the data directory
+// ("terrain/height_maps/x.bmp"); the Terrain FMU ships them next to the JSON.
+std::string NativeTerrain::Resolve(const std::string& file, const std::string& dataPath, const std::string& jsonDir) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> candidates;
+    if (!dataPath.empty()) candidates.push_back(fs::path(dataPath) / file);
+    candidates.push_back(fs::path(jsonDir) / file);
+    const std::string prefix = "terrain/";
+    if (file.compare(0, prefix.size(), prefix) == 0) candidates.push_back(fs::path(jsonDir) / file.substr(prefix.size()));
+    candidates.push_back(fs::path(file));
+
+    for (auto& c : candidates) {
+        if (fs::exists(c)) return c.string();
+    }
+    throw std::runtime_error("Terrain: cannot find " + file);
+}
+
+// Uncompressed BMP (1/4/8 bit palette, 24/32 bit) to gray levels in [0, 1],
+// row 0 = top row of the image
+void NativeTerrain::LoadBmpGray(const std::string& path, int& width, int& height, std::vector<double>& gray) {
+    std::ifstream f(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') throw std::runtime_error("Terrain: not a BMP file: " + path);
+
+    auto u16 = [&](size_t o) { return static_cast<uint32_t>(data[o] | (data[o + 1] << 8)); };
+    auto u32 = [&](size_t o) { return u16(o) | (u16(o + 2) << 16); };
+
+    uint32_t offset = u32(10);
+    uint32_t headerSize = u32(14);
+    int32_t w = static_cast<int32_t>(u32(18));
+    int32_t h = static_cast<int32_t>(u32(22));
+    uint32_t bits = u16(28);
+    uint32_t compression = u32(30);
+    uint32_t colors = u32(46);
+    if (compression != 0) throw std::runtime_error("Terrain: compressed BMP not supported: " + path);
+
+    bool topDown = h < 0;
+    width = w;
+    height = topDown ? -h : h;
+
+    auto luma = [](double r, double g, double b) { return (0.299 * r + 0.587 * g + 0.114 * b) / 255.0; };
+
+    std::vector<double> palette;
+    if (bits <= 8) {
+        if (colors == 0) colors = 1u << bits;
+        size_t pal = 14 + headerSize;
+        for (uint32_t k = 0; k < colors && pal + 4 * k + 2 < data.size(); ++k) {
+            palette.push_back(luma(data[pal + 4 * k + 2], data[pal + 4 * k + 1], data[pal + 4 * k]));
+        }
+    }
+
+    size_t stride = ((static_cast<size_t>(bits) * width + 31) / 32) * 4;
+    if (offset + stride * height > data.size()) throw std::runtime_error("Terrain: truncated BMP: " + path);
+
+    gray.assign(static_cast<size_t>(width) * height, 0.0);
+    for (int row = 0; row < height; ++row) {
+        // BMP rows are stored bottom-up unless the height is negative
+        int fileRow = topDown ? row : height - 1 - row;
+        const uint8_t* line = data.data() + offset + stride * fileRow;
+        for (int col = 0; col < width; ++col) {
+            double g = 0.0;
+            if (bits <= 8) {
+                size_t bit = static_cast<size_t>(col) * bits;
+                uint32_t idx = (line[bit / 8] >> (8 - bits - bit % 8)) & ((1u << bits) - 1);
+                g = idx < palette.size() ? palette[idx] : 0.0;
+            } else {
+                const uint8_t* px = line + static_cast<size_t>(col) * (bits / 8);
+                g = luma(px[2], px[1], px[0]);
+            }
+            gray[static_cast<size_t>(row) * width + col] = g;
+        }
+    }
+}
+
+std::unique_ptr<NativeTerrain> NativeTerrain::FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                         const std::string& name, int numQueries) {
+    auto terrain = std::make_unique<NativeTerrain>(name, numQueries);
+
+    std::string type = config.GetString(root + ".parameters.terrain_type", "Flat");
+    std::string json = config.GetString(root + ".parameters.json_file", "");
+    double friction = config.GetDouble(root + ".parameters.friction", 0.8);
+    std::string obj = config.GetString(root + ".parameters.obj_file", "");
+    std::string dataPath = config.GetString(root + ".native.data_path", "");
+    terrain->SetMeshCache(config.GetString(root + ".native.mesh_cache", ""));
+
+    if (type == "Flat") {
+        terrain->LoadFlat(friction);
+    } else if (!json.empty()) {
+        if (!std::filesystem::exists(json) && !dataPath.empty()) json = (std::filesystem::path(dataPath) / json).string();
+        terrain->LoadJson(json, dataPath, friction);
+    } else if (type == "RigidMesh" && !obj.empty()) {
+        terrain->LoadMesh(Resolve(obj, dataPath, "."), friction);
+    } else {
+        throw std::runtime_error("Terrain: native backend needs terrain_type \"Flat\", a json_file or an obj_file (got " + type + ")");
+    }
+
+    auto surfaces = config.Get(root + ".native.surfaces");
+    if (surfaces.type == MiniJSON::Type::Array) {
+        auto number = [](const MiniJSON::Object& o, const std::string& key, double def) {
+            auto it = o.find(key);
+            return (it != o.end() && it->second.type == MiniJSON::Type::Number) ? it->second.n_val : def;
+        };
+        auto text = [](const MiniJSON::Object& o, const std::string& key) {
+            auto it = o.find(key);
+            return (it != o.end() && it->second.type == MiniJSON::Type::String) ? it->second.s_val : std::string();
+        };
+        for (auto& entry : surfaces.a_val) {
+            if (entry.type != MiniJSON::Type::Object) continue;
+            const auto& o = entry.o_val;
+            std::string surfaceType = text(o, "type");
+            std::string file = text(o, "file");
+
+            if (surfaceType == "crg") {
+                if (file.empty()) throw std::runtime_error("Terrain: crg surface needs a \"file\"");
+                CrgSurface::Placement placement;
+                placement.x = number(o, "x", 0.0);
+                placement.y = number(o, "y", 0.0);
+                placement.z = number(o, "z", 0.0);
+                placement.yaw = number(o, "yaw", 0.0);
+                placement.mu = number(o, "mu", friction);
+                terrain->AddSurface(std::make_unique<CrgSurface>(Resolve(file, dataPath, "."), placement,
+                                                                 static_cast<size_t>(numQueries)));
+            } else if (surfaceType == "opendrive") {
+                // Without a file, the road network of the esmini scenario is used
+                if (file.empty()) file = OpenDriveSurface::FindRoadNetwork(config.GetString("esmini.parameters.xosc_path", ""));
+                if (file.empty()) throw std::runtime_error("Terrain: opendrive surface needs a \"file\" or a scenario with a LogicFile");
+                OpenDriveSurface::Options options;
+                options.cell = number(o, "cell", options.cell);
+                options.tileCells = static_cast<int>(number(o, "tile_cells", options.tileCells));
+                options.sampleStep = number(o, "sample_step", options.sampleStep);
+                options.radius = number(o, "radius", options.radius);
+                options.buildsPerUpdate = static_cast<int>(number(o, "builds_per_step", options.buildsPerUpdate));
+                options.z = number(o, "z", 0.0);
+                options.mu = number(o, "mu", friction);
+                terrain->AddSurface(std::make_unique<OpenDriveSurface>(Resolve(file, dataPath, "."), options));
+            } else {
+                throw std::runtime_error("Terrain: unknown surface type '" + surfaceType + "'");
+            }
+        }
+    }
+    return terrain;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ConnectionGraph.h"
+#include "DemoConfiguration.h"
+
+// Road surface layered over the patch terrain (e.g. an OpenCRG road). Query()
+// covers points i < n of one batch; `first` is the index of point 0 within the
+// terrain's query slots, for per-slot caches. For every point the surface covers
+// and whose height exceeds top[i], it writes top[i] and the outputs.
+class TerrainSurface {
+public:
+    virtual ~TerrainSurface() = default;
+    virtual const std::string& GetName() const = 0;
+    virtual void Query(size_t first, size_t n, const double* x, const double* y, double* top,
+                       double* height, double* nx, double* ny, double* nz, double* mu) const = 0;
+
+    // Called once per step with all query points before Query(), e.g. to stream data around them
+    virtual void Update(size_t /*n*/, const double* /*x*/, const double* /*y*/) {}
+    virtual void PrintStats() const {}
+};
+
+// In-process replacement for the per-wheel Terrain FMU instances.
+//
+// Loads the same terrain description as FMU2cs_Terrain: terrain_type "Flat", a
+// Chrono RigidTerrain JSON (RigidPlane.json, RigidHeightMap.json,
+// RigidSlope*.json, RigidMesh.json) with box, height-map and mesh patches, or
+// terrain_type "RigidMesh" with an obj_file. All wheel queries are answered in
+// one call over SoA arrays; height-map patches are evaluated with bilinear
+// height and the matching bilinear normal, mesh patches by a BVH ray cast
+// (MeshSurface). Queries that hit no patch
+// return height 0, normal +Z and the `friction` parameter. Surfaces added with
+// AddSurface() take precedence over the patches wherever they cover a point.
+//
+// Variables (i = query index): inputs query_point_i.{x,y,z};
+// outputs height_i, normal_i.{x,y,z}, mu_i.
+class NativeTerrain : public NativeComponent {
+public:
+    NativeTerrain(const std::string& name, int numQueries);
+
+    void LoadFlat(double friction);
+    // Throws std::runtime_error on unreadable files or unsupported patch types
+    void LoadJson(const std::string& jsonFile, const std::string& dataPath, double friction);
+    // Single mesh patch at the origin, like the Terrain FMU's obj_file
+    void LoadMesh(const std::string& objFile, double friction);
+    // Directory for the BVHs of mesh patches loaded afterwards ("" = no disk cache)
+    void SetMeshCache(const std::string& dir) { m_meshCache = dir; }
+
+    void AddSurface(std::unique_ptr<TerrainSurface> surface);
+
+    // Batched evaluation at (x[i], y[i]), i < n
+    void Query(size_t n, const double* x, const double* y,
+               double* height, double* nx, double* ny, double* nz, double* mu) const;
+
+    void PrintStats() const;
+
+    // NativeComponent
+    const std::string& GetName() const override { return m_name; }
+    double* GetInput(const std::string& name) override;
+    const double* GetOutput(const std::string& name) override;
+    fmi2_status_t DoStep(double time, double step) override;
+
+    // Reads "<root>.parameters" (terrain_type, json_file, obj_file, friction),
+    // "<root>.native.data_path", "<root>.native.mesh_cache" and the surfaces listed in "<root>.native.surfaces"
+    static std::unique_ptr<NativeTerrain> FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                     const std::string& name, int numQueries);
+
+private:
+    enum class PatchType { Plane, Box, HeightMap };
+
+    struct Patch {
+        PatchType type = PatchType::Plane;
+        double x0 = 0.0, y0 = 0.0, z0 = 0.0;  // location (center of the top surface)
+        double cosYaw = 1.0, sinYaw = 0.0;
+        double halfX = 0.0, halfY = 0.0;      // extent in the patch frame (Plane: unbounded)
+        double mu = 0.8;
+
+        // Height map: vertex grid, row 0 at +Y like Chrono's image mapping
+        int cols = 0, rows = 0;
+        double dx = 0.0, dy = 0.0;
+        std::vector<double> z;
+    };
+
+    static void LoadBmpGray(const std::string& path, int& width, int& height, std::vector<double>& gray);
+    static std::string Resolve(const std::string& file, const std::string& dataPath, const std::string& jsonDir);
+
+    std::string m_name;
+    double m_friction = 0.8;
+    std::vector<Patch> m_patches;
+    std::vector<std::unique_ptr<TerrainSurface>> m_meshes;  // mesh patches, highest-wins like m_patches
+    std::string m_meshCache;
+    std::vector<std::unique_ptr<TerrainSurface>> m_surfaces;
+
+    // SoA query slots
+    std::vector<double> m_qx, m_qy, m_qz;
+    std::vector<double> m_height, m_nx, m_ny, m_nz, m_mu;
+    std::map<std::string, double*> m_inputs;
+    std::map<std::string, double*> m_outputs;
+};
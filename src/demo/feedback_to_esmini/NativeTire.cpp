@@ -0,0 +1,520 @@
+#include "NativeTire.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const double kVnum = 0.01;         // numerical slip velocity [m/s] (TMeasy vN)
+const double kBlendBegin = 1.0;    // below this |vx| [m/s]: Coulomb friction only
+const double kBlendEnd = 3.0;      // above this |vx| [m/s]: TMeasy forces only
+const double kVCoulomb = 0.2;      // slip velocity at which Coulomb friction saturates [m/s]
+const double kMinTilt2 = 1e-3;     // no contact when the disc is (almost) parallel to the ground
+
+inline double Linear(const double* y, double q) {
+    return y[0] + (y[1] - y[0]) * (q - 1.0);
+}
+
+// Chrono's ChSineStep: 0 below x1, 1 above x2, smooth in between
+inline double SineStep(double x, double x1, double x2) {
+    double u = std::min(std::max((x - x1) / (x2 - x1), 0.0), 1.0);
+    return u - std::sin(2.0 * kPi * u) / (2.0 * kPi);
+}
+
+// TMeasy generalized force characteristic F(s) (adhesion, two parabolas or a cubic, sliding).
+// Every branch is evaluated and selected so the wheel loop stays free of control flow.
+inline double CombinedForce(double s, double df0, double sm, double fm, double ss, double fs) {
+    double df = std::max(2.0 * fm / std::max(sm, 1e-12), df0);
+
+    double sn = s / std::max(sm, 1e-12);
+    double p = df * sm / std::max(fm, 1e-12) - 2.0;
+    double adhesion = df * sm * sn / (1.0 + (sn + p) * sn);
+
+    double a = (fm / sm) * (fm / sm) / std::max(df * sm, 1e-12);
+    double span = std::max(ss - sm, 1e-12);
+    double sstar = sm + (fm - fs) / std::max(a * span, 1e-12);
+    double b = a * (sstar - sm) / std::max(ss - sstar, 1e-12);
+    double parabola = s <= sstar ? fm - a * (s - sm) * (s - sm) : fs + b * (ss - s) * (ss - s);
+    double c = (s - sm) / span;
+    double cubic = fm - (fm - fs) * c * c * (3.0 - 2.0 * c);
+    double transition = sstar <= ss ? parabola : cubic;
+
+    double f = s < sm ? adhesion : (s > ss ? fs : transition);
+    return (s > 0.0 && df > 0.0) ? f : 0.0;
+}
+
+// Normalized pneumatic trail n / L over the lateral slip
+inline double Trail(double sy, double nto0, double synto0, double syntoE) {
+    double sa = std::fabs(sy);
+    double se = std::max(syntoE, synto0);
+    double wf = synto0 / se;
+    double s0 = sa / synto0;
+    double low = (1.0 - wf) * nto0 * (1.0 - s0) + wf * nto0 * (1.0 - (3.0 - 2.0 * s0) * s0 * s0);
+    double s1 = (se - sa) / std::max(se - synto0, 1e-12);
+    double high = -nto0 * (1.0 - wf) * (sa - synto0) / synto0 * s1 * s1;
+    return sa >= se ? 0.0 : (sa <= synto0 ? low : high);
+}
+
+void Pair(const DemoConfiguration& json, const std::string& key, double* out) {
+    auto v = json.Get(key);
+    if (v.type != MiniJSON::Type::Array || v.a_val.size() != 2) throw std::runtime_error("Tire: missing " + key);
+    out[0] = v.a_val[0].n_val;
+    out[1] = v.a_val[1].n_val;
+}
+
+void Set(double* y, double a, double b) {
+    y[0] = a;
+    y[1] = b;
+}
+
+}  // namespace
+
+NativeTire::NativeTire(const std::string& name, int numWheels)
+    : m_name(name),
+      m_px(numWheels, 0.0), m_py(numWheels, 0.0), m_pz(numWheels, 0.0),
+      m_e0(numWheels, 1.0), m_e1(numWheels, 0.0), m_e2(numWheels, 0.0), m_e3(numWheels, 0.0),
+      m_vx(numWheels, 0.0), m_vy(numWheels, 0.0), m_vz(numWheels, 0.0),
+      m_wx(numWheels, 0.0), m_wy(numWheels, 0.0), m_wz(numWheels, 0.0),
+      m_height(numWheels, 0.0), m_nx(numWheels, 0.0), m_ny(numWheels, 0.0), m_nz(numWheels, 1.0), m_mu(numWheels, 0.8),
+      m_fx(numWheels, 0.0), m_fy(numWheels, 0.0), m_fz(numWheels, 0.0),
+      m_mx(numWheels, 0.0), m_my(numWheels, 0.0), m_mz(numWheels, 0.0),
+      m_qx(numWheels, 0.0), m_qy(numWheels, 0.0), m_qz(numWheels, 0.0) {
+    for (int i = 0; i < numWheels; ++i) {
+        std::string k = "_" + std::to_string(i);
+        std::string ws = "wheel_state" + k;
+        std::string wl = "wheel_load" + k;
+        m_inputs[ws + ".pos.x"] = &m_px[i];
+        m_inputs[ws + ".pos.y"] = &m_py[i];
+        m_inputs[ws + ".pos.z"] = &m_pz[i];
+        m_inputs[ws + ".rot.e0"] = &m_e0[i];
+        m_inputs[ws + ".rot.e1"] = &m_e1[i];
+        m_inputs[ws + ".rot.e2"] = &m_e2[i];
+        m_inputs[ws + ".rot.e3"] = &m_e3[i];
+        m_inputs[ws + ".lin_vel.x"] = &m_vx[i];
+        m_inputs[ws + ".lin_vel.y"] = &m_vy[i];
+        m_inputs[ws + ".lin_vel.z"] = &m_vz[i];
+        m_inputs[ws + ".ang_vel.x"] = &m_wx[i];
+        m_inputs[ws + ".ang_vel.y"] = &m_wy[i];
+        m_inputs[ws + ".ang_vel.z"] = &m_wz[i];
+        m_inputs["terrain_height" + k] = &m_height[i];
+        m_inputs["terrain_normal" + k + ".x"] = &m_nx[i];
+        m_inputs["terrain_normal" + k + ".y"] = &m_ny[i];
+        m_inputs["terrain_normal" + k + ".z"] = &m_nz[i];
+        m_inputs["terrain_mu" + k] = &m_mu[i];
+
+        // The load is reported at the wheel center, which is also the terrain query point
+        m_outputs[wl + ".point.x"] = &m_px[i];
+        m_outputs[wl + ".point.y"] = &m_py[i];
+        m_outputs[wl + ".point.z"] = &m_pz[i];
+        m_outputs[wl + ".force.x"] = &m_fx[i];
+        m_outputs[wl + ".force.y"] = &m_fy[i];
+        m_outputs[wl + ".force.z"] = &m_fz[i];
+        m_outputs[wl + ".moment.x"] = &m_mx[i];
+        m_outputs[wl + ".moment.y"] = &m_my[i];
+        m_outputs[wl + ".moment.z"] = &m_mz[i];
+        m_outputs["query_point" + k + ".x"] = &m_qx[i];
+        m_outputs["query_point" + k + ".y"] = &m_qy[i];
+        m_outputs["query_point" + k + ".z"] = &m_qz[i];
+    }
+}
+
+double* NativeTire::GetInput(const std::string& name) {
+    auto it = m_inputs.find(name);
+    return it != m_inputs.end() ? it->second : nullptr;
+}
+
+const double* NativeTire::GetOutput(const std::string& name) {
+    auto it = m_outputs.find(name);
+    return it != m_outputs.end() ? it->second : nullptr;
+}
+
+fmi2_status_t NativeTire::DoStep(double /*time*/, double /*step*/) {
+    Evaluate();
+    return fmi2_status_ok;
+}
+
+// -----------------------------------------------------------------------------
+// Evaluation
+// -----------------------------------------------------------------------------
+
+// One pass over the wheels with selects instead of branches; a wheel out of
+// contact runs through the same arithmetic and is masked at the end.
+void NativeTire::Evaluate() {
+    const Parameters& p = m_par;
+    const size_t n = m_px.size();
+    const double r0 = p.unloadedRadius;
+    const double bottoming = r0 - p.bottomingRadius;
+    const size_t curve = p.springDeflection.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        // Wheel spin axis (rotated +Y) and spin rate
+        double e0 = m_e0[i], e1 = m_e1[i], e2 = m_e2[i], e3 = m_e3[i];
+        double ax = 2.0 * (e1 * e2 - e0 * e3);
+        double ay = 1.0 - 2.0 * (e1 * e1 + e3 * e3);
+        double az = 2.0 * (e2 * e3 + e0 * e1);
+        double omega = ax * m_wx[i] + ay * m_wy[i] + az * m_wz[i];
+
+        double nx = m_nx[i], ny = m_ny[i], nz = m_nz[i];
+        double nlen = std::sqrt(nx * nx + ny * ny + nz * nz);
+        bool validNormal = nlen > 1e-9;
+        nx = validNormal ? nx / nlen : 0.0;
+        ny = validNormal ? ny / nlen : 0.0;
+        nz = validNormal ? nz / nlen : 1.0;
+
+        // Contact frame: longitudinal = axis x normal, lateral = normal x longitudinal
+        double lx = ay * nz - az * ny, ly = az * nx - ax * nz, lz = ax * ny - ay * nx;
+        double tilt2 = lx * lx + ly * ly + lz * lz;
+        double inv = 1.0 / std::sqrt(std::max(tilt2, kMinTilt2));
+        lx *= inv;
+        ly *= inv;
+        lz *= inv;
+        double tx = ny * lz - nz * ly, ty = nz * lx - nx * lz, tz = nx * ly - ny * lx;
+
+        // Lowest point of the disc (center + r0 * (axis x longitudinal)) and its depth below the terrain
+        double h = m_height[i];
+        double dx = m_px[i] + r0 * (ay * lz - az * ly);
+        double dy = m_py[i] + r0 * (az * lx - ax * lz);
+        double dz = m_pz[i] + r0 * (ax * ly - ay * lx);
+        double depth = (h - dz) * nz;
+        bool contact = m_pz[i] > h && m_pz[i] < h + r0 && tilt2 >= kMinTilt2 && dz <= h;
+
+        // Contact point on the terrain, force arm from the wheel center
+        double cx = dx + depth * nx - m_px[i], cy = dy + depth * ny - m_py[i], cz = dz + depth * nz - m_pz[i];
+
+        // Wheel center velocity in the contact frame
+        double vlon = m_vx[i] * lx + m_vy[i] * ly + m_vz[i] * lz;
+        double vlat = m_vx[i] * tx + m_vy[i] * ty + m_vz[i] * tz;
+        double vnor = m_vx[i] * nx + m_vy[i] * ny + m_vz[i] * nz;
+
+        // Vertical force: spring (linear or curve), bottoming, damping
+        double spring = p.cz * depth;
+        if (curve >= 2) {
+            spring = p.springForce[0];
+            for (size_t k = 0; k + 1 < curve; ++k) {
+                double d0 = p.springDeflection[k], d1 = p.springDeflection[k + 1];
+                double slope = (p.springForce[k + 1] - p.springForce[k]) / (d1 - d0);
+                double upper = k + 2 < curve ? d1 - d0 : 1e30;  // last segment extrapolates
+                spring += slope * std::min(std::max(depth - d0, 0.0), upper);
+            }
+        }
+        spring += p.bottomingStiffness * std::max(depth - bottoming, 0.0);
+        double fz = spring - p.dz * vnor;
+        contact = contact && fz > 0.0;
+        fz = contact ? fz : 0.0;
+
+        // Slips (TMeasy: slip velocities over |r_eff * omega| + vN)
+        double reff = r0 - depth / 3.0;
+        double vsx = vlon - omega * reff;
+        double vsy = vlat;
+        double vta = std::fabs(omega * reff) + kVnum;
+        double sx = -vsx / vta;
+        double sy = -vsy / vta;
+
+        // Load-dependent characteristics, friction scaled with the terrain
+        double q = std::min(fz, p.pnMax) / p.pn;
+        double frs = std::min(std::max(m_mu[i], 0.1), 1.0) / p.mu0;
+        double dfx0 = LoadScaled(p.dfx0, q), fxm = LoadScaled(p.fxm, q) * frs, fxs = LoadScaled(p.fxs, q) * frs;
+        double dfy0 = LoadScaled(p.dfy0, q), fym = LoadScaled(p.fym, q) * frs, fys = LoadScaled(p.fys, q) * frs;
+        double sxm = Linear(p.sxm, q), sxs = Linear(p.sxs, q);
+        double sym = Linear(p.sym, q), sys = Linear(p.sys, q);
+
+        // Combined slip: normalized slips and the generalized characteristic in that direction
+        double kx = fxm / std::max(dfx0, 1e-12), ky = fym / std::max(dfy0, 1e-12);
+        double sxhat = sxm / (sxm + sym) + kx / (kx + ky);
+        double syhat = sym / (sxm + sym) + ky / (kx + ky);
+        double sxn = sx / sxhat, syn = sy / syhat;
+        double sc = std::sqrt(sxn * sxn + syn * syn);
+        double ca = sc > 0.0 ? sxn / sc : std::sqrt(0.5);
+        double sa = sc > 0.0 ? syn / sc : std::sqrt(0.5);
+        double df0 = std::hypot(dfx0 * sxhat * ca, dfy0 * syhat * sa);
+        double fm = std::hypot(fxm * ca, fym * sa);
+        double sm = std::hypot(sxm / sxhat * ca, sym / syhat * sa);
+        double fs = std::hypot(fxs * ca, fys * sa);
+        double ss = std::hypot(sxs / sxhat * ca, sys / syhat * sa);
+        double f = CombinedForce(sc, df0, sm, fm, ss, fs);
+        double fxT = f * ca, fyT = f * sa;
+
+        // Coulomb friction at low speed, blended into TMeasy
+        double mu = std::min(std::max(m_mu[i], 0.1), 1.0);
+        double fxC = -mu * fz * std::tanh(vsx / kVCoulomb);
+        double fyC = -mu * fz * std::tanh(vsy / kVCoulomb);
+        double w = SineStep(std::fabs(vlon), kBlendBegin, kBlendEnd);
+        double fx = (1.0 - w) * fxC + w * fxT;
+        double fy = (1.0 - w) * fyC + w * fyT;
+
+        // Aligning torque from the pneumatic trail over the contact length, rolling resistance
+        double length = 2.0 * std::sqrt(std::max(r0 * depth, 0.0));
+        double trail = Trail(sy, Linear(p.nL0, q), Linear(p.sq0, q), Linear(p.sqe, q)) * length;
+        double mz = -w * trail * fy;
+        double my = -p.rollingResistance * fz * reff * std::tanh(omega);
+
+        // Contact frame -> world, moment moved to the wheel center
+        double Fx = fx * lx + fy * tx + fz * nx;
+        double Fy = fx * ly + fy * ty + fz * ny;
+        double Fz = fx * lz + fy * tz + fz * nz;
+        double Mx = my * tx + mz * nx + (cy * Fz - cz * Fy);
+        double My = my * ty + mz * ny + (cz * Fx - cx * Fz);
+        double Mz = my * tz + mz * nz + (cx * Fy - cy * Fx);
+
+        m_fx[i] = contact ? Fx : 0.0;
+        m_fy[i] = contact ? Fy : 0.0;
+        m_fz[i] = contact ? Fz : 0.0;
+        m_mx[i] = contact ? Mx : 0.0;
+        m_my[i] = contact ? My : 0.0;
+        m_mz[i] = contact ? Mz : 0.0;
+        m_qx[i] = m_px[i];
+        m_qy[i] = m_py[i];
+        m_qz[i] = m_pz[i];
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Parameters
+// -----------------------------------------------------------------------------
+
+void NativeTire::LoadJson(const std::string& jsonFile) {
+    DemoConfiguration json;
+    if (!json.Load(jsonFile)) throw std::runtime_error("Tire: cannot read " + jsonFile);
+    std::string tmpl = json.GetString("Template", "");
+    if (tmpl != "TMeasyTire") throw std::runtime_error("Tire: " + jsonFile + " is not a TMeasyTire (Template '" + tmpl + "')");
+
+    Parameters par;
+    par.unloadedRadius = json.GetDouble("Design.Unloaded Radius [m]", 0.0);
+    par.width = json.GetDouble("Design.Width [m]", 0.0);
+    par.rimRadius = json.GetDouble("Design.Rim Radius [m]", 0.0);
+    par.mass = json.GetDouble("Design.Mass [kg]", 0.0);
+    par.mu0 = json.GetDouble("Coefficient of Friction", 0.8);
+    par.rollingResistance = json.GetDouble("Rolling Resistance Coefficient", 0.015);
+    if (par.unloadedRadius <= 0.0 || par.width <= 0.0 || par.rimRadius <= 0.0 || par.rimRadius >= par.unloadedRadius) {
+        throw std::runtime_error("Tire: invalid Design section in " + jsonFile);
+    }
+    par.bottomingRadius = par.rimRadius;
+
+    std::string source;
+    if (json.Get("Parameters").type == MiniJSON::Type::Object) {
+        par.pn = json.GetDouble("Parameters.Vertical.Nominal Vertical Force [N]", 0.0);
+        par.pnMax = 3.5 * par.pn;
+        par.cz = json.GetDouble("Parameters.Vertical.Vertical Tire Stiffness [N/m]", 0.0);
+        auto curve = json.Get("Parameters.Vertical.Tire Spring Curve Data");
+        for (auto& point : curve.a_val) {
+            if (point.a_val.size() != 2) throw std::runtime_error("Tire: malformed Tire Spring Curve Data in " + jsonFile);
+            par.springDeflection.push_back(point.a_val[0].n_val);
+            par.springForce.push_back(point.a_val[1].n_val);
+        }
+        if (par.springDeflection.size() >= 2) {
+            size_t last = par.springDeflection.size() - 1;
+            par.cz = (par.springForce[last] - par.springForce[0]) / (par.springDeflection[last] - par.springDeflection[0]);
+        }
+        par.dz = json.GetDouble("Parameters.Vertical.Vertical Tire Damping [Ns/m]", 0.0);
+        par.bottomingRadius = json.GetDouble("Parameters.Vertical.Tire Bottoming Radius [m]", par.bottomingRadius);
+        par.bottomingStiffness = json.GetDouble("Parameters.Vertical.Tire Bottoming Stiffness [N/m]", 0.0);
+
+        Pair(json, "Parameters.Longitudinal.Initial Slopes dFx/dsx [N]", par.dfx0);
+        Pair(json, "Parameters.Longitudinal.Maximum Fx Load [N]", par.fxm);
+        Pair(json, "Parameters.Longitudinal.Sliding Fx Load [N]", par.fxs);
+        Pair(json, "Parameters.Longitudinal.Slip sx at Maximum Fx", par.sxm);
+        Pair(json, "Parameters.Longitudinal.Slip sx where sliding begins", par.sxs);
+        Pair(json, "Parameters.Lateral.Initial Slopes dFy/dsy [N]", par.dfy0);
+        Pair(json, "Parameters.Lateral.Maximum Fy Load [N]", par.fym);
+        Pair(json, "Parameters.Lateral.Sliding Fy Load [N]", par.fys);
+        Pair(json, "Parameters.Lateral.Slip sy at Maximum Fy", par.sym);
+        Pair(json, "Parameters.Lateral.Slip sy where sliding begins", par.sys);
+        Pair(json, "Parameters.Aligning.Normalized Trail at Zero Slip sy", par.nL0);
+        Pair(json, "Parameters.Aligning.Slip sy where Trail Changes Sign", par.sq0);
+        Pair(json, "Parameters.Aligning.Slip sy where Trail Tends to Zero", par.sqe);
+        source = "full parameter set";
+    } else {
+        double load = 0.0;
+        int li = static_cast<int>(json.GetDouble("Load Index", -1.0));
+        if (li >= 0) {
+            load = LoadIndexToLoad(li);
+            source = "load index " + std::to_string(li);
+        } else {
+            load = json.GetDouble("Maximum Bearing Capacity [N]", 0.0);
+            source = "bearing capacity";
+        }
+        if (load <= 0.0) throw std::runtime_error("Tire: no Parameters, Load Index or bearing capacity in " + jsonFile);
+
+        double design = json.GetDouble("Inflation Pressure Design [Pa]", 0.0);
+        double use = json.GetDouble("Inflation Pressure Use [Pa]", 0.0);
+        double pressureRatio = design > 0.0 && use > 0.0 ? use / design : 1.0;
+
+        std::string type = json.GetString("Vehicle Type", "Truck");
+        if (type == "Truck") {
+            GuessTruck80(par, load, pressureRatio);
+        } else if (type == "Passenger") {
+            GuessPassCar70(par, load, pressureRatio);
+        } else {
+            throw std::runtime_error("Tire: Vehicle Type must be Truck or Passenger in " + jsonFile);
+        }
+        source += " (" + type + " estimate)";
+    }
+    if (par.pn <= 0.0 || par.cz <= 0.0) throw std::runtime_error("Tire: no vertical stiffness / nominal load in " + jsonFile);
+
+    m_par = par;
+    printf("[Tire] %s: TMeasy from %s, %s, r0=%.4f m, pn=%.0f N, cz=%.0f N/m\n", m_name.c_str(), jsonFile.c_str(),
+           source.c_str(), par.unloadedRadius, par.pn, par.cz);
+}
+
+// Section height, vertical stiffness at 16% deflection under the tire load and
+// damping ratio 0.5, shared by both estimates
+static void GuessVertical(NativeTire::Parameters& par, double tireLoad, double pressureRatio) {
+    double section = par.unloadedRadius - par.rimRadius;
+    par.pn = 0.5 * tireLoad * std::pow(pressureRatio, 0.8);
+    par.pnMax = 3.5 * par.pn;
+    par.cz = tireLoad / (0.16 * section);
+    par.dz = 2.0 * 0.5 * std::sqrt(par.cz * std::max(par.mass, 1.0));
+}
+
+void NativeTire::GuessTruck80(Parameters& par, double tireLoad, double pressureRatio) {
+    GuessVertical(par, tireLoad, pressureRatio);
+    const double pn = par.pn, p2n = 2.0 * par.pn;
+
+    Set(par.dfx0, 17.6866 * pn, 13.8046 * p2n);
+    Set(par.fxm, 0.88468 * pn, 0.7479 * p2n);
+    Set(par.fxs, 0.54397 * pn, 0.50365 * p2n);
+    Set(par.sxm, 0.12, 0.15);
+    Set(par.sxs, 0.9, 0.95);
+
+    Set(par.dfy0, 5.948 * pn, 5.506 * p2n);
+    Set(par.fym, 0.77253 * pn, 0.73048 * p2n);
+    Set(par.fys, 0.71139 * pn, 0.66823 * p2n);
+    Set(par.sym, 0.38786, 0.38786);
+    Set(par.sys, 0.82534, 0.91309);
+
+    Set(par.nL0, 0.178, 0.19);
+    Set(par.sq0, 0.40726, 0.40726);
+    Set(par.sqe, 0.82534, 0.91309);
+}
+
+void NativeTire::GuessPassCar70(Parameters& par, double tireLoad, double pressureRatio) {
+    GuessVertical(par, tireLoad, pressureRatio);
+    const double pn = par.pn, p2n = 2.0 * par.pn;
+
+    Set(par.dfx0, 18.6758 * pn, 20.1757 * p2n);
+    Set(par.fxm, 1.1205 * pn, 1.072 * p2n);
+    Set(par.fxs, 0.8766 * pn, 0.8245 * p2n);
+    Set(par.sxm, 0.17, 0.15);
+    Set(par.sxs, 0.9, 0.95);
+
+    Set(par.dfy0, 14.9858 * pn, 10.0505 * p2n);
+    Set(par.fym, 1.0084 * pn, 0.90003 * p2n);
+    Set(par.fys, 0.83941 * pn, 0.76782 * p2n);
+    Set(par.sym, 0.18197, 0.24472);
+    Set(par.sys, 0.82534, 0.91309);
+
+    Set(par.nL0, 0.178, 0.19);
+    Set(par.sq0, 0.16, 0.20);
+    Set(par.sqe, 0.82534, 0.91309);
+}
+
+// ISO 4000 load index: indices 0..79 are tabulated, every further 80 multiply the load by 10
+double NativeTire::LoadIndexToLoad(int loadIndex) {
+    static const double kg[80] = {
+        45,  46.25, 47.5, 48.75, 50,  51.5, 53,  54.5, 56,  58,  60,  61.5, 63,  65,  67,  69,
+        71,  73,    75,   77.5,  80,  82.5, 85,  87.5, 90,  92.5, 95, 97.5, 100, 103, 106, 109,
+        112, 115,   118,  121,   125, 128,  132, 136,  140, 145, 150, 155,  160, 165, 170, 175,
+        180, 185,   190,  195,   200, 206,  212, 218,  224, 230, 236, 243,  250, 257, 265, 272,
+        280, 290,   300,  307,   315, 325,  335, 345,  355, 365, 375, 387,  400, 412, 425, 437};
+    if (loadIndex < 0 || loadIndex > 279) throw std::runtime_error("Tire: load index out of range");
+    return kg[loadIndex % 80] * std::pow(10.0, loadIndex / 80) * 9.81;
+}
+
+std::unique_ptr<NativeTire> NativeTire::FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                   const std::string& name, int numWheels) {
+    std::string json = config.GetString(root + ".parameters.tire_JSON", "");
+    if (json.empty()) throw std::runtime_error("Tire: native backend needs " + root + ".parameters.tire_JSON");
+    auto tire = std::make_unique<NativeTire>(name, numWheels);
+    tire->LoadJson(json);
+    return tire;
+}
+
+// -----------------------------------------------------------------------------
+// Comparison against the tire FMUs
+// -----------------------------------------------------------------------------
+
+TireComparison::TireComparison(std::unique_ptr<NativeTire> shadow, std::vector<FmuHelper*> fmus, const std::string& logPath)
+    : m_shadow(std::move(shadow)), m_fmus(std::move(fmus)) {
+    static const char* state[13] = {"pos.x", "pos.y", "pos.z", "rot.e0", "rot.e1", "rot.e2", "rot.e3",
+                                    "lin_vel.x", "lin_vel.y", "lin_vel.z", "ang_vel.x", "ang_vel.y", "ang_vel.z"};
+    for (size_t i = 0; i < m_fmus.size(); ++i) {
+        std::string k = "_" + std::to_string(i);
+        std::vector<double*> s, t;
+        for (auto* name : state) s.push_back(m_shadow->GetInput("wheel_state" + k + "." + name));
+        for (auto name : {"terrain_height" + k, "terrain_mu" + k, "terrain_normal" + k + ".x",
+                          "terrain_normal" + k + ".y", "terrain_normal" + k + ".z"}) {
+            t.push_back(m_shadow->GetInput(name));
+        }
+        m_stateInputs.push_back(s);
+        m_terrainInputs.push_back(t);
+
+        std::vector<fmi2_value_reference_t> vrs;
+        for (auto part : {"force", "moment"}) {
+            for (auto axis : {"x", "y", "z"}) vrs.push_back(m_fmus[i]->GetValueReference(std::string("wheel_load.") + part + "." + axis));
+        }
+        m_loadVrs.push_back(vrs);
+    }
+
+    if (!logPath.empty()) {
+        m_log.open(logPath);
+        m_log << "time,wheel,fmu_fx,fmu_fy,fmu_fz,fmu_mx,fmu_my,fmu_mz,native_fx,native_fy,native_fz,native_mx,native_my,native_mz\n";
+    }
+}
+
+void TireComparison::SetWheelState(int wheel, const double* values) {
+    for (size_t k = 0; k < m_stateInputs[wheel].size(); ++k) *m_stateInputs[wheel][k] = values[k];
+}
+
+void TireComparison::SetTerrain(int wheel, const double* values) {
+    for (size_t k = 0; k < m_terrainInputs[wheel].size(); ++k) *m_terrainInputs[wheel][k] = values[k];
+}
+
+void TireComparison::Compare(double time) {
+    m_shadow->Evaluate();
+    for (size_t i = 0; i < m_fmus.size(); ++i) {
+        double fmu[6];
+        if (!m_fmus[i]->GetReals(m_loadVrs[i], fmu)) continue;
+
+        std::string k = "_" + std::to_string(i);
+        double native[6];
+        int c = 0;
+        for (auto part : {".force.", ".moment."}) {
+            for (auto axis : {"x", "y", "z"}) native[c++] = *m_shadow->GetOutput("wheel_load" + k + part + axis);
+        }
+
+        for (int a = 0; a < 3; ++a) {
+            for (auto [dev, offset] : {std::pair<Deviation*, int>{m_force, 0}, {m_moment, 3}}) {
+                double d = std::fabs(native[offset + a] - fmu[offset + a]);
+                dev[a].maxAbs = std::max(dev[a].maxAbs, d);
+                dev[a].sumSq += d * d;
+                dev[a].maxRef = std::max(dev[a].maxRef, std::fabs(fmu[offset + a]));
+            }
+        }
+        ++m_samples;
+
+        if (m_log.is_open()) {
+            m_log << time << "," << i;
+            for (double v : fmu) m_log << "," << v;
+            for (double v : native) m_log << "," << v;
+            m_log << "\n";
+        }
+    }
+}
+
+void TireComparison::PrintSummary() const {
+    if (m_samples == 0) return;
+    static const char* axes[3] = {"x", "y", "z"};
+    printf("[Tire] Native TMeasy vs. FMU over %llu wheel steps (max |diff| / rms / max |FMU|):\n",
+           static_cast<unsigned long long>(m_samples));
+    for (int a = 0; a < 3; ++a) {
+        printf("[Tire]   force.%s  %10.2f / %10.2f / %10.2f N\n", axes[a], m_force[a].maxAbs,
+               std::sqrt(m_force[a].sumSq / m_samples), m_force[a].maxRef);
+    }
+    for (int a = 0; a < 3; ++a) {
+        printf("[Tire]   moment.%s %10.2f / %10.2f / %10.2f Nm\n", axes[a], m_moment[a].maxAbs,
+               std::sqrt(m_moment[a].sumSq / m_samples), m_moment[a].maxRef);
+    }
+}
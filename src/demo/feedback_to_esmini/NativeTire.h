@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ConnectionGraph.h"
+#include "DemoConfiguration.h"
+#include "FmuHelper.h"
+
+// In-process replacement for the per-wheel FMU2cs_ForceElementTire instances.
+//
+// Evaluates the TMeasy handling tire model for all wheels in one call over SoA
+// arrays. Parameters come from the same Chrono TMeasyTire JSON as the FMU's
+// `tire_JSON`: a full "Parameters" block, or the Chrono estimate from "Load
+// Index" / "Maximum Bearing Capacity [N]" with "Vehicle Type" Truck or
+// Passenger. Contact is the single-point disc contact against the terrain the
+// tire receives (constant height, normal and friction at its query point), like
+// the FMU's local terrain.
+//
+// Forces are the steady-state TMeasy combined-slip forces, blended into Coulomb
+// friction at low speed; the model keeps no state between steps.
+//
+// Variables (i = wheel index): inputs wheel_state_i.{pos,rot,lin_vel,ang_vel}.*,
+// terrain_height_i, terrain_normal_i.{x,y,z}, terrain_mu_i; outputs
+// wheel_load_i.{point,force,moment}.{x,y,z}, query_point_i.{x,y,z}.
+class NativeTire : public NativeComponent {
+public:
+    // TMeasy coefficients; pairs are given at the nominal load pn and at 2 * pn
+    struct Parameters {
+        double unloadedRadius = 0.0, width = 0.0, rimRadius = 0.0, mass = 0.0;
+        double mu0 = 0.8;
+        double rollingResistance = 0.015;
+
+        double pn = 0.0, pnMax = 0.0;
+        double cz = 0.0, dz = 0.0;                       // vertical stiffness / damping
+        std::vector<double> springDeflection, springForce;  // optional vertical spring curve
+        double bottomingRadius = 0.0, bottomingStiffness = 0.0;
+
+        double dfx0[2] = {}, fxm[2] = {}, fxs[2] = {}, sxm[2] = {}, sxs[2] = {};
+        double dfy0[2] = {}, fym[2] = {}, fys[2] = {}, sym[2] = {}, sys[2] = {};
+        double nL0[2] = {}, sq0[2] = {}, sqe[2] = {};    // normalized trail, its sign change and end slip
+    };
+
+    NativeTire(const std::string& name, int numWheels);
+
+    // Throws std::runtime_error on unreadable files or incomplete parameterizations
+    void LoadJson(const std::string& jsonFile);
+    const Parameters& GetParameters() const { return m_par; }
+
+    // Evaluates all wheels from the current inputs
+    void Evaluate();
+
+    // NativeComponent
+    const std::string& GetName() const override { return m_name; }
+    double* GetInput(const std::string& name) override;
+    const double* GetOutput(const std::string& name) override;
+    fmi2_status_t DoStep(double time, double step) override;
+
+    // Reads "<root>.parameters.tire_JSON" (relative to the working directory, like the FMU)
+    static std::unique_ptr<NativeTire> FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                  const std::string& name, int numWheels);
+
+    // Chrono's estimates of the TMeasy coefficients from a tire load [N]
+    static void GuessTruck80(Parameters& par, double tireLoad, double pressureRatio);
+    static void GuessPassCar70(Parameters& par, double tireLoad, double pressureRatio);
+    // Maximum load [N] of an ISO load index
+    static double LoadIndexToLoad(int loadIndex);
+    // Load-dependent coefficient through (0, 0), (pn, y[0]) and (2 pn, y[1]); q = Fz / pn
+    static double LoadScaled(const double* y, double q) { return q * (2.0 * y[0] - 0.5 * y[1] - (y[0] - 0.5 * y[1]) * q); }
+
+private:
+    std::string m_name;
+    Parameters m_par;
+
+    // SoA wheel slots
+    std::vector<double> m_px, m_py, m_pz;
+    std::vector<double> m_e0, m_e1, m_e2, m_e3;
+    std::vector<double> m_vx, m_vy, m_vz;
+    std::vector<double> m_wx, m_wy, m_wz;
+    std::vector<double> m_height, m_nx, m_ny, m_nz, m_mu;
+    std::vector<double> m_fx, m_fy, m_fz, m_mx, m_my, m_mz;
+    std::vector<double> m_qx, m_qy, m_qz;
+    std::map<std::string, double*> m_inputs;
+    std::map<std::string, const double*> m_outputs;
+};
+
+// "compare" tire backend: a NativeTire evaluated next to the tire FMUs on the
+// inputs the FMUs received, recording how far its wheel loads deviate.
+class TireComparison {
+public:
+    // `fmus[i]` is the FMU of wheel i; an empty logPath disables the per-step CSV
+    TireComparison(std::unique_ptr<NativeTire> shadow, std::vector<FmuHelper*> fmus, const std::string& logPath);
+
+    // Inputs as sent to FMU i: wheel state pos[3], rot[4], lin_vel[3], ang_vel[3] / terrain height, mu, normal[3]
+    void SetWheelState(int wheel, const double* values);
+    void SetTerrain(int wheel, const double* values);
+
+    // After the FMUs stepped: evaluate the shadow and compare the wheel loads
+    void Compare(double time);
+    void PrintSummary() const;
+
+private:
+    struct Deviation {
+        double maxAbs = 0.0, sumSq = 0.0, maxRef = 0.0;
+    };
+
+    std::unique_ptr<NativeTire> m_shadow;
+    std::vector<FmuHelper*> m_fmus;
+    std::vector<std::vector<double*>> m_stateInputs, m_terrainInputs;
+    std::vector<std::vector<fmi2_value_reference_t>> m_loadVrs;  // wheel_load.{force,moment}.{x,y,z} per FMU
+    Deviation m_force[3], m_moment[3];
+    uint64_t m_samples = 0;
+    std::ofstream m_log;
+};
@@ -0,0 +1,104 @@
+#include "ObjectTable.h"
+
+namespace {
+
+uint32_t HashId(uint64_t id) {
+    // Fibonacci hashing; OSI ids are often small and consecutive
+    return static_cast<uint32_t>((id * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+}  // namespace
+
+void ObjectTable::Resize(size_t n) {
+    id.resize(n);
+    type.resize(n);
+    x.resize(n), y.resize(n), z.resize(n);
+    roll.resize(n), pitch.resize(n), yaw.resize(n);
+    vx.resize(n), vy.resize(n), vz.resize(n);
+    length.resize(n), width.resize(n), height.resize(n);
+    laneId.resize(n);
+    hasLane.resize(n);
+}
+
+void ObjectTable::Build(const SensorViewScan& scan) {
+    size_t n = scan.movingObjects.size();
+    Resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const ScannedObject& o = scan.movingObjects[i];
+        id[i] = o.id;
+        type[i] = o.type;
+        x[i] = o.position[0], y[i] = o.position[1], z[i] = o.position[2];
+        roll[i] = o.orientation[0], pitch[i] = o.orientation[1], yaw[i] = o.orientation[2];
+        vx[i] = o.velocity[0], vy[i] = o.velocity[1], vz[i] = o.velocity[2];
+        length[i] = o.dimension[0], width[i] = o.dimension[1], height[i] = o.dimension[2];
+        laneId[i] = o.laneId;
+        hasLane[i] = o.hasLane ? 1 : 0;
+    }
+    if (scan.hasHostVehicleId) {
+        Finish(true, scan.hostVehicleId);
+    } else {
+        Finish(scan.hasGroundTruthHostVehicleId, scan.groundTruthHostVehicleId);
+    }
+}
+
+void ObjectTable::Build(const osi3::SensorView& view) {
+    const osi3::GroundTruth& gt = view.global_ground_truth();
+    size_t n = static_cast<size_t>(gt.moving_object_size());
+    Resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const osi3::MovingObject& o = gt.moving_object(static_cast<int>(i));
+        const osi3::BaseMoving& b = o.base();
+        id[i] = o.id().value();
+        type[i] = static_cast<int>(o.type());
+        x[i] = b.position().x(), y[i] = b.position().y(), z[i] = b.position().z();
+        roll[i] = b.orientation().roll(), pitch[i] = b.orientation().pitch(), yaw[i] = b.orientation().yaw();
+        vx[i] = b.velocity().x(), vy[i] = b.velocity().y(), vz[i] = b.velocity().z();
+        length[i] = b.dimension().length(), width[i] = b.dimension().width(), height[i] = b.dimension().height();
+        if (o.assigned_lane_id_size() > 0) {
+            laneId[i] = o.assigned_lane_id(0).value();
+            hasLane[i] = 1;
+        } else if (o.moving_object_classification().assigned_lane_id_size() > 0) {
+            laneId[i] = o.moving_object_classification().assigned_lane_id(0).value();
+            hasLane[i] = 1;
+        } else {
+            laneId[i] = 0;
+            hasLane[i] = 0;
+        }
+    }
+    if (view.has_host_vehicle_id()) {
+        Finish(true, view.host_vehicle_id().value());
+    } else {
+        Finish(gt.has_host_vehicle_id(), gt.host_vehicle_id().value());
+    }
+}
+
+void ObjectTable::Finish(bool hasHost, uint64_t hostId) {
+    // At most half full
+    size_t capacity = 16;
+    while (capacity < 2 * id.size()) capacity *= 2;
+    m_slots.assign(capacity, 0);
+    m_mask = static_cast<uint32_t>(capacity - 1);
+    for (uint32_t row = 0; row < id.size(); ++row) {
+        uint32_t s = HashId(id[row]) & m_mask;
+        while (m_slots[s] != 0) {
+            if (id[m_slots[s] - 1] == id[row]) break;  // duplicate id: the first row wins, like a linear search
+            s = (s + 1) & m_mask;
+        }
+        if (m_slots[s] == 0) m_slots[s] = row + 1;
+    }
+
+    m_hasHostVehicleId = hasHost;
+    if (hasHost) {
+        m_egoRow = Find(hostId);
+    } else {
+        m_egoRow = id.empty() ? kNoRow : 0;
+    }
+}
+
+uint32_t ObjectTable::Find(uint64_t objectId) const {
+    if (m_slots.empty()) return kNoRow;
+    for (uint32_t s = HashId(objectId) & m_mask; m_slots[s] != 0; s = (s + 1) & m_mask) {
+        if (id[m_slots[s] - 1] == objectId) return m_slots[s] - 1;
+    }
+    return kNoRow;
+}
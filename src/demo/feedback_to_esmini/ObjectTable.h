@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OsiWireScanner.h"
+#include "osi_sensorview.pb.h"
+
+// The moving objects of one ground truth frame as a structure of arrays.
+//
+// Built once per step, from a wire scan of the encoded SensorView or from a
+// decoded one; the ego finder, the stop conditions and the sensor stages then
+// read the columns with linear scans instead of each walking the protobuf
+// repeated field. Rows keep message order, so row i is moving_object(i).
+// Lookups by OSI id go through an open-addressing index rebuilt with the table.
+// The ego is resolved through host_vehicle_id (the SensorView's, else the
+// ground truth's) and falls back to the first object only when neither is set.
+//
+// Reuse one instance across steps: the columns and the index keep their
+// capacity, so rebuilding does not allocate once they have grown.
+class ObjectTable {
+public:
+    static constexpr uint32_t kNoRow = 0xffffffffu;
+
+    void Build(const SensorViewScan& scan);
+    void Build(const osi3::SensorView& view);
+
+    size_t Size() const { return id.size(); }
+    bool Empty() const { return id.empty(); }
+
+    // kNoRow if absent
+    uint32_t Find(uint64_t objectId) const;
+    // kNoRow if there are no objects or host_vehicle_id names an absent object
+    uint32_t EgoRow() const { return m_egoRow; }
+    bool HasHostVehicleId() const { return m_hasHostVehicleId; }
+
+    // Columns, one entry per moving object
+    std::vector<uint64_t> id;
+    std::vector<int> type;  // osi3::MovingObject::Type
+    std::vector<double> x, y, z;
+    std::vector<double> roll, pitch, yaw;
+    std::vector<double> vx, vy, vz;
+    std::vector<double> length, width, height;
+    std::vector<uint64_t> laneId;  // first assigned lane
+    std::vector<uint8_t> hasLane;  // 0 when the object has no lane assignment (off road)
+
+private:
+    void Resize(size_t n);
+    void Finish(bool hasHost, uint64_t hostId);
+
+    // Index slots: row + 1, 0 = empty; capacity is a power of two
+    std::vector<uint32_t> m_slots;
+    uint32_t m_mask = 0;
+    uint32_t m_egoRow = kNoRow;
+    bool m_hasHostVehicleId = false;
+};
@@ -0,0 +1,524 @@
+#include "OpenDriveSurface.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+
+#include "MiniXml.h"
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+// Cubic a + b*ds + c*ds^2 + d*ds^3 starting at s
+struct Cubic {
+    double s, a, b, c, d;
+};
+
+std::vector<Cubic> ReadCubics(const MiniXml::Element* parent, const std::string& name, const char* startAttr) {
+    std::vector<Cubic> list;
+    if (!parent) return list;
+    for (auto* e : parent->Children(name)) {
+        list.push_back({e->Number(startAttr), e->Number("a"), e->Number("b"), e->Number("c"), e->Number("d")});
+    }
+    std::stable_sort(list.begin(), list.end(), [](const Cubic& l, const Cubic& r) { return l.s < r.s; });
+    return list;
+}
+
+double Evaluate(const std::vector<Cubic>& list, double s) {
+    auto it = std::upper_bound(list.begin(), list.end(), s, [](double v, const Cubic& c) { return v < c.s; });
+    if (it == list.begin()) return 0.0;
+    const Cubic& c = *(it - 1);
+    double ds = s - c.s;
+    return c.a + ds * (c.b + ds * (c.c + ds * c.d));
+}
+
+enum class Shape { Line, Arc, Spiral, Poly3, ParamPoly3 };
+
+struct Geometry {
+    double s, x, y, hdg, length;
+    Shape shape = Shape::Line;
+    double k0 = 0.0, k1 = 0.0;              // arc curvature / spiral start and end curvature
+    double p[8] = {0, 0, 0, 0, 0, 0, 0, 0};  // poly3 a..d, or paramPoly3 aU..dU aV..dV
+    bool normalized = true;                  // paramPoly3 pRange
+};
+
+Geometry ReadGeometry(const MiniXml::Element& e) {
+    Geometry g;
+    g.s = e.Number("s");
+    g.x = e.Number("x");
+    g.y = e.Number("y");
+    g.hdg = e.Number("hdg");
+    g.length = e.Number("length");
+    if (e.Child("line")) {
+        g.shape = Shape::Line;
+    } else if (auto* a = e.Child("arc")) {
+        g.shape = Shape::Arc;
+        g.k0 = a->Number("curvature");
+    } else if (auto* sp = e.Child("spiral")) {
+        g.shape = Shape::Spiral;
+        g.k0 = sp->Number("curvStart");
+        g.k1 = sp->Number("curvEnd");
+    } else if (auto* p = e.Child("poly3")) {
+        g.shape = Shape::Poly3;
+        const char* names[4] = {"a", "b", "c", "d"};
+        for (int k = 0; k < 4; ++k) g.p[k] = p->Number(names[k]);
+    } else if (auto* pp = e.Child("paramPoly3")) {
+        g.shape = Shape::ParamPoly3;
+        const char* names[8] = {"aU", "bU", "cU", "dU", "aV", "bV", "cV", "dV"};
+        for (int k = 0; k < 8; ++k) g.p[k] = pp->Number(names[k]);
+        g.normalized = pp->Text("pRange", "normalized") != "arcLength";
+    } else {
+        throw std::runtime_error("OpenDRIVE: unsupported geometry at s=" + std::to_string(g.s));
+    }
+    return g;
+}
+
+// Position and heading at distance ds from the start of the geometry
+void EvaluateGeometry(const Geometry& g, double ds, double& x, double& y, double& hdg) {
+    const double c = std::cos(g.hdg), s = std::sin(g.hdg);
+    switch (g.shape) {
+        case Shape::Line:
+            x = g.x + ds * c;
+            y = g.y + ds * s;
+            hdg = g.hdg;
+            return;
+        case Shape::Arc:
+            if (std::fabs(g.k0) < 1e-12) {
+                x = g.x + ds * c;
+                y = g.y + ds * s;
+                hdg = g.hdg;
+                return;
+            }
+            hdg = g.hdg + g.k0 * ds;
+            x = g.x + (std::sin(hdg) - s) / g.k0;
+            y = g.y + (c - std::cos(hdg)) / g.k0;
+            return;
+        case Shape::Spiral: {
+            // Heading is quadratic in ds; the position integral is evaluated with Simpson's rule
+            const double dk = g.length > 0.0 ? (g.k1 - g.k0) / g.length : 0.0;
+            auto heading = [&](double u) { return g.hdg + g.k0 * u + 0.5 * dk * u * u; };
+            int n = std::max(2, 2 * static_cast<int>(std::ceil(ds / 0.2)));
+            double h = ds / n, sx = 0.0, sy = 0.0;
+            for (int k = 0; k <= n; ++k) {
+                double w = (k == 0 || k == n) ? 1.0 : (k % 2 ? 4.0 : 2.0);
+                double a = heading(k * h);
+                sx += w * std::cos(a);
+                sy += w * std::sin(a);
+            }
+            x = g.x + sx * h / 3.0;
+            y = g.y + sy * h / 3.0;
+            hdg = heading(ds);
+            return;
+        }
+        case Shape::Poly3: {
+            // The local u coordinate is approximated by the arc length
+            double u = ds;
+            double v = g.p[0] + u * (g.p[1] + u * (g.p[2] + u * g.p[3]));
+            double dv = g.p[1] + u * (2.0 * g.p[2] + u * 3.0 * g.p[3]);
+            x = g.x + u * c - v * s;
+            y = g.y + u * s + v * c;
+            hdg = g.hdg + std::atan(dv);
+            return;
+        }
+        case Shape::ParamPoly3: {
+            double p = g.normalized ? (g.length > 0.0 ? ds / g.length : 0.0) : ds;
+            double u = g.p[0] + p * (g.p[1] + p * (g.p[2] + p * g.p[3]));
+            double v = g.p[4] + p * (g.p[5] + p * (g.p[6] + p * g.p[7]));
+            double du = g.p[1] + p * (2.0 * g.p[2] + p * 3.0 * g.p[3]);
+            double dv = g.p[5] + p * (2.0 * g.p[6] + p * 3.0 * g.p[7]);
+            x = g.x + u * c - v * s;
+            y = g.y + u * s + v * c;
+            hdg = g.hdg + std::atan2(dv, du);
+            return;
+        }
+    }
+}
+
+struct LaneSection {
+    double s;
+    std::vector<std::vector<Cubic>> left, right;  // width polynomials per lane (sOffset from s)
+};
+
+const size_t kSpanSegments = 32;
+
+}  // namespace
+
+OpenDriveSurface::OpenDriveSurface(const std::string& path, const Options& options)
+    : m_name(std::filesystem::path(path).filename().string()), m_options(options) {
+    if (!(m_options.cell > 0.0) || m_options.tileCells < 2 || !(m_options.sampleStep > 0.0)) {
+        throw std::runtime_error("OpenDRIVE surface: cell, tile_cells and sample_step must be positive");
+    }
+    m_tileSize = m_options.cell * m_options.tileCells;
+
+    LoadRoads(path);
+    BuildIndex();
+
+    size_t samples = 0;
+    for (auto& r : m_roads) samples += r.samples.size();
+    printf("[Terrain] OpenDRIVE %s: %zu roads, %zu reference-line samples, %zu tiles of %.0f m indexed "
+           "(cell %.2f m, radius %.0f m)\n",
+           m_name.c_str(), m_roads.size(), samples, m_index.size(), m_tileSize, m_options.cell, m_options.radius);
+}
+
+// -----------------------------------------------------------------------------
+// Loading
+// -----------------------------------------------------------------------------
+
+void OpenDriveSurface::LoadRoads(const std::string& path) {
+    MiniXml::Element root = MiniXml::ParseFile(path);
+    if (root.name != "OpenDRIVE") throw std::runtime_error("OpenDRIVE: " + path + " has no <OpenDRIVE> root");
+
+    for (auto* road : root.Children("road")) {
+        const double length = road->Number("length");
+        const MiniXml::Element* planView = road->Child("planView");
+        if (!planView || !(length > 0.0)) continue;
+
+        std::vector<Geometry> geometries;
+        for (auto* g : planView->Children("geometry")) geometries.push_back(ReadGeometry(*g));
+        if (geometries.empty()) continue;
+
+        auto elevation = ReadCubics(road->Child("elevationProfile"), "elevation", "s");
+        auto superelevation = ReadCubics(road->Child("lateralProfile"), "superelevation", "s");
+
+        const MiniXml::Element* lanes = road->Child("lanes");
+        auto laneOffset = ReadCubics(lanes, "laneOffset", "s");
+        std::vector<LaneSection> sections;
+        if (lanes) {
+            for (auto* ls : lanes->Children("laneSection")) {
+                LaneSection section;
+                section.s = ls->Number("s");
+                auto side = [](const MiniXml::Element* e, std::vector<std::vector<Cubic>>& out) {
+                    if (!e) return;
+                    for (auto* lane : e->Children("lane")) out.push_back(ReadCubics(lane, "width", "sOffset"));
+                };
+                side(ls->Child("left"), section.left);
+                side(ls->Child("right"), section.right);
+                sections.push_back(std::move(section));
+            }
+        }
+        std::stable_sort(sections.begin(), sections.end(),
+                         [](const LaneSection& l, const LaneSection& r) { return l.s < r.s; });
+
+        Road r;
+        r.id = road->Text("id");
+        size_t steps = static_cast<size_t>(std::ceil(length / m_options.sampleStep));
+        size_t gi = 0;
+        for (size_t k = 0; k <= steps; ++k) {
+            double s = std::min(k * m_options.sampleStep, length);
+            while (gi + 1 < geometries.size() && geometries[gi + 1].s <= s) ++gi;
+
+            Sample p;
+            const Geometry& g = geometries[gi];
+            EvaluateGeometry(g, std::min(std::max(s - g.s, 0.0), g.length), p.x, p.y, p.hdg);
+            p.z = Evaluate(elevation, s);
+            p.superelevation = Evaluate(superelevation, s);
+
+            double left = 0.0, right = 0.0;
+            auto sec = std::upper_bound(sections.begin(), sections.end(), s,
+                                        [](double v, const LaneSection& ls) { return v < ls.s; });
+            if (sec != sections.begin()) {
+                --sec;
+                for (auto& w : sec->left) left += std::max(Evaluate(w, s - sec->s), 0.0);
+                for (auto& w : sec->right) right += std::max(Evaluate(w, s - sec->s), 0.0);
+            }
+            double offset = Evaluate(laneOffset, s);
+            p.tMin = offset - right;
+            p.tMax = offset + left;
+            r.samples.push_back(p);
+        }
+        if (r.samples.size() >= 2) m_roads.push_back(std::move(r));
+    }
+    if (m_roads.empty()) throw std::runtime_error("OpenDRIVE: no roads in " + path);
+}
+
+// Every run of 32 segments is registered with all tiles its widened bounding box touches
+void OpenDriveSurface::BuildIndex() {
+    m_index.clear();
+    for (size_t ri = 0; ri < m_roads.size(); ++ri) {
+        const auto& samples = m_roads[ri].samples;
+        for (size_t b = 0; b + 1 < samples.size(); b += kSpanSegments) {
+            size_t e = std::min(b + kSpanSegments, samples.size() - 1);
+            double x0 = samples[b].x, x1 = x0, y0 = samples[b].y, y1 = y0, w = 0.0;
+            for (size_t k = b; k <= e; ++k) {
+                x0 = std::min(x0, samples[k].x);
+                x1 = std::max(x1, samples[k].x);
+                y0 = std::min(y0, samples[k].y);
+                y1 = std::max(y1, samples[k].y);
+                w = std::max({w, std::fabs(samples[k].tMin), std::fabs(samples[k].tMax)});
+            }
+            int ix0 = static_cast<int>(std::floor((x0 - w) / m_tileSize));
+            int ix1 = static_cast<int>(std::floor((x1 + w) / m_tileSize));
+            int iy0 = static_cast<int>(std::floor((y0 - w) / m_tileSize));
+            int iy1 = static_cast<int>(std::floor((y1 + w) / m_tileSize));
+            for (int iy = iy0; iy <= iy1; ++iy) {
+                for (int ix = ix0; ix <= ix1; ++ix) m_index[Key(ix, iy)].push_back({static_cast<int>(ri), b, e});
+            }
+        }
+    }
+}
+
+std::string OpenDriveSurface::FindRoadNetwork(const std::string& xoscPath) {
+    if (xoscPath.empty()) return "";
+    MiniXml::Element root = MiniXml::ParseFile(xoscPath);
+    const MiniXml::Element* network = root.Child("RoadNetwork");
+    const MiniXml::Element* logic = network ? network->Child("LogicFile") : nullptr;
+    if (!logic) return "";
+    std::string file = logic->Text("filepath");
+    if (file.empty()) return "";
+    std::filesystem::path p(file);
+    if (p.is_relative()) p = std::filesystem::path(xoscPath).parent_path() / p;
+    return p.lexically_normal().string();
+}
+
+// -----------------------------------------------------------------------------
+// Tiles
+// -----------------------------------------------------------------------------
+
+// Vertices take the height of the nearest reference-line segment whose road
+// width covers them; overlapping roads resolve to the highest.
+std::unique_ptr<OpenDriveSurface::Tile> OpenDriveSurface::Rasterize(int ix, int iy) const {
+    const int cells = m_options.tileCells;
+    const int verts = cells + 1;
+    const double cell = m_options.cell;
+    const double ox = ix * m_tileSize, oy = iy * m_tileSize;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    auto tile = std::make_unique<Tile>();
+    tile->ix = ix;
+    tile->iy = iy;
+    tile->z.assign(static_cast<size_t>(verts) * verts, nan);
+
+    const auto& spans = m_index.at(Key(ix, iy));
+    std::vector<double> dist(tile->z.size());
+    std::vector<float> roadZ(tile->z.size());
+
+    for (size_t first = 0; first < spans.size();) {
+        // Spans are stored road by road
+        size_t last = first;
+        while (last < spans.size() && spans[last].road == spans[first].road) ++last;
+        const auto& samples = m_roads[spans[first].road].samples;
+
+        std::fill(dist.begin(), dist.end(), std::numeric_limits<double>::infinity());
+        std::fill(roadZ.begin(), roadZ.end(), nan);
+
+        for (size_t si = first; si < last; ++si) {
+            for (size_t k = spans[si].begin; k < spans[si].end; ++k) {
+                const Sample& a = samples[k];
+                const Sample& b = samples[k + 1];
+                double dx = b.x - a.x, dy = b.y - a.y;
+                double len2 = dx * dx + dy * dy;
+                if (!(len2 > 0.0)) continue;
+                double len = std::sqrt(len2);
+                double ux = dx / len, uy = dy / len;
+
+                // Rasterize only the segment's cross-section quad, lengthened to close the
+                // gaps that open at the outside of curves between neighbouring quads
+                double w = std::max({std::fabs(a.tMin), std::fabs(a.tMax), std::fabs(b.tMin), std::fabs(b.tMax)});
+                double ext = w * std::fabs(std::remainder(b.hdg - a.hdg, kTwoPi)) + cell;
+                const double qx[4] = {a.x - ux * ext - uy * a.tMin, a.x - ux * ext - uy * a.tMax,
+                                      b.x + ux * ext - uy * b.tMax, b.x + ux * ext - uy * b.tMin};
+                const double qy[4] = {a.y - uy * ext + ux * a.tMin, a.y - uy * ext + ux * a.tMax,
+                                      b.y + uy * ext + ux * b.tMax, b.y + uy * ext + ux * b.tMin};
+
+                double minY = std::min({qy[0], qy[1], qy[2], qy[3]}), maxY = std::max({qy[0], qy[1], qy[2], qy[3]});
+                int r0 = std::max(0, static_cast<int>(std::ceil((minY - oy) / cell)));
+                int r1 = std::min(cells, static_cast<int>(std::floor((maxY - oy) / cell)));
+
+                for (int r = r0; r <= r1; ++r) {
+                    const double yr = oy + r * cell;
+                    double x0 = std::numeric_limits<double>::infinity(), x1 = -x0;
+                    for (int e = 0; e < 4; ++e) {
+                        int f = (e + 1) % 4;
+                        if ((qy[e] - yr) * (qy[f] - yr) > 0.0 || qy[e] == qy[f]) continue;
+                        double xe = qx[e] + (yr - qy[e]) * (qx[f] - qx[e]) / (qy[f] - qy[e]);
+                        x0 = std::min(x0, xe);
+                        x1 = std::max(x1, xe);
+                    }
+                    if (x0 > x1) continue;
+                    int c0 = std::max(0, static_cast<int>(std::ceil((x0 - ox) / cell)));
+                    int c1 = std::min(cells, static_cast<int>(std::floor((x1 - ox) / cell)));
+
+                    double py = oy + r * cell - a.y;
+                    for (int c = c0; c <= c1; ++c) {
+                        double px = ox + c * cell - a.x;
+                        double t = std::min(std::max((px * dx + py * dy) / len2, 0.0), 1.0);
+                        double ex = px - t * dx, ey = py - t * dy;
+                        double d2 = ex * ex + ey * ey;
+                        size_t idx = static_cast<size_t>(r) * verts + c;
+                        if (d2 >= dist[idx]) continue;
+
+                        double lateral = std::copysign(std::sqrt(d2), dx * py - dy * px);
+                        double tMin = a.tMin + t * (b.tMin - a.tMin);
+                        double tMax = a.tMax + t * (b.tMax - a.tMax);
+                        if (lateral < tMin || lateral > tMax) continue;
+
+                        double roll = a.superelevation + t * (b.superelevation - a.superelevation);
+                        dist[idx] = d2;
+                        roadZ[idx] = static_cast<float>(a.z + t * (b.z - a.z) + lateral * std::tan(roll));
+                    }
+                }
+            }
+        }
+
+        for (size_t v = 0; v < tile->z.size(); ++v) {
+            if (std::isnan(roadZ[v])) continue;
+            tile->z[v] = std::isnan(tile->z[v]) ? roadZ[v] : std::max(tile->z[v], roadZ[v]);
+        }
+        first = last;
+    }
+
+    ++m_built;
+    return tile;
+}
+
+const OpenDriveSurface::Tile* OpenDriveSurface::GetTile(int ix, int iy) const {
+    uint64_t key = Key(ix, iy);
+    auto it = m_tiles.find(key);
+    if (it == m_tiles.end()) {
+        if (m_index.find(key) == m_index.end()) return nullptr;
+        it = m_tiles.emplace(key, Rasterize(ix, iy)).first;
+    }
+    it->second->lastUse = m_clock;
+    return it->second.get();
+}
+
+void OpenDriveSurface::Update(size_t n, const double* x, const double* y) {
+    if (n == 0) return;
+    ++m_clock;
+
+    // Tiles under the wheels are needed now; the rest of the disc around them is prefetched
+    double cx = 0.0, cy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        GetTile(static_cast<int>(std::floor(x[i] / m_tileSize)), static_cast<int>(std::floor(y[i] / m_tileSize)));
+        cx += x[i];
+        cy += y[i];
+    }
+    cx /= n;
+    cy /= n;
+
+    const double radius = m_options.radius;
+    auto distance = [&](int ix, int iy) {
+        return std::hypot((ix + 0.5) * m_tileSize - cx, (iy + 0.5) * m_tileSize - cy);
+    };
+
+    std::vector<std::pair<double, uint64_t>> missing;
+    int ix0 = static_cast<int>(std::floor((cx - radius) / m_tileSize));
+    int ix1 = static_cast<int>(std::floor((cx + radius) / m_tileSize));
+    int iy0 = static_cast<int>(std::floor((cy - radius) / m_tileSize));
+    int iy1 = static_cast<int>(std::floor((cy + radius) / m_tileSize));
+    for (int iy = iy0; iy <= iy1; ++iy) {
+        for (int ix = ix0; ix <= ix1; ++ix) {
+            uint64_t key = Key(ix, iy);
+            double d = distance(ix, iy);
+            if (d > radius + 0.71 * m_tileSize) continue;
+            auto it = m_tiles.find(key);
+            if (it != m_tiles.end()) {
+                it->second->lastUse = m_clock;
+            } else if (m_index.count(key)) {
+                missing.emplace_back(d, key);
+            }
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+    for (size_t k = 0; k < missing.size() && static_cast<int>(k) < m_options.buildsPerUpdate; ++k) {
+        int ix = static_cast<int>(static_cast<uint32_t>(missing[k].second >> 32));
+        int iy = static_cast<int>(static_cast<uint32_t>(missing[k].second));
+        GetTile(ix, iy);
+    }
+
+    // Drop tiles that fell behind (with one tile of hysteresis)
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        if (it->second->lastUse != m_clock && distance(it->second->ix, it->second->iy) > radius + m_tileSize) {
+            it = m_tiles.erase(it);
+            ++m_evicted;
+        } else {
+            ++it;
+        }
+    }
+    m_peakTiles = std::max(m_peakTiles, m_tiles.size());
+}
+
+// -----------------------------------------------------------------------------
+// Query
+// -----------------------------------------------------------------------------
+
+void OpenDriveSurface::Query(size_t /*first*/, size_t n, const double* x, const double* y, double* top,
+                             double* height, double* nx, double* ny, double* nz, double* mu) const {
+    const int cells = m_options.tileCells;
+    const size_t verts = static_cast<size_t>(cells) + 1;
+    const double invCell = 1.0 / m_options.cell;
+
+    const size_t chunk = 64;
+    double fu[chunk], fv[chunk], z00[chunk], z10[chunk], z01[chunk], z11[chunk];
+    bool covered[chunk];
+
+    for (size_t base = 0; base < n; base += chunk) {
+        const size_t m = std::min(chunk, n - base);
+
+        // Pass 1: tile lookup and gather of the cell corners
+        for (size_t i = 0; i < m; ++i) {
+            double px = x[base + i], py = y[base + i];
+            int ix = static_cast<int>(std::floor(px / m_tileSize));
+            int iy = static_cast<int>(std::floor(py / m_tileSize));
+
+            const Tile* tile = nullptr;
+            auto it = m_tiles.find(Key(ix, iy));
+            if (it != m_tiles.end()) {
+                tile = it->second.get();
+            } else if ((tile = GetTile(ix, iy)) != nullptr) {
+                ++m_stalls;  // not streamed in ahead of time
+            }
+
+            double gx = (px - ix * m_tileSize) * invCell;
+            double gy = (py - iy * m_tileSize) * invCell;
+            int c = std::min(std::max(static_cast<int>(gx), 0), cells - 1);
+            int r = std::min(std::max(static_cast<int>(gy), 0), cells - 1);
+            fu[i] = gx - c;
+            fv[i] = gy - r;
+
+            if (tile) {
+                const float* row0 = tile->z.data() + r * verts + c;
+                const float* row1 = row0 + verts;
+                z00[i] = row0[0];
+                z10[i] = row0[1];
+                z01[i] = row1[0];
+                z11[i] = row1[1];
+            } else {
+                z00[i] = z10[i] = z01[i] = z11[i] = std::numeric_limits<double>::quiet_NaN();
+            }
+            covered[i] = !(std::isnan(z00[i]) || std::isnan(z10[i]) || std::isnan(z01[i]) || std::isnan(z11[i]));
+        }
+
+        // Pass 2: bilinear height and normal over SoA arrays, branch free
+        for (size_t i = 0; i < m; ++i) {
+            const double u = fu[i], v = fv[i];
+            double a = covered[i] ? z00[i] : 0.0, b = covered[i] ? z10[i] : 0.0;
+            double c = covered[i] ? z01[i] : 0.0, d = covered[i] ? z11[i] : 0.0;
+
+            double zi = (1 - v) * ((1 - u) * a + u * b) + v * ((1 - u) * c + u * d);
+            double dzdx = ((1 - v) * (b - a) + v * (d - c)) * invCell;
+            double dzdy = ((1 - u) * (c - a) + u * (d - b)) * invCell;
+            double inv = 1.0 / std::sqrt(dzdx * dzdx + dzdy * dzdy + 1.0);
+            double wz = m_options.z + zi;
+
+            bool take = covered[i] && wz > top[base + i];
+            top[base + i] = take ? wz : top[base + i];
+            height[base + i] = take ? wz : height[base + i];
+            nx[base + i] = take ? -dzdx * inv : nx[base + i];
+            ny[base + i] = take ? -dzdy * inv : ny[base + i];
+            nz[base + i] = take ? inv : nz[base + i];
+            mu[base + i] = take ? m_options.mu : mu[base + i];
+        }
+    }
+}
+
+void OpenDriveSurface::PrintStats() const {
+    printf("[Terrain] OpenDRIVE %s: %llu tiles built, %llu evicted, peak %zu resident (%.1f MB), %llu query stalls\n",
+           m_name.c_str(), static_cast<unsigned long long>(m_built), static_cast<unsigned long long>(m_evicted),
+           m_peakTiles, m_peakTiles * std::pow(m_options.tileCells + 1.0, 2) * sizeof(float) / (1024.0 * 1024.0),
+           static_cast<unsigned long long>(m_stalls));
+}
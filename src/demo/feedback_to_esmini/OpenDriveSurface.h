@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "NativeTerrain.h"
+
+// Road surface derived from an OpenDRIVE network (esmini resources/xodr/*.xodr).
+//
+// At load time every road's plan view (line, arc, spiral, poly3, paramPoly3),
+// elevation profile, superelevation, lane offset and lane widths are sampled
+// along the reference line, and the samples are indexed by heightfield tile.
+// The heightfield itself is built lazily: tiles of `tile_cells` x `tile_cells`
+// cells are rasterized when the wheels come within `radius` of them and are
+// dropped again once they fall behind, so large maps never exist as one mesh.
+// A query is a hash lookup of its tile plus a bilinear interpolation.
+//
+// Height at lateral offset t is z(s) + t * tan(superelevation(s)); the road
+// covers the full width of its lanes (including borders). Where roads overlap
+// the highest wins, so overpasses are not represented. <shape> is ignored.
+class OpenDriveSurface : public TerrainSurface {
+public:
+    struct Options {
+        double cell = 0.25;          // heightfield resolution [m]
+        int tileCells = 128;         // tile edge in cells
+        double sampleStep = 0.5;     // reference-line sampling [m]
+        double radius = 80.0;        // keep tiles within this distance of the wheels [m]
+        int buildsPerUpdate = 2;     // prefetched tiles rasterized per step
+        double z = 0.0;              // height offset of the whole network
+        double mu = 0.8;
+    };
+
+    // Throws std::runtime_error on unreadable files or unsupported geometry
+    OpenDriveSurface(const std::string& path, const Options& options);
+
+    const std::string& GetName() const override { return m_name; }
+    void Query(size_t first, size_t n, const double* x, const double* y, double* top,
+               double* height, double* nx, double* ny, double* nz, double* mu) const override;
+    void Update(size_t n, const double* x, const double* y) override;
+    void PrintStats() const override;
+
+    // LogicFile of an OpenSCENARIO file, resolved against the scenario's directory ("" if none)
+    static std::string FindRoadNetwork(const std::string& xoscPath);
+
+private:
+    struct Sample {
+        double x, y, hdg;
+        double z, superelevation;
+        double tMin, tMax;  // lateral extent of the road (right negative)
+    };
+
+    struct Road {
+        std::string id;
+        std::vector<Sample> samples;
+    };
+
+    struct Span {
+        int road;
+        size_t begin, end;  // segments [begin, end)
+    };
+
+    struct Tile {
+        int ix = 0, iy = 0;
+        std::vector<float> z;  // (cells + 1)^2 vertices, row-major along +Y, NaN off the road
+        uint64_t lastUse = 0;
+    };
+
+    static uint64_t Key(int ix, int iy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+    }
+
+    void LoadRoads(const std::string& path);
+    void BuildIndex();
+    // Resident tile, rasterized on demand; nullptr if no road touches it
+    const Tile* GetTile(int ix, int iy) const;
+    std::unique_ptr<Tile> Rasterize(int ix, int iy) const;
+
+    std::string m_name;
+    Options m_options;
+    double m_tileSize = 0.0;
+
+    std::vector<Road> m_roads;
+    std::unordered_map<uint64_t, std::vector<Span>> m_index;
+
+    mutable std::unordered_map<uint64_t, std::unique_ptr<Tile>> m_tiles;
+    mutable uint64_t m_clock = 0;
+    mutable uint64_t m_built = 0, m_stalls = 0, m_evicted = 0;
+    size_t m_peakTiles = 0;
+};
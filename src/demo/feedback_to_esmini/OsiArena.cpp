@@ -0,0 +1,70 @@
+#include "OsiArena.h"
+
+#include <algorithm>
+#include <cstdio>
+
+OsiArena::Options OsiArena::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.initialBlock = static_cast<size_t>(config.GetDouble(root + ".initial_block", static_cast<double>(o.initialBlock)));
+    o.maxBlock = static_cast<size_t>(config.GetDouble(root + ".max_block", static_cast<double>(o.maxBlock)));
+    o.headroom = std::max(1.0, config.GetDouble(root + ".headroom", o.headroom));
+    o.maxBlock = std::max(o.maxBlock, o.initialBlock);
+    return o;
+}
+
+OsiArena::OsiArena(const Options& options) : m_options(options) {
+    CreateArena(m_options.initialBlock);
+}
+
+OsiArena::~OsiArena() {
+    // The arena must go before the block it was built on
+    m_arena.reset();
+}
+
+void OsiArena::CreateArena(size_t blockSize) {
+    m_arena.reset();
+    m_block.assign(blockSize, 0);
+
+    google::protobuf::ArenaOptions arenaOptions;
+    arenaOptions.initial_block = m_block.data();
+    arenaOptions.initial_block_size = m_block.size();
+    arenaOptions.start_block_size = 64 * 1024;  // overflow blocks, only until the next regrow
+    arenaOptions.max_block_size = m_options.maxBlock;
+    m_arena = std::make_unique<google::protobuf::Arena>(arenaOptions);
+}
+
+void OsiArena::BeginStep() {
+    // Allocated counts the whole initial block from the first message on, so it only tells
+    // whether the step spilled; the statistic is what the messages actually used
+    size_t used = static_cast<size_t>(m_arena->SpaceAllocated());
+    ++m_steps;
+    m_peak = std::max(m_peak, static_cast<size_t>(m_arena->SpaceUsed()));
+
+    if (used <= m_block.size()) {
+        m_arena->Reset();
+        return;
+    }
+
+    // The last step spilled into heap blocks: rebuild on a block that holds it
+    ++m_overflowSteps;
+    size_t grown = static_cast<size_t>(static_cast<double>(used) * m_options.headroom);
+    grown = std::min((grown + 4095) / 4096 * 4096, m_options.maxBlock);
+    if (grown > m_block.size()) {
+        ++m_regrows;
+        CreateArena(grown);
+    } else {
+        m_arena->Reset();
+    }
+}
+
+osi3::SensorView* OsiArena::ParseSensorView(const void* data, int size) {
+    if (size <= 0 || !data) return nullptr;
+    auto* sv = New<osi3::SensorView>();
+    return sv->ParseFromArray(data, size) ? sv : nullptr;
+}
+
+void OsiArena::PrintStats() const {
+    printf("[OSI] Arena: %llu steps, peak %.1f KiB used per step, block %.1f KiB, %llu steps spilled to heap, %llu regrows\n",
+           static_cast<unsigned long long>(m_steps), m_peak / 1024.0, m_block.size() / 1024.0,
+           static_cast<unsigned long long>(m_overflowSteps), static_cast<unsigned long long>(m_regrows));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+
+#include "DemoConfiguration.h"
+#include "osi_sensorview.pb.h"
+#include "osi_trafficupdate.pb.h"
+
+// Per-step OSI messages on a protobuf Arena.
+//
+// Every SensorView / GroundTruth the master builds or parses during a macro
+// step is allocated here and released together by BeginStep(). The arena
+// starts on a block owned by this object; when a step needed more than that,
+// the block is regrown to the observed size plus headroom at the next
+// BeginStep(), so after the first steps the OSI path runs without malloc/free.
+// Messages returned by the Parse / New functions are valid until the next
+// BeginStep().
+class OsiArena {
+public:
+    struct Options {
+        size_t initialBlock = 256 * 1024;  // initial block [bytes], regrown from the observed step size
+        size_t maxBlock = 16 * 1024 * 1024;
+        double headroom = 1.25;
+
+        // "simulation.osi_arena": initial_block, max_block [bytes], headroom
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    explicit OsiArena(const Options& options);
+    ~OsiArena();
+
+    OsiArena(const OsiArena&) = delete;
+    OsiArena& operator=(const OsiArena&) = delete;
+
+    // Releases all messages of the previous step
+    void BeginStep();
+
+    template <class T>
+    T* New() {
+#if GOOGLE_PROTOBUF_VERSION >= 5026000
+        return google::protobuf::Arena::Create<T>(m_arena.get());
+#else
+        // Before the Create / CreateMessage unification, Create<Message> ignores the arena
+        return google::protobuf::Arena::CreateMessage<T>(m_arena.get());
+#endif
+    }
+
+    // Parses an OSMP buffer; nullptr on empty or undecodable input
+    osi3::SensorView* ParseSensorView(const void* data, int size);
+
+    void PrintStats() const;
+
+private:
+    void CreateArena(size_t blockSize);
+
+    Options m_options;
+    std::vector<char> m_block;
+    std::unique_ptr<google::protobuf::Arena> m_arena;
+
+    uint64_t m_steps = 0, m_overflowSteps = 0, m_regrows = 0;
+    size_t m_peak = 0;  // SpaceUsed() of the largest step
+};
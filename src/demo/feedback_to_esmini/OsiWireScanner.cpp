@@ -0,0 +1,123 @@
+#include "OsiWireScanner.h"
+
+namespace {
+
+// Field numbers from osi_sensorview.proto / osi_groundtruth.proto / osi_object.proto / osi_common.proto
+constexpr uint32_t kSensorViewGlobalGroundTruth = 7;
+constexpr uint32_t kSensorViewHostVehicleId = 8;
+constexpr uint32_t kGroundTruthHostVehicleId = 3;
+constexpr uint32_t kGroundTruthMovingObject = 5;
+constexpr uint32_t kMovingObjectId = 1;
+constexpr uint32_t kMovingObjectBase = 2;
+constexpr uint32_t kMovingObjectType = 3;
+constexpr uint32_t kMovingObjectAssignedLaneId = 4;
+constexpr uint32_t kMovingObjectClassification = 9;
+constexpr uint32_t kClassificationAssignedLaneId = 1;
+constexpr uint32_t kBaseDimension = 1;
+constexpr uint32_t kBasePosition = 2;
+constexpr uint32_t kBaseOrientation = 3;
+constexpr uint32_t kBaseVelocity = 4;
+constexpr uint32_t kBaseAcceleration = 5;
+constexpr uint32_t kIdentifierValue = 1;
+
+uint64_t ReadIdentifier(WireReader r) {
+    uint64_t value = 0;
+    while (r.Next()) {
+        if (r.Field() == kIdentifierValue && r.Type() == WireReader::kVarint) value = r.Varint();
+    }
+    return value;
+}
+
+// Vector3d (x, y, z), Orientation3d (roll, pitch, yaw) and Dimension3d (length,
+// width, height) all carry three doubles in fields 1..3
+void ReadTriple(WireReader r, double* v) {
+    while (r.Next()) {
+        if (r.Type() == WireReader::kFixed64 && r.Field() >= 1 && r.Field() <= 3) v[r.Field() - 1] = r.Double();
+    }
+}
+
+void ReadBase(WireReader r, ScannedObject& obj) {
+    obj.hasBase = true;
+    while (r.Next()) {
+        if (r.Type() != WireReader::kLength) continue;
+        switch (r.Field()) {
+        case kBaseDimension: ReadTriple(r.Message(), obj.dimension); break;
+        case kBasePosition: ReadTriple(r.Message(), obj.position); break;
+        case kBaseOrientation: ReadTriple(r.Message(), obj.orientation); break;
+        case kBaseVelocity: ReadTriple(r.Message(), obj.velocity); break;
+        case kBaseAcceleration: ReadTriple(r.Message(), obj.acceleration); break;
+        default: break;
+        }
+    }
+}
+
+void AssignLane(ScannedObject& obj, WireReader id) {
+    if (obj.hasLane) return;
+    obj.hasLane = true;
+    obj.laneId = ReadIdentifier(id);
+}
+
+bool ScanMovingObject(WireReader r, ScannedObject& obj) {
+    while (r.Next()) {
+        if (r.Field() == kMovingObjectType && r.Type() == WireReader::kVarint) {
+            obj.type = static_cast<int>(r.Varint());
+            continue;
+        }
+        if (r.Type() != WireReader::kLength) continue;
+        if (r.Field() == kMovingObjectId) {
+            obj.id = ReadIdentifier(r.Message());
+        } else if (r.Field() == kMovingObjectBase) {
+            ReadBase(r.Message(), obj);
+        } else if (r.Field() == kMovingObjectAssignedLaneId) {
+            AssignLane(obj, r.Message());
+        } else if (r.Field() == kMovingObjectClassification) {
+            WireReader c = r.Message();
+            while (c.Next()) {
+                if (c.Field() == kClassificationAssignedLaneId && c.Type() == WireReader::kLength) AssignLane(obj, c.Message());
+            }
+        }
+    }
+    return !r.Failed();
+}
+
+bool ScanGroundTruth(WireReader r, SensorViewScan& scan) {
+    while (r.Next()) {
+        if (r.Type() != WireReader::kLength) continue;
+        if (r.Field() == kGroundTruthHostVehicleId) {
+            scan.groundTruthHostVehicleId = ReadIdentifier(r.Message());
+            scan.hasGroundTruthHostVehicleId = true;
+        } else if (r.Field() == kGroundTruthMovingObject) {
+            scan.movingObjects.emplace_back();
+            ScannedObject& obj = scan.movingObjects.back();
+            obj.data = r.Data();
+            obj.size = r.Size();
+            if (!ScanMovingObject(r.Message(), obj)) return false;
+        }
+    }
+    return !r.Failed();
+}
+
+}  // namespace
+
+bool ScanSensorView(const void* data, size_t size, SensorViewScan& scan) {
+    scan.hasHostVehicleId = false;
+    scan.hostVehicleId = 0;
+    scan.hasGroundTruthHostVehicleId = false;
+    scan.groundTruthHostVehicleId = 0;
+    scan.movingObjects.clear();
+    if (!data || size == 0) return false;
+
+    // A repeated message field may in principle be split over several
+    // occurrences of global_ground_truth; protobuf merges them, so do we
+    WireReader r(data, size);
+    while (r.Next()) {
+        if (r.Type() != WireReader::kLength) continue;
+        if (r.Field() == kSensorViewHostVehicleId) {
+            scan.hostVehicleId = ReadIdentifier(r.Message());
+            scan.hasHostVehicleId = true;
+        } else if (r.Field() == kSensorViewGlobalGroundTruth) {
+            if (!ScanGroundTruth(r.Message(), scan)) return false;
+        }
+    }
+    return !r.Failed();
+}
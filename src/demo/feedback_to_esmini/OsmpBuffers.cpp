@@ -0,0 +1,33 @@
+#include "OsmpBuffers.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+OsmpBufferRing::OsmpBufferRing(const std::string& name, size_t depth)
+    : m_name(name), m_slots(std::max<size_t>(depth, 2)) {}
+
+OsmpBuffer& OsmpBufferRing::Acquire() {
+    // The slot of the next publication was last published `depth` publications ago
+    if (m_published - m_released >= m_slots.size()) {
+        throw std::runtime_error("OSMP buffer ring '" + m_name + "': all " + std::to_string(m_slots.size()) +
+                                 " buffers are still held by the consumer");
+    }
+    return m_slots[m_published % m_slots.size()];
+}
+
+OsmpPointer OsmpBufferRing::Publish() {
+    OsmpBuffer& buffer = Acquire();
+    if (buffer.data.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::runtime_error("OSMP buffer ring '" + m_name + "': message exceeds the OSMP size range");
+    }
+    OsmpPointer ptr;
+    EncodeOSMPPointer(buffer.data.data(), ptr.lo, ptr.hi);
+    ptr.size = static_cast<int32_t>(buffer.data.size());
+    ++m_published;
+    return ptr;
+}
+
+void OsmpBufferRing::Release(uint64_t count) {
+    m_released = std::max(m_released, std::min(count, m_published));
+}
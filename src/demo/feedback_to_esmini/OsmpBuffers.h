@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// OSMP (OSI Sensor Model Packaging) passes a serialized message between FMUs
+// as three integers: the buffer address split into lo / hi 32-bit halves and
+// the size. The address is only meaningful within this process.
+inline void* DecodeOSMPPointer(int32_t lo, int32_t hi) {
+    uint64_t ptr_value = (static_cast<uint64_t>(static_cast<uint32_t>(hi)) << 32) |
+                         static_cast<uint64_t>(static_cast<uint32_t>(lo));
+    return reinterpret_cast<void*>(ptr_value);
+}
+
+inline void EncodeOSMPPointer(const void* ptr, int32_t& lo, int32_t& hi) {
+    uint64_t val = reinterpret_cast<uint64_t>(ptr);
+    lo = static_cast<int32_t>(val & 0xFFFFFFFF);
+    hi = static_cast<int32_t>((val >> 32) & 0xFFFFFFFF);
+}
+
+struct OsmpPointer {
+    int32_t lo = 0, hi = 0, size = 0;
+};
+
+// One outgoing buffer. contentId lets a writer tell whether the slot already
+// holds its encoding (e.g. a pre-encoded template) and only needs patching.
+struct OsmpBuffer {
+    std::string data;
+    uint64_t contentId = 0;
+};
+
+// Outgoing OSMP buffers of one master -> FMU connection, owned as a ring.
+//
+// The master fills the buffer returned by Acquire(), hands it out with
+// Publish() and, once the consumer can no longer read it (its fmi2DoStep for
+// that input has returned), reports that with Release(). A published buffer is
+// never handed out for writing again before it is released, so with a depth
+// of N the master can prepare up to N - 1 further inputs while the consumer is
+// still stepping on an older one. Acquire() throws instead of overwriting a
+// held buffer.
+class OsmpBufferRing {
+public:
+    OsmpBufferRing(const std::string& name, size_t depth);
+
+    // Buffer for the next Publish(); the same one until Publish() is called
+    OsmpBuffer& Acquire();
+    // Hands the acquired buffer to the consumer
+    OsmpPointer Publish();
+    // The consumer is done with every buffer published so far
+    void Release() { m_released = m_published; }
+    // ... or with the first `count` published buffers
+    void Release(uint64_t count);
+
+    uint64_t Published() const { return m_published; }
+    size_t Depth() const { return m_slots.size(); }
+
+private:
+    std::string m_name;
+    std::vector<OsmpBuffer> m_slots;
+    uint64_t m_published = 0, m_released = 0;
+};
@@ -0,0 +1,233 @@
+#include "ParallelExecutor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#include <immintrin.h>
+static inline void CpuRelax() { _mm_pause(); }
+#else
+static inline void CpuRelax() { std::this_thread::yield(); }
+#endif
+
+// -----------------------------------------------------------------------------
+// SpinBarrier
+// -----------------------------------------------------------------------------
+
+SpinBarrier::SpinBarrier(int participants, int spinIterations)
+    : m_participants(participants), m_spinIterations(spinIterations) {}
+
+void SpinBarrier::Wait() {
+    const uint64_t gen = m_generation.load(std::memory_order_acquire);
+
+    if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_participants) {
+        // Last arrival releases everybody. The generation is bumped under the
+        // mutex so a thread that is about to park cannot miss the notification.
+        m_arrived.store(0, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation.fetch_add(1, std::memory_order_release);
+        }
+        m_cv.notify_all();
+        return;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    bool released = false;
+    for (int i = 0; i < m_spinIterations; ++i) {
+        if (m_generation.load(std::memory_order_acquire) != gen) {
+            released = true;
+            break;
+        }
+        CpuRelax();
+    }
+
+    if (released) {
+        m_spinHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_generation.load(std::memory_order_acquire) != gen; });
+        m_parks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    m_waits.fetch_add(1, std::memory_order_relaxed);
+    m_waitNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+}
+
+BarrierStats SpinBarrier::GetStats() const {
+    BarrierStats s;
+    s.waits = m_waits.load();
+    s.spin_hits = m_spinHits.load();
+    s.parks = m_parks.load();
+    s.wait_seconds = m_waitNs.load() * 1e-9;
+    return s;
+}
+
+// -----------------------------------------------------------------------------
+// ParallelOptions
+// -----------------------------------------------------------------------------
+
+ParallelOptions ParallelOptions::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    ParallelOptions o;
+    o.enabled = config.GetBool(root + ".enabled", false);
+    o.workers = static_cast<int>(config.GetDouble(root + ".workers", 0.0));
+    o.spin_iterations = static_cast<int>(config.GetDouble(root + ".spin_iterations", o.spin_iterations));
+    o.master_cpu = static_cast<int>(config.GetDouble(root + ".master_cpu", -1.0));
+
+    auto cpus = config.Get(root + ".worker_cpus");
+    if (cpus.type == MiniJSON::Type::Array) {
+        for (auto& v : cpus.a_val) o.worker_cpus.push_back(static_cast<int>(v.as_double()));
+    }
+
+    auto inst = config.Get(root + ".instance_cpus");
+    if (inst.type == MiniJSON::Type::Object) {
+        for (auto& [name, v] : inst.o_val) o.instance_cpus[name] = static_cast<int>(v.as_double());
+    }
+    return o;
+}
+
+// -----------------------------------------------------------------------------
+// ParallelExecutor
+// -----------------------------------------------------------------------------
+
+bool ParallelExecutor::PinCurrentThread(int cpu) {
+    if (cpu < 0) return true;
+#ifdef _WIN32
+    if (cpu >= 64) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+ParallelExecutor::ParallelExecutor(const ParallelOptions& options) : m_options(options) {
+    if (!m_options.enabled) return;
+
+    if (!PinCurrentThread(m_options.master_cpu)) {
+        printf("[Parallel] Warning: could not pin master thread to CPU %d\n", m_options.master_cpu);
+    }
+
+    m_numGeneral = m_options.workers;
+    if (m_numGeneral <= 0) {
+        int hw = static_cast<int>(std::thread::hardware_concurrency());
+        m_numGeneral = hw > 1 ? hw - 1 : 1;
+    }
+    m_numWorkers = m_numGeneral + static_cast<int>(m_options.instance_cpus.size());
+
+    m_queues.resize(m_numWorkers);
+    m_errors.resize(m_numWorkers);
+    m_start = std::make_unique<SpinBarrier>(m_numWorkers + 1, m_options.spin_iterations);
+    m_end = std::make_unique<SpinBarrier>(m_numWorkers + 1, m_options.spin_iterations);
+
+    std::vector<int> cpus(m_numWorkers, -1);
+    for (int i = 0; i < m_numGeneral && i < static_cast<int>(m_options.worker_cpus.size()); ++i) {
+        cpus[i] = m_options.worker_cpus[i];
+    }
+    int idx = m_numGeneral;
+    for (auto& [name, cpu] : m_options.instance_cpus) {
+        m_dedicated[name] = idx;
+        cpus[idx] = cpu;
+        ++idx;
+    }
+
+    for (int i = 0; i < m_numWorkers; ++i) {
+        m_threads.emplace_back(&ParallelExecutor::WorkerLoop, this, i, cpus[i]);
+    }
+
+    printf("[Parallel] %d general + %d dedicated workers, spin %d iterations\n",
+           m_numGeneral, m_numWorkers - m_numGeneral, m_options.spin_iterations);
+    for (auto& [name, w] : m_dedicated) {
+        printf("[Parallel]   %s -> worker %d (CPU %d)\n", name.c_str(), w, cpus[w]);
+    }
+}
+
+ParallelExecutor::~ParallelExecutor() {
+    if (m_threads.empty()) return;
+    m_stop.store(true, std::memory_order_release);
+    m_start->Wait();
+    for (auto& t : m_threads) t.join();
+}
+
+int ParallelExecutor::AssignWorker(const std::string& instanceName, int slot) {
+    if (!IsParallel()) return 0;
+    auto it = m_dedicated.find(instanceName);
+    if (it != m_dedicated.end()) return it->second;
+    return slot % m_numGeneral;
+}
+
+void ParallelExecutor::WorkerLoop(int index, int cpu) {
+    if (!PinCurrentThread(cpu)) {
+        printf("[Parallel] Warning: could not pin worker %d to CPU %d\n", index, cpu);
+    }
+
+    while (true) {
+        m_start->Wait();
+        if (m_stop.load(std::memory_order_acquire)) break;
+
+        try {
+            for (auto* fn : m_queues[index]) (*fn)();
+        } catch (...) {
+            m_errors[index] = std::current_exception();
+        }
+
+        m_end->Wait();
+    }
+}
+
+void ParallelExecutor::RunStage(const std::vector<Task>& tasks) {
+    if (!IsParallel()) {
+        for (auto& t : tasks) t.fn();
+        return;
+    }
+
+    for (auto& q : m_queues) q.clear();
+    for (auto& t : tasks) m_queues[t.worker % m_numWorkers].push_back(&t.fn);
+
+    m_start->Wait();
+    m_end->Wait();
+    m_stages++;
+
+    for (auto& e : m_errors) {
+        if (e) {
+            auto err = e;
+            e = nullptr;
+            std::rethrow_exception(err);
+        }
+    }
+}
+
+BarrierStats ParallelExecutor::GetStartStats() const {
+    return m_start ? m_start->GetStats() : BarrierStats();
+}
+
+BarrierStats ParallelExecutor::GetEndStats() const {
+    return m_end ? m_end->GetStats() : BarrierStats();
+}
+
+void ParallelExecutor::PrintStats() const {
+    if (!IsParallel()) return;
+
+    auto print = [&](const char* name, const BarrierStats& s) {
+        double avg_us = s.waits > 0 ? s.wait_seconds * 1e6 / s.waits : 0.0;
+        printf("[Parallel] %-5s barrier: waits=%llu spin=%llu park=%llu total=%.3f s avg=%.2f us\n",
+               name, (unsigned long long)s.waits, (unsigned long long)s.spin_hits,
+               (unsigned long long)s.parks, s.wait_seconds, avg_us);
+    };
+
+    printf("[Parallel] %llu stages on %d workers\n", (unsigned long long)m_stages, m_numWorkers);
+    print("start", GetStartStats());
+    print("end", GetEndStats());
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DemoConfiguration.h"
+
+// Wait-time counters of one barrier, summed over all participants
+struct BarrierStats {
+    uint64_t waits = 0;      // number of Wait() calls that had to wait
+    uint64_t spin_hits = 0;  // released while still spinning
+    uint64_t parks = 0;      // fell back to the condition variable
+    double wait_seconds = 0.0;
+};
+
+// Hybrid barrier: spins for a bounded number of iterations, then parks on a
+// condition variable. With 2 ms substeps the release usually comes within the
+// spin window, which avoids the futex wake-up latency of a pure CV barrier.
+class SpinBarrier {
+public:
+    SpinBarrier(int participants, int spinIterations);
+
+    void Wait();
+
+    BarrierStats GetStats() const;
+
+private:
+    const int m_participants;
+    const int m_spinIterations;
+
+    std::atomic<int> m_arrived{0};
+    std::atomic<uint64_t> m_generation{0};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    std::atomic<uint64_t> m_waits{0};
+    std::atomic<uint64_t> m_spinHits{0};
+    std::atomic<uint64_t> m_parks{0};
+    std::atomic<uint64_t> m_waitNs{0};
+};
+
+// Settings read from "simulation.parallel" in demo_config.json
+struct ParallelOptions {
+    bool enabled = false;
+    int workers = 0;                           // 0: hardware_concurrency - 1
+    int spin_iterations = 20000;
+    int master_cpu = -1;                       // -1: leave the master thread unpinned
+    std::vector<int> worker_cpus;              // CPU of general worker i (-1: unpinned)
+    std::map<std::string, int> instance_cpus;  // FMU instance -> dedicated worker on this CPU
+
+    static ParallelOptions FromConfig(const DemoConfiguration& config, const std::string& root);
+};
+
+// Fixed worker pool that steps FMU instances in stages.
+// Every instance is bound to one worker for the whole run, so DoStep of an
+// instance always runs on the same worker. Its Get/SetVariable calls (the
+// exchange) run on the master thread, so there is no thread affinity.
+// Instances listed in instance_cpus get a worker of their own pinned to that
+// CPU; all others are distributed round-robin.
+// When disabled, RunStage() executes the tasks inline on the calling thread.
+class ParallelExecutor {
+public:
+    struct Task {
+        int worker;
+        std::function<void()> fn;
+    };
+
+    explicit ParallelExecutor(const ParallelOptions& options);
+    ~ParallelExecutor();
+
+    ParallelExecutor(const ParallelExecutor&) = delete;
+    ParallelExecutor& operator=(const ParallelExecutor&) = delete;
+
+    // Stable instance -> worker mapping for the member `slot` of a group stepped together
+    // (a schedule stage): members are spread evenly over the general workers, independent
+    // of other groups. Call once per instance before the loop.
+    int AssignWorker(const std::string& instanceName, int slot);
+
+    // Runs all tasks and returns when every one has finished.
+    // Exceptions thrown by a task are rethrown here.
+    void RunStage(const std::vector<Task>& tasks);
+
+    bool IsParallel() const { return m_numWorkers > 0; }
+    int GetWorkerCount() const { return m_numWorkers; }
+
+    BarrierStats GetStartStats() const;
+    BarrierStats GetEndStats() const;
+    void PrintStats() const;
+
+    static bool PinCurrentThread(int cpu);
+
+private:
+    void WorkerLoop(int index, int cpu);
+
+    ParallelOptions m_options;
+    int m_numWorkers = 0;
+    int m_numGeneral = 0;
+    std::map<std::string, int> m_dedicated;  // instance -> worker index
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::vector<const std::function<void()>*>> m_queues;
+    std::vector<std::exception_ptr> m_errors;
+    std::atomic<bool> m_stop{false};
+
+    std::unique_ptr<SpinBarrier> m_start;
+    std::unique_ptr<SpinBarrier> m_end;
+    uint64_t m_stages = 0;
+};
@@ -0,0 +1,93 @@
+#include "PowerBond.h"
+
+#include <algorithm>
+#include <cmath>
+
+PowerBond::PowerBond(const std::string& name, int dim, const Options& options)
+    : m_name(name), m_dim(dim), m_options(options),
+      m_prevEffort(dim, 0.0), m_prevSent(dim, 0.0), m_prevFlow(dim, 0.0) {}
+
+void PowerBond::Exchange(const double* effort, const double* flow, double step, double* effortOut) {
+    if (m_hasPrevious) {
+        // Effort side saw the held flow f_{k-1} while its effort went e_{k-1} -> e_k.
+        // Flow side saw the held effort s_{k-1} while its flow went f_{k-1} -> f_k.
+        double given = 0.0, received = 0.0;
+        for (int i = 0; i < m_dim; ++i) {
+            given += 0.5 * (m_prevEffort[i] + effort[i]) * m_prevFlow[i];
+            received += m_prevSent[i] * 0.5 * (m_prevFlow[i] + flow[i]);
+        }
+        double dE = (given - received) * m_prevStep;
+
+        // Energy injected by the previous correction is already part of "received",
+        // so the residual shrinks by exactly what was compensated.
+        double raw = 0.0;
+        for (int i = 0; i < m_dim; ++i) {
+            raw += (m_prevSent[i] - m_prevEffort[i]) * 0.5 * (m_prevFlow[i] + flow[i]);
+        }
+        m_total += dE + raw * m_prevStep;
+        m_residual += dE;
+        m_transferred += received * m_prevStep;
+    }
+
+    double ff = 0.0, ee = 0.0;
+    for (int i = 0; i < m_dim; ++i) {
+        ff += flow[i] * flow[i];
+        ee += effort[i] * effort[i];
+    }
+
+    for (int i = 0; i < m_dim; ++i) effortOut[i] = effort[i];
+
+    if (m_options.correct && step > 0.0 && ff > m_options.min_flow * m_options.min_flow) {
+        // delta_e = gain * R / (h |f|^2) * f  delivers gain * R over the next step
+        double scale = m_options.gain * m_residual / (step * ff);
+        double norm = std::fabs(scale) * std::sqrt(ff);
+        double limit = m_options.max_relative_correction * std::sqrt(ee);
+        if (norm > limit) scale *= (norm > 0.0 ? limit / norm : 0.0);
+        for (int i = 0; i < m_dim; ++i) effortOut[i] += scale * flow[i];
+    }
+
+    for (int i = 0; i < m_dim; ++i) {
+        m_prevEffort[i] = effort[i];
+        m_prevSent[i] = effortOut[i];
+        m_prevFlow[i] = flow[i];
+    }
+    m_prevStep = step;
+    m_hasPrevious = true;
+}
+
+void PowerBond::SaveState() {
+    Snapshot& s = m_saved;
+    s.hasPrevious = m_hasPrevious;
+    s.prevStep = m_prevStep;
+    s.prevEffort = m_prevEffort;
+    s.prevSent = m_prevSent;
+    s.prevFlow = m_prevFlow;
+    s.residual = m_residual;
+    s.total = m_total;
+    s.transferred = m_transferred;
+}
+
+void PowerBond::RestoreState() {
+    const Snapshot& s = m_saved;
+    m_hasPrevious = s.hasPrevious;
+    m_prevStep = s.prevStep;
+    m_prevEffort = s.prevEffort;
+    m_prevSent = s.prevSent;
+    m_prevFlow = s.prevFlow;
+    m_residual = s.residual;
+    m_total = s.total;
+    m_transferred = s.transferred;
+}
+
+std::unique_ptr<PowerBond> PowerBond::FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                 const std::string& pair, const std::string& name, int dim) {
+    std::string key = root + "." + pair;
+    if (config.Get(key).type != MiniJSON::Type::Object) return nullptr;
+
+    Options o;
+    o.correct = config.GetBool(key + ".correct", o.correct);
+    o.gain = config.GetDouble(key + ".gain", o.gain);
+    o.min_flow = config.GetDouble(key + ".min_flow", o.min_flow);
+    o.max_relative_correction = config.GetDouble(key + ".max_relative_correction", o.max_relative_correction);
+    return std::make_unique<PowerBond>(name, dim, o);
+}
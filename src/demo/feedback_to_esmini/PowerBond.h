@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+
+// Energy bookkeeping for one power-bond connection (effort/flow pair) between
+// two FMUs, e.g. driveshaft torque/speed or wheel force/linear velocity.
+//
+// With explicit co-simulation both sides hold the other side's signal constant
+// over a communication step, so the energy leaving the effort side and the
+// energy entering the flow side differ. That residual is accumulated here and,
+// when correction is enabled, fed back into the effort signal over the next
+// steps (NEPCE: nearly energy preserving coupling element).
+class PowerBond {
+public:
+    struct Options {
+        bool correct = false;                 // apply the correction (otherwise monitor only)
+        double gain = 0.5;                    // fraction of the residual removed per step
+        double min_flow = 1e-3;               // no correction below this |flow|
+        double max_relative_correction = 1.0; // |delta effort| <= ratio * |effort|
+    };
+
+    PowerBond(const std::string& name, int dim, const Options& options);
+
+    // Called at every exchange with the latest effort/flow outputs and the
+    // communication step that follows. Writes the effort to send to the flow side.
+    void Exchange(const double* effort, const double* flow, double step, double* effortOut);
+
+    const std::string& GetName() const { return m_name; }
+    double GetResidual() const { return m_residual; }      // not yet compensated [J]
+    double GetTotalResidual() const { return m_total; }    // raw residual since start [J]
+    double GetTransferred() const { return m_transferred; }// energy received by flow side [J]
+
+    // Snapshot of the bookkeeping and back, for rolling back a rejected macro
+    // step (StepRecovery) without counting its exchanges twice
+    void SaveState();
+    void RestoreState();
+
+    // Reads "<root>.<pair>" from demo_config.json; returns nullptr when the pair is not declared.
+    static std::unique_ptr<PowerBond> FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                 const std::string& pair, const std::string& name, int dim);
+
+private:
+    std::string m_name;
+    int m_dim;
+    Options m_options;
+
+    bool m_hasPrevious = false;
+    double m_prevStep = 0.0;
+    std::vector<double> m_prevEffort;  // effort output at the previous exchange
+    std::vector<double> m_prevSent;    // effort actually sent at the previous exchange
+    std::vector<double> m_prevFlow;    // flow sent at the previous exchange
+
+    double m_residual = 0.0;
+    double m_total = 0.0;
+    double m_transferred = 0.0;
+
+    struct Snapshot {
+        bool hasPrevious = false;
+        double prevStep = 0.0;
+        std::vector<double> prevEffort, prevSent, prevFlow;
+        double residual = 0.0, total = 0.0, transferred = 0.0;
+    };
+    Snapshot m_saved;
+};
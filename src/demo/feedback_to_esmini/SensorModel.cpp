@@ -0,0 +1,267 @@
+#include "SensorModel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Fractions of the angular extent sampled for occlusion, inset so that grazing boxes do not count
+constexpr double kEdgeInset = 0.9;
+// Occluders are tested in blocks of this many; the test stops after the first block that hides the object
+constexpr size_t kOccluderBlock = 16;
+
+double WrapAngle(double a) {
+    a = std::fmod(a + kPi, 2.0 * kPi);
+    if (a < 0.0) a += 2.0 * kPi;
+    return a - kPi;
+}
+
+void SetTimestamp(osi3::Timestamp* ts, double time) {
+    double seconds = std::floor(time);
+    ts->set_seconds(static_cast<int64_t>(seconds));
+    ts->set_nanos(std::min(999999999u, static_cast<uint32_t>((time - seconds) * 1e9)));
+}
+
+// Sensor frame coordinates, squared distance and a 1/0 visibility mask of n points. A
+// separate function so that the __restrict parameters let GCC drop its alias checks; the
+// mask is a double so that the loop stays at one element width and vectorizes.
+void TransformAndCull(size_t n, const double* __restrict x, const double* __restrict y,
+                      double sx, double sy, double cs, double ss, double cos2, double behind, double range2,
+                      double* __restrict lx, double* __restrict ly, double* __restrict dist2,
+                      double* __restrict visible) {
+    for (size_t i = 0; i < n; ++i) {
+        double dx = x[i] - sx, dy = y[i] - sy;
+        double u = cs * dx + ss * dy;
+        double v = -ss * dx + cs * dy;
+        double d2 = u * u + v * v;
+        double c2 = cos2 * d2;
+        double inFov = u >= 0.0 ? (behind > 0.0 || u * u >= c2 ? 1.0 : 0.0) : (u * u <= c2 ? behind : 0.0);
+        lx[i] = u;
+        ly[i] = v;
+        dist2[i] = d2;
+        visible[i] = d2 <= range2 ? inFov : 0.0;
+    }
+}
+
+}  // namespace
+
+SensorModel::Options SensorModel::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    auto list = config.Get(root);
+    if (list.type != MiniJSON::Type::Array) return o;
+
+    for (auto& entry : list.a_val) {
+        if (entry.type != MiniJSON::Type::Object) continue;
+        const auto& obj = entry.o_val;
+        auto number = [&obj](const std::string& key, double def) {
+            auto it = obj.find(key);
+            return (it != obj.end() && it->second.type == MiniJSON::Type::Number) ? it->second.n_val : def;
+        };
+
+        SensorOptions s;
+        auto name = obj.find("name");
+        if (name != obj.end()) s.name = name->second.as_string();
+        auto position = obj.find("position");
+        if (position != obj.end() && position->second.type == MiniJSON::Type::Array) {
+            for (size_t i = 0; i < 3 && i < position->second.a_val.size(); ++i) {
+                s.position[i] = position->second.a_val[i].as_double();
+            }
+        }
+        s.yaw = number("yaw_deg", 0.0) * kPi / 180.0;
+        s.fovDeg = number("fov_deg", s.fovDeg);
+        s.range = number("range", s.range);
+        auto occlusion = obj.find("occlusion");
+        if (occlusion != obj.end() && occlusion->second.type == MiniJSON::Type::Boolean) s.occlusion = occlusion->second.b_val;
+        o.sensors.push_back(s);
+    }
+    return o;
+}
+
+SensorModel::SensorModel(const Options& options, ParallelExecutor& executor) : m_executor(executor) {
+    // Sized once: the tasks and Data() point into m_sensors
+    m_sensors.resize(options.sensors.size());
+    for (size_t i = 0; i < options.sensors.size(); ++i) {
+        const SensorOptions& o = options.sensors[i];
+        if (o.name.empty()) throw std::runtime_error("Sensor " + std::to_string(i) + " has no name");
+        if (!(o.range > 0.0) || !(o.fovDeg > 0.0)) throw std::runtime_error("Sensor " + o.name + ": range and fov_deg must be positive");
+
+        Sensor& sensor = m_sensors[i];
+        sensor.options = o;
+        sensor.data.mutable_sensor_id()->set_value(i + 1);
+        auto* mount = sensor.data.mutable_mounting_position();
+        mount->mutable_position()->set_x(o.position[0]);
+        mount->mutable_position()->set_y(o.position[1]);
+        mount->mutable_position()->set_z(o.position[2]);
+        mount->mutable_orientation()->set_yaw(o.yaw);
+        m_data.push_back(&sensor.data);
+
+        m_tasks.push_back({executor.AssignWorker("sensor:" + o.name, static_cast<int>(i)), [this, i] { Detect(m_sensors[i]); }});
+        printf("[Sensor] %s: fov %.0f deg, range %.1f m, occlusion %s\n", o.name.c_str(), std::min(o.fovDeg, 360.0),
+               o.range, o.occlusion ? "on" : "off");
+    }
+}
+
+void SensorModel::Run(double time, const ObjectTable& objects, uint32_t egoRow, const ControllerEgoState& ego) {
+    auto start = std::chrono::steady_clock::now();
+    m_time = time;
+    m_objects = &objects;
+    m_egoRow = egoRow;
+    m_ego = ego;
+    ++m_cycle;
+    m_executor.RunStage(m_tasks);
+    ++m_runs;
+    m_totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SensorModel::Detect(Sensor& sensor) {
+    const ObjectTable& t = *m_objects;
+    const SensorOptions& o = sensor.options;
+    const size_t n = t.Size();
+    sensor.lx.resize(n);
+    sensor.ly.resize(n);
+    sensor.dist2.resize(n);
+    sensor.visible.resize(n);
+
+    // Sensor pose in the world
+    const double c = std::cos(m_ego.yaw), s = std::sin(m_ego.yaw);
+    const double sx = m_ego.pos[0] + c * o.position[0] - s * o.position[1];
+    const double sy = m_ego.pos[1] + s * o.position[0] + c * o.position[1];
+    const double sz = m_ego.pos[2] + o.position[2];
+    const double syaw = m_ego.yaw + o.yaw;
+    const double cs = std::cos(syaw), ss = std::sin(syaw);
+    // In the field of view when the bearing's cosine is at least cosHalf, tested on squares
+    // (u^2 against cosHalf^2 d^2) so that the pass needs no sqrt; -1 admits all directions
+    const double cosHalf = o.fovDeg >= 360.0 ? -1.0 : std::cos(0.5 * o.fovDeg * kPi / 180.0);
+    const double cos2 = cosHalf * cosHalf;
+    const double behind = cosHalf < 0.0 ? 1.0 : 0.0;  // more than 180 deg: a cone behind is visible too
+    const double range2 = o.range * o.range;
+
+    // Transform and visibility over all objects: one straight pass with selects instead of branches
+    TransformAndCull(n, t.x.data(), t.y.data(), sx, sy, cs, ss, cos2, behind, range2,
+                     sensor.lx.data(), sensor.ly.data(), sensor.dist2.data(), sensor.visible.data());
+    const double* lx = sensor.lx.data();
+    const double* ly = sensor.ly.data();
+    const double* dist2 = sensor.dist2.data();
+    double* visible = sensor.visible.data();
+    if (m_egoRow < n) visible[m_egoRow] = 0.0;
+
+    // Nearest first: only earlier candidates can occlude, and detections come out by range
+    sensor.candidates.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (visible[i] != 0.0) sensor.candidates.push_back(i);
+    }
+    std::sort(sensor.candidates.begin(), sensor.candidates.end(),
+              [dist2](uint32_t a, uint32_t b) { return dist2[a] < dist2[b]; });
+
+    // Angular extent of each candidate's bounding box around its line of sight
+    const size_t k = sensor.candidates.size();
+    sensor.range.resize(k);
+    sensor.azimuth.resize(k);
+    sensor.left.resize(k);
+    sensor.right.resize(k);
+    for (size_t j = 0; j < k; ++j) {
+        uint32_t i = sensor.candidates[j];
+        double az = std::atan2(ly[i], lx[i]);
+        double ca = std::cos(az), sa = std::sin(az);
+        double cy = std::cos(t.yaw[i] - syaw), sy2 = std::sin(t.yaw[i] - syaw);
+        double hl = 0.5 * t.length[i], hw = 0.5 * t.width[i];
+        double lo = 0.0, hi = 0.0;
+        for (double a : {hl, -hl}) {
+            for (double b : {hw, -hw}) {
+                double px = lx[i] + cy * a - sy2 * b, py = ly[i] + sy2 * a + cy * b;
+                double ang = std::atan2(-sa * px + ca * py, ca * px + sa * py);
+                lo = std::min(lo, ang), hi = std::max(hi, ang);
+            }
+        }
+        sensor.range[j] = std::sqrt(dist2[i]);
+        sensor.azimuth[j] = az;
+        sensor.left[j] = lo;
+        sensor.right[j] = hi;
+    }
+
+    osi3::SensorData& data = sensor.data;
+    SetTimestamp(data.mutable_timestamp(), m_time);
+    auto* host = data.mutable_host_vehicle_location();
+    host->mutable_position()->set_x(m_ego.pos[0]);
+    host->mutable_position()->set_y(m_ego.pos[1]);
+    host->mutable_position()->set_z(m_ego.pos[2]);
+    host->mutable_orientation()->set_yaw(m_ego.yaw);
+    host->mutable_velocity()->set_x(m_ego.posDt[0]);
+    host->mutable_velocity()->set_y(m_ego.posDt[1]);
+    host->mutable_velocity()->set_z(m_ego.posDt[2]);
+    auto* header = data.mutable_moving_object_header();
+    SetTimestamp(header->mutable_measurement_time(), m_time);
+    header->set_cycle_counter(m_cycle);
+    header->set_data_qualifier(osi3::DetectedEntityHeader::DATA_QUALIFIER_AVAILABLE);
+    data.clear_moving_object();  // keeps the allocated entries for add_moving_object()
+
+    const double* ranges = sensor.range.data();
+    const double* az = sensor.azimuth.data();
+    const double* left = sensor.left.data();
+    const double* right = sensor.right.data();
+    for (size_t j = 0; j < k; ++j) {
+        uint32_t i = sensor.candidates[j];
+        if (o.occlusion) {
+            // Left edge, center and right edge each behind some nearer box
+            const double samples[3] = {az[j] + kEdgeInset * left[j], az[j], az[j] + kEdgeInset * right[j]};
+            int covered[3] = {0, 0, 0};
+            for (size_t block = 0; block < j && !(covered[0] & covered[1] & covered[2]); block += kOccluderBlock) {
+                const size_t end = std::min(j, block + kOccluderBlock);
+                for (size_t a = block; a < end; ++a) {
+                    int nearer = ranges[a] < ranges[j];  // equal ranges do not occlude each other
+                    for (int q = 0; q < 3; ++q) {
+                        double r = samples[q] - az[a];
+                        r = r > kPi ? r - 2.0 * kPi : r;
+                        r = r < -kPi ? r + 2.0 * kPi : r;
+                        covered[q] |= nearer & (r >= left[a]) & (r <= right[a]);
+                    }
+                }
+            }
+            if (covered[0] & covered[1] & covered[2]) {
+                ++sensor.occluded;
+                continue;
+            }
+        }
+
+        osi3::DetectedMovingObject* det = data.add_moving_object();
+        auto* h = det->mutable_header();
+        h->mutable_tracking_id()->set_value(t.id[i]);
+        h->add_ground_truth_id()->set_value(t.id[i]);
+        h->set_existence_probability(1.0);
+        h->set_measurement_state(osi3::DetectedItemHeader::MEASUREMENT_STATE_MEASURED);
+
+        auto* base = det->mutable_base();
+        base->mutable_position()->set_x(lx[i]);
+        base->mutable_position()->set_y(ly[i]);
+        base->mutable_position()->set_z(t.z[i] - sz);
+        base->mutable_orientation()->set_roll(t.roll[i]);
+        base->mutable_orientation()->set_pitch(t.pitch[i]);
+        base->mutable_orientation()->set_yaw(WrapAngle(t.yaw[i] - syaw));
+        base->mutable_dimension()->set_length(t.length[i]);
+        base->mutable_dimension()->set_width(t.width[i]);
+        base->mutable_dimension()->set_height(t.height[i]);
+        double rvx = t.vx[i] - m_ego.posDt[0], rvy = t.vy[i] - m_ego.posDt[1];
+        base->mutable_velocity()->set_x(cs * rvx + ss * rvy);
+        base->mutable_velocity()->set_y(-ss * rvx + cs * rvy);
+        base->mutable_velocity()->set_z(t.vz[i] - m_ego.posDt[2]);
+
+        auto* candidate = det->add_candidate();
+        candidate->set_probability(1.0);
+        candidate->set_type(static_cast<osi3::MovingObject::Type>(t.type[i]));
+        ++sensor.detections;
+    }
+}
+
+void SensorModel::PrintStats() const {
+    if (!m_runs) return;
+    printf("[Sensor] %llu runs, mean %.1f us for %zu sensors\n", static_cast<unsigned long long>(m_runs),
+           m_totalUs / m_runs, m_sensors.size());
+    for (const auto& sensor : m_sensors) {
+        printf("[Sensor] %s: %.1f detections, %.1f occluded per run\n", sensor.options.name.c_str(),
+               static_cast<double>(sensor.detections) / m_runs, static_cast<double>(sensor.occluded) / m_runs);
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+#include "NativeController.h"
+#include "ObjectTable.h"
+#include "ParallelExecutor.h"
+#include "osi_sensordata.pb.h"
+
+// Idealized sensors between esmini's ground truth and the native controller.
+//
+// Each sensor is mounted on the vehicle model (position and yaw in the vehicle
+// frame) and detects the moving objects of the step's ObjectTable that lie in
+// its horizontal field of view and range and are not hidden behind nearer
+// objects. Occlusion is tested on the objects' bounding boxes: an object is
+// hidden when its left edge, center and right edge (as seen from the sensor)
+// are each covered by a nearer box. Detections are perfect otherwise: one
+// DetectedMovingObject per visible object, nearest first, with its ground
+// truth id, pose, dimension and velocity relative to the sensor, in the sensor frame.
+//
+// The transform and the field of view / range test are one straight pass over
+// the table's columns with selects instead of branches and without sqrt, which
+// the compiler vectorizes (like NativeTerrain::Query); distances are taken only
+// for the candidates. Occlusion tests each candidate
+// against the nearer ones in fixed-size blocks of the same kind, stopping at
+// the first block that hides it. Each sensor is one task on the worker pool,
+// so several sensors run in parallel.
+class SensorModel {
+public:
+    struct SensorOptions {
+        std::string name;
+        double position[3] = {0.0, 0.0, 0.0};  // [m] mounting in the vehicle frame
+        double yaw = 0.0;                      // [rad] mounting
+        double fovDeg = 360.0;                 // full horizontal opening angle; >= 360 = all around
+        double range = 100.0;                  // [m]
+        bool occlusion = true;
+    };
+
+    struct Options {
+        std::vector<SensorOptions> sensors;
+
+        // "<root>": list of {name, position [x, y, z], yaw_deg, fov_deg, range, occlusion}
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    // Throws std::runtime_error on a sensor without a name or with a non-positive range / fov
+    SensorModel(const Options& options, ParallelExecutor& executor);
+
+    SensorModel(const SensorModel&) = delete;
+    SensorModel& operator=(const SensorModel&) = delete;
+
+    bool IsEnabled() const { return !m_sensors.empty(); }
+
+    // Runs every sensor on the table from the vehicle pose; `egoRow` (the ego's
+    // own entry, may be ObjectTable::kNoRow) is never detected
+    void Run(double time, const ObjectTable& objects, uint32_t egoRow, const ControllerEgoState& ego);
+    // One message per sensor, in configuration order; rewritten by the next Run()
+    const std::vector<const osi3::SensorData*>& Data() const { return m_data; }
+
+    void PrintStats() const;
+
+private:
+    struct Sensor {
+        SensorOptions options;
+        osi3::SensorData data;  // cleared and refilled; repeated fields keep their objects
+
+        // Per-object scratch, reused across steps
+        std::vector<double> lx, ly, dist2, visible;
+        std::vector<uint32_t> candidates;
+        // Per candidate: distance, line of sight and the box's angular extent around it [rad]
+        std::vector<double> range, azimuth, left, right;
+
+        uint64_t detections = 0, occluded = 0;
+    };
+
+    void Detect(Sensor& sensor);
+
+    ParallelExecutor& m_executor;
+    std::vector<Sensor> m_sensors;
+    std::vector<const osi3::SensorData*> m_data;
+    std::vector<ParallelExecutor::Task> m_tasks;
+
+    // Inputs of the current Run(), read by the tasks
+    double m_time = 0.0;
+    const ObjectTable* m_objects = nullptr;
+    uint32_t m_egoRow = ObjectTable::kNoRow;
+    ControllerEgoState m_ego;
+
+    uint64_t m_runs = 0, m_cycle = 0;
+    double m_totalUs = 0.0;
+};
@@ -0,0 +1,216 @@
+#include "SensorViewPruner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#include "osi_groundtruth.pb.h"
+
+namespace {
+
+constexpr uint32_t kSensorViewGlobalGroundTruth = 7;
+constexpr double kPi = 3.14159265358979323846;
+
+// Where the position (Vector3d) of each filterable GroundTruth object sits, as field numbers
+struct ObjectPosition {
+    uint32_t field;
+    uint32_t path[3];
+    int depth;
+};
+constexpr ObjectPosition kObjectPositions[] = {
+    {4, {2, 2, 0}, 2},  // stationary_object.base.position
+    {5, {2, 2, 0}, 2},  // moving_object.base.position
+    {6, {2, 1, 2}, 3},  // traffic_sign.main_sign.base.position
+    {7, {2, 2, 0}, 2},  // traffic_light.base.position
+};
+
+const ObjectPosition* FindObjectPosition(uint32_t field) {
+    for (const auto& p : kObjectPositions) {
+        if (p.field == field) return &p;
+    }
+    return nullptr;
+}
+
+// Finds the submessage at path[0..depth) and reads x / y of the Vector3d there
+bool ReadPosition(WireReader msg, const uint32_t* path, int depth, double& x, double& y) {
+    if (depth == 0) {
+        bool hasX = false, hasY = false;
+        while (msg.Next()) {
+            if (msg.Type() != WireReader::kFixed64) continue;
+            if (msg.Field() == 1) x = msg.Double(), hasX = true;
+            if (msg.Field() == 2) y = msg.Double(), hasY = true;
+        }
+        return hasX || hasY;
+    }
+    while (msg.Next()) {
+        if (msg.Field() == path[0] && msg.Type() == WireReader::kLength) {
+            return ReadPosition(msg.Message(), path + 1, depth - 1, x, y);
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+SensorViewPruner::Options SensorViewPruner::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.enabled = config.GetBool(root + ".enabled", o.enabled);
+    o.range = config.GetDouble(root + ".range", o.range);
+    o.fovDeg = config.GetDouble(root + ".fov_deg", o.fovDeg);
+    o.bufferDepth = static_cast<size_t>(config.GetDouble(root + ".buffer_depth", static_cast<double>(o.bufferDepth)));
+    auto drop = config.Get(root + ".drop");
+    if (drop.type == MiniJSON::Type::Array) {
+        for (auto& v : drop.a_val) o.drop.push_back(v.as_string());
+    }
+    return o;
+}
+
+const SensorViewPruner::Node* SensorViewPruner::Node::Find(uint32_t f) const {
+    for (const auto& c : children) {
+        if (c.field == f) return &c;
+    }
+    return nullptr;
+}
+
+SensorViewPruner::SensorViewPruner(const Options& options)
+    : m_options(options), m_buffers("DriveController SensorView", options.bufferDepth) {
+    size_t maxDepth = 0;
+    for (const auto& path : m_options.drop) {
+        const google::protobuf::Descriptor* type = osi3::GroundTruth::descriptor();
+        Node* node = &m_projection;
+        std::stringstream ss(path);
+        std::string name;
+        size_t depth = 0;
+        while (std::getline(ss, name, '.')) {
+            if (!type) throw std::runtime_error("Pruning path '" + path + "': '" + name + "' is below a scalar field");
+            const google::protobuf::FieldDescriptor* field = type->FindFieldByName(name);
+            if (!field) throw std::runtime_error("Pruning path '" + path + "': " + type->full_name() + " has no field '" + name + "'");
+
+            uint32_t number = static_cast<uint32_t>(field->number());
+            auto it = std::find_if(node->children.begin(), node->children.end(),
+                                   [&](const Node& c) { return c.field == number; });
+            if (it == node->children.end()) {
+                node->children.push_back(Node{number, false, {}});
+                it = node->children.end() - 1;
+            }
+            node = &*it;
+            type = field->message_type();
+            ++depth;
+        }
+        if (depth == 0) throw std::runtime_error("Empty pruning path");
+        node->drop = true;
+        maxDepth = std::max(maxDepth, depth);
+    }
+    m_scratch.resize(maxDepth + 2);
+
+    if (m_options.enabled) {
+        printf("[Prune] DriveController SensorView: range %.1f m (0 = unlimited), fov %.0f deg, %zu dropped paths\n",
+               m_options.range, m_options.fovDeg > 0.0 && m_options.fovDeg < 360.0 ? m_options.fovDeg : 360.0,
+               m_options.drop.size());
+    }
+}
+
+bool SensorViewPruner::KeepObject(uint32_t field, WireReader record) const {
+    if (!m_hasEgo) return true;
+    const ObjectPosition* where = FindObjectPosition(field);
+    double x = 0.0, y = 0.0;
+    if (!where || !ReadPosition(record, where->path, where->depth, x, y)) return true;
+
+    double dx = x - m_egoPos[0], dy = y - m_egoPos[1];
+    if (m_options.range > 0.0 && dx * dx + dy * dy > m_options.range * m_options.range) return false;
+    if (m_options.fovDeg > 0.0 && m_options.fovDeg < 360.0 && (dx != 0.0 || dy != 0.0)) {
+        double c = std::cos(m_egoYaw), s = std::sin(m_egoYaw);
+        double bearing = std::atan2(-s * dx + c * dy, c * dx + s * dy);
+        if (std::abs(bearing) > 0.5 * m_options.fovDeg * kPi / 180.0) return false;
+    }
+    return true;
+}
+
+void SensorViewPruner::RewriteGroundTruth(WireReader gt, std::string& out) {
+    while (gt.Next()) {
+        if (gt.Type() == WireReader::kLength && !KeepObject(gt.Field(), gt.Message())) {
+            ++m_objectsDropped;
+            continue;
+        }
+        const Node* child = m_projection.Find(gt.Field());
+        if (!child) {
+            out.append(reinterpret_cast<const char*>(gt.Record()), gt.RecordSize());
+        } else if (!child->drop && gt.Type() == WireReader::kLength) {
+            std::string& sub = m_scratch[1];
+            sub.clear();
+            Rewrite(gt.Message(), *child, 2, sub);
+            AppendTag(out, gt.Field(), WireReader::kLength);
+            AppendVarint(out, sub.size());
+            out += sub;
+        }
+    }
+}
+
+void SensorViewPruner::Rewrite(WireReader msg, const Node& node, size_t depth, std::string& out) {
+    while (msg.Next()) {
+        const Node* child = node.Find(msg.Field());
+        if (!child) {
+            out.append(reinterpret_cast<const char*>(msg.Record()), msg.RecordSize());
+        } else if (!child->drop && msg.Type() == WireReader::kLength) {
+            std::string& sub = m_scratch[depth];
+            sub.clear();
+            Rewrite(msg.Message(), *child, depth + 1, sub);
+            AppendTag(out, msg.Field(), WireReader::kLength);
+            AppendVarint(out, sub.size());
+            out += sub;
+        }
+    }
+}
+
+OsmpPointer SensorViewPruner::Prune(const void* data, size_t size) {
+    auto start = std::chrono::steady_clock::now();
+    OsmpBuffer& buffer = m_buffers.Acquire();
+    std::string& out = buffer.data;
+    out.clear();
+    buffer.contentId = 0;
+
+    m_hasEgo = false;
+    if (ScanSensorView(data, size, m_scan)) {
+        m_objects.Build(m_scan);
+        uint32_t ego = m_objects.EgoRow();
+        if (ego != ObjectTable::kNoRow) {
+            m_hasEgo = true;
+            m_egoPos[0] = m_objects.x[ego];
+            m_egoPos[1] = m_objects.y[ego];
+            m_egoYaw = m_objects.yaw[ego];
+        }
+
+        WireReader view(data, size);
+        while (view.Next()) {
+            if (view.Field() != kSensorViewGlobalGroundTruth || view.Type() != WireReader::kLength) {
+                out.append(reinterpret_cast<const char*>(view.Record()), view.RecordSize());
+                continue;
+            }
+            std::string& gt = m_scratch[0];
+            gt.clear();
+            RewriteGroundTruth(view.Message(), gt);
+            AppendTag(out, kSensorViewGlobalGroundTruth, WireReader::kLength);
+            AppendVarint(out, gt.size());
+            out += gt;
+        }
+    } else {
+        // Not ours to judge: the controller gets what esmini sent
+        out.assign(static_cast<const char*>(data), size);
+    }
+
+    ++m_frames;
+    m_bytesIn += size;
+    m_bytesOut += out.size();
+    m_totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return m_buffers.Publish();
+}
+
+void SensorViewPruner::PrintStats() const {
+    if (!m_frames) return;
+    printf("[Prune] %llu frames, %.1f -> %.1f KiB per frame, %.1f objects dropped per frame, mean %.1f us\n",
+           static_cast<unsigned long long>(m_frames), m_bytesIn / 1024.0 / m_frames, m_bytesOut / 1024.0 / m_frames,
+           static_cast<double>(m_objectsDropped) / m_frames, m_totalUs / m_frames);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+#include "ObjectTable.h"
+#include "OsiWireScanner.h"
+#include "OsmpBuffers.h"
+
+// Shrinks esmini's SensorView before it goes to the DriveController FMU.
+//
+// Works on the encoded message like the other OSI stages: ground truth objects
+// (moving / stationary objects, traffic signs and lights) outside a range or
+// field of view around the ego are dropped, and so is every field on a declared
+// projection of drop paths ("lane_boundary", "lane.classification.centerline",
+// "traffic_sign.supplementary_sign", ...; field names of osi3::GroundTruth,
+// resolved through the protobuf descriptors at startup). Everything else is
+// copied verbatim. The result is written into a buffer of an OsmpBufferRing,
+// so the controller can still be reading the previous step's view.
+class SensorViewPruner {
+public:
+    struct Options {
+        bool enabled = false;
+        double range = 0.0;   // [m] around the ego; 0 = unlimited
+        double fovDeg = 0.0;  // full opening angle centered on the ego heading; 0 or >= 360 = all around
+        std::vector<std::string> drop;
+        size_t bufferDepth = 2;
+
+        // "drivecontroller.pruning": enabled, range, fov_deg, drop [paths], buffer_depth
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    // Throws std::runtime_error on a drop path that is not a GroundTruth field path
+    explicit SensorViewPruner(const Options& options);
+
+    bool IsEnabled() const { return m_options.enabled; }
+
+    // Pruned copy of the encoded view, published from the buffer ring. Malformed
+    // input is passed through unchanged.
+    OsmpPointer Prune(const void* data, size_t size);
+    // The controller's DoStep has returned; its input buffers may be reused
+    void Release() { m_buffers.Release(); }
+
+    void PrintStats() const;
+
+private:
+    // Projection trie over field numbers, rooted at osi3::GroundTruth
+    struct Node {
+        uint32_t field = 0;
+        bool drop = false;
+        std::vector<Node> children;
+        const Node* Find(uint32_t f) const;
+    };
+
+    bool KeepObject(uint32_t field, WireReader record) const;
+    void RewriteGroundTruth(WireReader gt, std::string& out);
+    void Rewrite(WireReader msg, const Node& node, size_t depth, std::string& out);
+
+    Options m_options;
+    Node m_projection;
+    std::vector<std::string> m_scratch;  // one per nesting level, reused
+    OsmpBufferRing m_buffers;
+    SensorViewScan m_scan;
+    ObjectTable m_objects;
+
+    bool m_hasEgo = false;
+    double m_egoPos[2] = {0, 0}, m_egoYaw = 0.0;
+
+    uint64_t m_frames = 0, m_bytesIn = 0, m_bytesOut = 0, m_objectsDropped = 0;
+    double m_totalUs = 0.0;
+};
@@ -0,0 +1,492 @@
+#include "SingleTrackVehicle.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const double kGravity = 9.81;
+const double kMinSlipSpeed = 0.5;  // longitudinal speed floor in the slip angles [m/s]
+const double kBlendBegin = 1.0;    // below this speed [m/s]: kinematic bicycle only
+const double kBlendEnd = 3.0;      // above this speed [m/s]: dynamic single track only
+
+double Interpolate(const std::vector<double>& xs, const std::vector<double>& ys, double x) {
+    if (x <= xs.front()) return ys.front();
+    if (x >= xs.back()) return ys.back();
+    size_t i = std::upper_bound(xs.begin(), xs.end(), x) - xs.begin();
+    double u = (x - xs[i - 1]) / (xs[i] - xs[i - 1]);
+    return ys[i - 1] + u * (ys[i] - ys[i - 1]);
+}
+
+double SmoothStep(double x, double x0, double x1) {
+    double u = std::min(std::max((x - x0) / (x1 - x0), 0.0), 1.0);
+    return u * u * (3.0 - 2.0 * u);
+}
+
+// Force of one axle in its wheel frame within the friction ellipse (gx, gy).
+// `demand` is the longitudinal force from drive and brakes, (vx, vy) the axle's ground velocity in the
+// wheel frame and w the fade-in of the lateral force. While the demand is within grip, the lateral force
+// saturates in the slip angle and both are scaled back onto the ellipse if combined they exceed it.
+// A demand beyond grip locks (braking) or spins (drive) the wheels: the tires slide, and the full friction
+// force acts against the slip velocity, so a sliding tire still resists sideways motion.
+void AxleForce(double demand, double vx, double vy, double cornering, double gx, double gy, double w,
+               double& fx, double& fy) {
+    fx = fy = 0.0;
+    if (!(gx > 1e-6 && gy > 1e-6)) return;  // axle off the ground
+    double v = std::max(vx, kMinSlipSpeed);
+    if (std::fabs(demand) <= gx) {
+        fx = demand;
+        fy = -w * gy * std::tanh(cornering * std::atan2(vy, v) / gy);
+        double u = std::hypot(fx / gx, fy / gy);
+        if (u > 1.0) fx /= u, fy /= u;
+        return;
+    }
+    // Slip velocity of the contact patch: a locked wheel slides with the ground velocity,
+    // a spinning one (slip speed unknown) is taken to slip as fast as it rolls
+    double sx = demand < 0.0 ? v : -v, sy = vy;
+    double s = std::hypot(sx, sy);
+    double dx = -sx / s, dy = -sy / s;
+    double k = 1.0 / std::hypot(dx / gx, dy / gy);
+    fx = k * dx;
+    fy = k * dy;
+}
+
+DemoConfiguration LoadJson(const std::string& path) {
+    DemoConfiguration json;
+    if (!json.Load(path)) throw std::runtime_error("Vehicle: cannot read " + path);
+    return json;
+}
+
+double Number(const MiniJSON::Value& object, const std::string& key, double def) {
+    auto it = object.o_val.find(key);
+    return it != object.o_val.end() && it->second.type == MiniJSON::Type::Number ? it->second.n_val : def;
+}
+
+std::string String(const MiniJSON::Value& object, const std::string& key) {
+    auto it = object.o_val.find(key);
+    return it != object.o_val.end() && it->second.type == MiniJSON::Type::String ? it->second.s_val : "";
+}
+
+// Sum of every "Mass" entry, i.e. all bodies of one side of a suspension
+double SumMasses(const MiniJSON::Value& v) {
+    double sum = 0.0;
+    for (auto& [key, child] : v.o_val) {
+        if (key == "Mass" && child.type == MiniJSON::Type::Number) sum += child.n_val;
+        else sum += SumMasses(child);
+    }
+    for (auto& child : v.a_val) sum += SumMasses(child);
+    return sum;
+}
+
+// [[x, y], ...] -> xs, ys
+void ReadMap(const MiniJSON::Value& v, const std::string& what, std::vector<double>& xs, std::vector<double>& ys) {
+    for (auto& point : v.a_val) {
+        if (point.a_val.size() != 2) throw std::runtime_error("Vehicle: malformed " + what);
+        xs.push_back(point.a_val[0].n_val);
+        ys.push_back(point.a_val[1].n_val);
+    }
+    if (xs.empty()) throw std::runtime_error("Vehicle: missing " + what);
+}
+
+}  // namespace
+
+SingleTrackVehicle::SingleTrackVehicle(const std::string& name, const Parameters& par, double maxStep)
+    : m_name(name), m_par(par), m_maxStep(maxStep) {
+    m_inputs["throttle"] = &m_throttle;
+    m_inputs["braking"] = &m_braking;
+    m_inputs["steering"] = &m_steering;
+
+    static const char* axes[3] = {"x", "y", "z"};
+    for (int k = 0; k < 3; ++k) {
+        m_outputs[std::string("ref_frame.pos.") + axes[k]] = &m_pos[k];
+        m_outputs[std::string("ref_frame.pos_dt.") + axes[k]] = &m_posDt[k];
+    }
+    for (int k = 0; k < 4; ++k) m_outputs["ref_frame.rot.e" + std::to_string(k)] = &m_rot[k];
+    UpdateOutputs();
+}
+
+void SingleTrackVehicle::SetState(const double* pos, double yaw, const double* posDt, double yawRate) {
+    double c = std::cos(yaw), s = std::sin(yaw);
+    double dx = c * m_par.cgX - s * m_par.cgY, dy = s * m_par.cgX + c * m_par.cgY;
+    m_x = pos[0] + dx;
+    m_y = pos[1] + dy;
+    m_z = pos[2];
+    m_yaw = yaw;
+    m_r = yawRate;
+
+    // Velocity of the CG in the body frame
+    double vx = posDt[0] - yawRate * dy, vy = posDt[1] + yawRate * dx;
+    m_vx = std::max(c * vx + s * vy, 0.0);
+    m_vy = -s * vx + c * vy;
+    m_ax = 0.0;
+
+    // Keep the gear while it is inside its shift band (the transmission state is not observable),
+    // otherwise take the lowest gear that does not have to shift up at this speed
+    double shaft = m_vx / m_par.wheelRadius / m_par.finalRatio;
+    auto rpm = [&](int gear) { return shaft / m_par.gears[gear] * 30.0 / kPi; };
+    if (rpm(m_gear) < m_par.shiftDown[m_gear] || rpm(m_gear) > m_par.shiftUp[m_gear]) {
+        m_gear = 0;
+        while (m_gear + 1 < (int)m_par.gears.size() && rpm(m_gear) > m_par.shiftUp[m_gear]) ++m_gear;
+    }
+    UpdateOutputs();
+}
+
+void SingleTrackVehicle::SetInputs(double throttle, double braking, double steering) {
+    m_throttle = throttle;
+    m_braking = braking;
+    m_steering = steering;
+}
+
+double* SingleTrackVehicle::GetInput(const std::string& name) {
+    auto it = m_inputs.find(name);
+    return it != m_inputs.end() ? it->second : nullptr;
+}
+
+const double* SingleTrackVehicle::GetOutput(const std::string& name) {
+    auto it = m_outputs.find(name);
+    return it != m_outputs.end() ? it->second : nullptr;
+}
+
+fmi2_status_t SingleTrackVehicle::DoStep(double /*time*/, double step) {
+    int n = std::max(1, (int)std::ceil(step / m_maxStep - 1e-9));
+    for (int i = 0; i < n; ++i) Integrate(step / n);
+    UpdateOutputs();
+    return fmi2_status_ok;
+}
+
+double SingleTrackVehicle::EngineTorque(double rpm) const {
+    double full = Interpolate(m_par.fullSpeed, m_par.fullTorque, rpm);
+    double zero = Interpolate(m_par.zeroSpeed, m_par.zeroTorque, rpm);
+    return zero + std::min(std::max(m_throttle, 0.0), 1.0) * (full - zero);
+}
+
+void SingleTrackVehicle::Integrate(double h) {
+    const Parameters& p = m_par;
+    const NativeTire::Parameters& tire = p.tire;
+    double a = p.cgToFront, b = p.cgToRear, length = a + b;
+    double delta = std::min(std::max(m_steering, -1.0), 1.0) * p.maxSteer;
+    double cd = std::cos(delta), sd = std::sin(delta);
+
+    // Axle loads with longitudinal load transfer, tire characteristics at the wheel load (two wheels per axle)
+    double transfer = p.mass * m_ax * p.cgHeight / length;
+    double fzf = std::max(p.mass * kGravity * b / length - transfer, 0.0);
+    double fzr = std::max(p.mass * kGravity * a / length + transfer, 0.0);
+    double qf = std::min(0.5 * fzf, tire.pnMax) / tire.pn, qr = std::min(0.5 * fzr, tire.pnMax) / tire.pn;
+    double cf = 2.0 * NativeTire::LoadScaled(tire.dfy0, qf), cr = 2.0 * NativeTire::LoadScaled(tire.dfy0, qr);
+    double gripXf = 2.0 * NativeTire::LoadScaled(tire.fxm, qf), gripXr = 2.0 * NativeTire::LoadScaled(tire.fxm, qr);
+    double gripYf = 2.0 * NativeTire::LoadScaled(tire.fym, qf), gripYr = 2.0 * NativeTire::LoadScaled(tire.fym, qr);
+
+    // Powertrain: engine speed from the wheel speed, automatic shifting, torque at the wheels
+    double shaft = m_vx / p.wheelRadius / p.finalRatio;
+    double rpm = shaft / p.gears[m_gear] * 30.0 / kPi;
+    if (m_gear + 1 < (int)p.gears.size() && rpm > p.shiftUp[m_gear]) ++m_gear;
+    else if (m_gear > 0 && rpm < p.shiftDown[m_gear]) --m_gear;
+    rpm = shaft / p.gears[m_gear] * 30.0 / kPi;
+    double drive = EngineTorque(rpm) / (p.gears[m_gear] * p.finalRatio) / p.wheelRadius;
+
+    // Brakes and rolling resistance oppose forward motion (no reverse)
+    double braking = std::min(std::max(m_braking, 0.0), 1.0);
+    double resistF = braking * p.brakeTorqueFront / p.wheelRadius + p.rollingResistance * fzf;
+    double resistR = braking * p.brakeTorqueRear / p.wheelRadius + p.rollingResistance * fzr;
+
+    // Axle velocities in the wheel frames; slip angles are meaningless near standstill,
+    // where the kinematic bicycle takes over, so the lateral forces fade in with the speed
+    double speed = std::hypot(m_vx, m_vy);
+    double w = SmoothStep(speed, kBlendBegin, kBlendEnd);
+    double vyF = m_vy + a * m_r, vyR = m_vy - b * m_r;
+    double fxf, fyf, fxr, fyr;
+    AxleForce(p.frontDriveShare * drive - resistF, cd * m_vx + sd * vyF, -sd * m_vx + cd * vyF, cf, gripXf, gripYf, w, fxf, fyf);
+    AxleForce((1.0 - p.frontDriveShare) * drive - resistR, m_vx, vyR, cr, gripXr, gripYr, w, fxr, fyr);
+
+    // Newton-Euler in the body frame, semi-implicit Euler
+    double fx = fxf * cd - fyf * sd + fxr;
+    double fy = fxf * sd + fyf * cd + fyr;
+    double mz = a * (fxf * sd + fyf * cd) - b * fyr;
+    m_ax = fx / p.mass;
+    double vx = std::max(m_vx + h * (m_ax + m_vy * m_r), 0.0);
+    double vy = m_vy + h * (fy / p.mass - m_vx * m_r);
+    double r = m_r + h * mz / p.yawInertia;
+
+    // Kinematic bicycle at low speed, keyed on the speed rather than its body x part: the yaw rate follows
+    // the steering and the sideslip relaxes to the kinematic one, while the speed and the sense of travel
+    // are kept (a car sliding sideways is not stopped by the blend)
+    speed = std::hypot(vx, vy);
+    w = SmoothStep(speed, kBlendBegin, kBlendEnd);
+    double betaKin = std::atan(b * std::tan(delta) / length);
+    double beta = w * std::atan2(vy, vx) + (1.0 - w) * betaKin;
+    double rKin = speed * std::cos(betaKin) * std::tan(delta) / length;
+    m_vx = w < 1.0 ? speed * std::cos(beta) : vx;
+    m_vy = w < 1.0 ? speed * std::sin(beta) : vy;
+    m_r = w * r + (1.0 - w) * rKin;
+
+    double c = std::cos(m_yaw), s = std::sin(m_yaw);
+    m_x += h * (c * m_vx - s * m_vy);
+    m_y += h * (s * m_vx + c * m_vy);
+    m_yaw = std::remainder(m_yaw + h * m_r, 2.0 * kPi);
+}
+
+void SingleTrackVehicle::UpdateOutputs() {
+    double c = std::cos(m_yaw), s = std::sin(m_yaw);
+    double dx = c * m_par.cgX - s * m_par.cgY, dy = s * m_par.cgX + c * m_par.cgY;  // reference frame -> CG
+    m_pos[0] = m_x - dx;
+    m_pos[1] = m_y - dy;
+    m_pos[2] = m_z;
+    m_posDt[0] = c * m_vx - s * m_vy + m_r * dy;
+    m_posDt[1] = s * m_vx + c * m_vy - m_r * dx;
+    m_posDt[2] = 0.0;
+    m_rot[0] = std::cos(0.5 * m_yaw);
+    m_rot[1] = 0.0;
+    m_rot[2] = 0.0;
+    m_rot[3] = std::sin(0.5 * m_yaw);
+}
+
+// -----------------------------------------------------------------------------
+// Fit from the Chrono JSON files
+// -----------------------------------------------------------------------------
+
+std::unique_ptr<SingleTrackVehicle> SingleTrackVehicle::FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                                   const std::string& name) {
+    namespace fs = std::filesystem;
+    std::string dataPath = config.GetString(root + ".parameters.data_path", "");
+    auto data = [&](const std::string& rel) { return (fs::path(dataPath) / rel).string(); };
+
+    DemoConfiguration vehicle = LoadJson(config.GetString(root + ".parameters.vehicle_JSON", ""));
+    if (vehicle.GetString("Template", "") != "WheeledVehicle") throw std::runtime_error("Vehicle: vehicle_JSON is not a WheeledVehicle");
+
+    Parameters par;
+    NativeTire tire(name + "_tire", 0);
+    tire.LoadJson(config.GetString("tire.parameters.tire_JSON", ""));
+    par.tire = tire.GetParameters();
+
+    // Chassis bodies
+    DemoConfiguration chassis = LoadJson(data(vehicle.GetString("Chassis.Input File", "")));
+    double mass = 0.0, mx = 0.0, my = 0.0, mzSum = 0.0, izz = 0.0;
+    struct Body { double m, x, y, z; };
+    std::vector<Body> bodies;
+    auto components = chassis.Get("Components").a_val;
+    for (auto& c : components) {
+        auto frame = c.o_val.count("Centroidal Frame") ? c.o_val.at("Centroidal Frame") : MiniJSON::Value();
+        auto loc = frame.o_val.count("Location") ? frame.o_val.at("Location").a_val : MiniJSON::Array();
+        auto inertia = c.o_val.count("Moments of Inertia") ? c.o_val.at("Moments of Inertia").a_val : MiniJSON::Array();
+        if (loc.size() != 3) throw std::runtime_error("Vehicle: chassis component without a Centroidal Frame location");
+        bodies.push_back({Number(c, "Mass", 0.0), loc[0].n_val, loc[1].n_val, loc[2].n_val});
+        if (inertia.size() == 3) izz += inertia[2].n_val;
+    }
+    if (bodies.empty()) throw std::runtime_error("Vehicle: chassis has no Components");
+
+    // Axles: suspension, wheels and tires as unsprung mass at the axle; steered axles form the front axle
+    double frontX = 0.0, rearX = 0.0, unsprungFront = 0.0, unsprungRear = 0.0;
+    int frontAxles = 0, rearAxles = 0;
+    std::vector<bool> steered;
+    auto axles = vehicle.Get("Axles").a_val;
+    for (auto& axle : axles) {
+        auto loc = axle.o_val.count("Suspension Location") ? axle.o_val.at("Suspension Location").a_val : MiniJSON::Array();
+        if (loc.size() != 3) throw std::runtime_error("Vehicle: axle without Suspension Location");
+        double side = SumMasses(LoadJson(data(String(axle, "Suspension Input File"))).root) +
+                      LoadJson(data(String(axle, "Left Wheel Input File"))).GetDouble("Mass", 0.0) + par.tire.mass;
+        double brake = 0.0;
+        for (auto key : {"Left Brake Input File", "Right Brake Input File"}) {
+            if (!String(axle, key).empty()) brake += LoadJson(data(String(axle, key))).GetDouble("Maximum Torque", 0.0);
+        }
+        bool isSteered = axle.o_val.count("Steering Index") > 0;
+        steered.push_back(isSteered);
+        (isSteered ? frontX : rearX) += loc[0].n_val;
+        (isSteered ? unsprungFront : unsprungRear) += 2.0 * side;
+        (isSteered ? par.brakeTorqueFront : par.brakeTorqueRear) += brake;
+        (isSteered ? frontAxles : rearAxles)++;
+        bodies.push_back({2.0 * side, loc[0].n_val, 0.0, 0.0});
+    }
+    if (frontAxles == 0 || rearAxles == 0) throw std::runtime_error("Vehicle: need at least one steered and one unsteered axle");
+    frontX /= frontAxles;
+    rearX /= rearAxles;
+
+    for (auto& body : bodies) {
+        mass += body.m;
+        mx += body.m * body.x;
+        my += body.m * body.y;
+        mzSum += body.m * body.z;
+    }
+    par.mass = mass;
+    par.cgX = mx / mass;
+    par.cgY = my / mass;
+    for (auto& body : bodies) izz += body.m * ((body.x - par.cgX) * (body.x - par.cgX) + (body.y - par.cgY) * (body.y - par.cgY));
+    par.yawInertia = izz;
+    par.cgToFront = frontX - par.cgX;
+    par.cgToRear = par.cgX - rearX;
+    if (par.cgToFront <= 0.0 || par.cgToRear <= 0.0) throw std::runtime_error("Vehicle: CG is not between the axles");
+
+    // Rolling radius at the static wheel load; the reference frame sits at wheel center height
+    double staticDeflection = mass * kGravity / (frontAxles + rearAxles) / 2.0 / par.tire.cz;
+    par.wheelRadius = par.tire.unloadedRadius - staticDeflection / 3.0;
+    par.cgHeight = par.wheelRadius + mzSum / mass;
+    par.maxSteer = vehicle.GetDouble("Maximum Steering Angle (deg)", 30.0) * kPi / 180.0;
+
+    // Driveline: driven axles and final drive
+    DemoConfiguration driveline = LoadJson(data(vehicle.GetString("Driveline.Input File", "")));
+    auto driven = vehicle.Get("Driveline.Suspension Indexes").a_val;
+    int drivenFront = 0;
+    for (auto& index : driven) drivenFront += steered.at((size_t)index.n_val) ? 1 : 0;
+    par.frontDriveShare = driven.empty() ? 0.0 : (double)drivenFront / driven.size();
+    par.finalRatio = driveline.GetDouble("Gear Ratio.Conical Gear", driveline.GetDouble("Gear Ratio.Rear Conical Gear", 1.0));
+
+    // Engine and transmission maps
+    DemoConfiguration engine = LoadJson(config.GetString("powertrain.parameters.engine_JSON", ""));
+    DemoConfiguration transmission = LoadJson(config.GetString("powertrain.parameters.transmission_JSON", ""));
+    if (engine.GetString("Template", "") != "EngineSimpleMap" || transmission.GetString("Template", "") != "AutomaticTransmissionSimpleMap") {
+        throw std::runtime_error("Vehicle: single_track supports EngineSimpleMap with AutomaticTransmissionSimpleMap only");
+    }
+    ReadMap(engine.Get("Map Full Throttle"), "Map Full Throttle", par.fullSpeed, par.fullTorque);
+    ReadMap(engine.Get("Map Zero Throttle"), "Map Zero Throttle", par.zeroSpeed, par.zeroTorque);
+    for (auto& ratio : transmission.Get("Gear Box.Forward Gear Ratios").a_val) par.gears.push_back(ratio.n_val);
+    ReadMap(transmission.Get("Gear Box.Shift Points Map RPM"), "Shift Points Map RPM", par.shiftDown, par.shiftUp);
+    if (par.gears.empty() || par.shiftUp.size() != par.gears.size()) throw std::runtime_error("Vehicle: gear ratios and shift map do not match");
+
+    // Config overrides of fitted values
+    std::map<std::string, double*> fields = {
+        {"mass", &par.mass}, {"yaw_inertia", &par.yawInertia}, {"cg_to_front", &par.cgToFront},
+        {"cg_to_rear", &par.cgToRear}, {"cg_height", &par.cgHeight}, {"wheel_radius", &par.wheelRadius},
+        {"max_steer", &par.maxSteer}, {"rolling_resistance", &par.rollingResistance},
+        {"brake_torque_front", &par.brakeTorqueFront}, {"brake_torque_rear", &par.brakeTorqueRear},
+        {"front_drive_share", &par.frontDriveShare}, {"final_ratio", &par.finalRatio}};
+    auto overrides = config.Get(root + ".single_track.overrides").o_val;
+    for (auto& [key, v] : overrides) {
+        auto it = fields.find(key);
+        if (it == fields.end() || v.type != MiniJSON::Type::Number) throw std::runtime_error("Vehicle: unknown single_track override '" + key + "'");
+        *it->second = v.n_val;
+    }
+
+    printf("[Vehicle] Single-track fit: m=%.0f kg, Izz=%.0f kg m2, a=%.3f m, b=%.3f m, h=%.3f m, r=%.4f m, "
+           "max steer=%.1f deg, %zu gears, front drive %.0f%%\n",
+           par.mass, par.yawInertia, par.cgToFront, par.cgToRear, par.cgHeight, par.wheelRadius,
+           par.maxSteer * 180.0 / kPi, par.gears.size(), par.frontDriveShare * 100.0);
+
+    auto vehicleModel = std::make_unique<SingleTrackVehicle>(name, par, config.GetDouble(root + ".single_track.max_step", 1e-3));
+
+    // Initial state as the Vehicle FMU parameters (keys contain dots, so read the object directly)
+    auto params = config.Get(root + ".parameters");
+    double pos[3] = {Number(params, "init_loc.x", 0.0), Number(params, "init_loc.y", 0.0), Number(params, "init_loc.z", 0.0)};
+    double yaw = Number(params, "init_yaw", 0.0);
+    double speed = Number(params, "init_speed", 0.0);
+    double vel[3] = {speed * std::cos(yaw), speed * std::sin(yaw), 0.0};
+    vehicleModel->SetState(pos, yaw, vel, 0.0);
+    return vehicleModel;
+}
+
+// -----------------------------------------------------------------------------
+// Comparison against the Chrono vehicle
+// -----------------------------------------------------------------------------
+
+namespace {
+
+const double kSpeedLimits[3] = {5.0, 10.0, 20.0};  // band upper bounds [m/s]
+const double kAccelLimits[3] = {1.0, 3.0, 5.0};    // band upper bounds [m/s2]
+const char* kSpeedNames[4] = {"0-5", "5-10", "10-20", "20+"};
+const char* kAccelNames[4] = {"0-1", "1-3", "3-5", "5+"};
+
+int Band(const double* limits, double v) {
+    int band = 0;
+    while (band < 3 && v >= limits[band]) ++band;
+    return band;
+}
+
+double Yaw(const double* rot) {
+    return std::atan2(2.0 * (rot[0] * rot[3] + rot[1] * rot[2]), 1.0 - 2.0 * (rot[2] * rot[2] + rot[3] * rot[3]));
+}
+
+}  // namespace
+
+SurrogateComparison::SurrogateComparison(std::unique_ptr<SingleTrackVehicle> surrogate, double horizon, double tolerance,
+                                         const std::string& logPath)
+    : m_surrogate(std::move(surrogate)), m_horizon(horizon), m_tolerance(tolerance) {
+    if (!logPath.empty()) {
+        m_log.open(logPath);
+        m_log << "start,end,mean_speed,max_lat_accel,pos_error,yaw_error_deg,speed_error\n";
+    }
+}
+
+void SurrogateComparison::Update(double time, double step, double throttle, double braking, double steering,
+                                 const double* pos, const double* rot, const double* posDt) {
+    double yaw = Yaw(rot);
+    if (!m_started) {
+        m_surrogate->SetState(pos, yaw, posDt, 0.0);
+        m_started = true;
+        m_windowStart = time;
+        m_prevYaw = yaw;
+        m_prevVel[0] = posDt[0];
+        m_prevVel[1] = posDt[1];
+        return;
+    }
+
+    // Chrono yaw rate and lateral acceleration from the step difference
+    double yawRate = std::remainder(yaw - m_prevYaw, 2.0 * kPi) / step;
+    double ax = (posDt[0] - m_prevVel[0]) / step, ay = (posDt[1] - m_prevVel[1]) / step;
+    m_maxAccel = std::max(m_maxAccel, std::fabs(-std::sin(yaw) * ax + std::cos(yaw) * ay));
+    m_speedSum += std::hypot(posDt[0], posDt[1]);
+    ++m_windowSteps;
+    m_prevYaw = yaw;
+    m_prevVel[0] = posDt[0];
+    m_prevVel[1] = posDt[1];
+
+    m_surrogate->SetInputs(throttle, braking, steering);
+    m_surrogate->DoStep(time - step, step);
+    if (time - m_windowStart < m_horizon - 1e-9) return;
+
+    // End of the window: drift of the surrogate from the Chrono trajectory
+    const double* sPos = m_surrogate->GetOutput("ref_frame.pos.x");  // x, y, z are contiguous
+    const double* sVel = m_surrogate->GetOutput("ref_frame.pos_dt.x");
+    double sRot[4] = {*m_surrogate->GetOutput("ref_frame.rot.e0"), 0.0, 0.0, *m_surrogate->GetOutput("ref_frame.rot.e3")};
+    double posError = std::hypot(sPos[0] - pos[0], sPos[1] - pos[1]);
+    double yawError = std::fabs(std::remainder(Yaw(sRot) - yaw, 2.0 * kPi)) * 180.0 / kPi;
+    double speedError = std::fabs(std::hypot(sVel[0], sVel[1]) - std::hypot(posDt[0], posDt[1]));
+    double meanSpeed = m_speedSum / m_windowSteps;
+
+    for (Bin* bin : {&m_bins[Band(kSpeedLimits, meanSpeed) * kAccelBands + Band(kAccelLimits, m_maxAccel)], &m_total}) {
+        ++bin->windows;
+        bin->sumPos += posError;
+        bin->maxPos = std::max(bin->maxPos, posError);
+        bin->sumYaw += yawError;
+        bin->sumSpeed += speedError;
+    }
+    if (m_log.is_open()) {
+        m_log << m_windowStart << "," << time << "," << meanSpeed << "," << m_maxAccel << "," << posError << ","
+              << yawError << "," << speedError << "\n";
+    }
+
+    // Restart from the Chrono state
+    m_surrogate->SetState(pos, yaw, posDt, yawRate);
+    m_windowStart = time;
+    m_speedSum = 0.0;
+    m_maxAccel = 0.0;
+    m_windowSteps = 0;
+}
+
+void SurrogateComparison::PrintSummary() const {
+    if (m_total.windows == 0) return;
+    printf("[Surrogate] Single-track vs. Chrono over %d windows of %.1f s (trusted: max drift <= %.2f m):\n",
+           m_total.windows, m_horizon, m_tolerance);
+    printf("[Surrogate]   speed [m/s] |ay| [m/s2] windows  drift mean/max [m]  yaw err [deg]  speed err [m/s]\n");
+    for (int s = 0; s < kSpeedBands; ++s) {
+        for (int a = 0; a < kAccelBands; ++a) {
+            const Bin& bin = m_bins[s * kAccelBands + a];
+            if (bin.windows == 0) continue;
+            printf("[Surrogate]   %-11s %-11s %7d  %7.2f / %7.2f  %13.2f  %15.2f  %s\n", kSpeedNames[s], kAccelNames[a],
+                   bin.windows, bin.sumPos / bin.windows, bin.maxPos, bin.sumYaw / bin.windows,
+                   bin.sumSpeed / bin.windows, bin.maxPos <= m_tolerance ? "trusted" : "check");
+        }
+    }
+    printf("[Surrogate]   all                     %7d  %7.2f / %7.2f  %13.2f  %15.2f\n", m_total.windows,
+           m_total.sumPos / m_total.windows, m_total.maxPos, m_total.sumYaw / m_total.windows,
+           m_total.sumSpeed / m_total.windows);
+}
+
+std::unique_ptr<SurrogateComparison> SurrogateComparison::FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                                     std::unique_ptr<SingleTrackVehicle> surrogate) {
+    return std::make_unique<SurrogateComparison>(std::move(surrogate),
+                                                 config.GetDouble(root + ".single_track.compare.horizon", 2.0),
+                                                 config.GetDouble(root + ".single_track.compare.tolerance", 0.5),
+                                                 config.GetString(root + ".single_track.compare.log", ""));
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ConnectionGraph.h"
+#include "DemoConfiguration.h"
+#include "NativeTire.h"
+
+// Reduced-order replacement for the Chrono vehicle / powertrain / tire / terrain
+// FMU group, for screening runs.
+//
+// Planar dynamic single-track (bicycle) model at the center of gravity with
+// longitudinal load transfer, load-dependent axle cornering stiffness from the
+// TMeasy tire, a friction ellipse per axle and a simple map powertrain
+// (engine full / zero throttle maps, automatic shift map, final drive).
+// Brake or drive demands beyond grip lock or spin the axle's wheels; the
+// sliding tires then push against the slip velocity, sideways included.
+// Below walking speed (of the whole velocity, not only its body x part) the
+// lateral states blend into the kinematic bicycle, keeping the speed, so the
+// model starts and stops cleanly. No reverse gear; z stays at the initial
+// height.
+//
+// Parameters are fit from the same Chrono JSON files the FMUs load (vehicle,
+// chassis, suspensions, wheels, brakes, driveline, engine, transmission, tire);
+// any of them can be overridden from the config.
+//
+// Variables: inputs throttle, braking, steering (like the Vehicle FMU); outputs
+// ref_frame.{pos,pos_dt}.{x,y,z}, ref_frame.rot.{e0..e3} of the chassis
+// reference frame.
+class SingleTrackVehicle : public NativeComponent {
+public:
+    struct Parameters {
+        double mass = 0.0, yawInertia = 0.0;
+        double cgToFront = 0.0, cgToRear = 0.0;  // CG to front / rear axle [m]
+        double cgHeight = 0.0;                   // above ground [m]
+        double cgX = 0.0, cgY = 0.0;             // CG in the reference frame [m]
+        double wheelRadius = 0.0;                // loaded rolling radius [m]
+        double maxSteer = 0.0;                   // road wheel angle at steering = 1 [rad]
+        double rollingResistance = 0.015;
+        double brakeTorqueFront = 0.0, brakeTorqueRear = 0.0;  // axle totals at braking = 1 [Nm]
+        double frontDriveShare = 0.0;            // 0 rear drive, 1 front drive
+        double finalRatio = 1.0;                 // wheel / driveshaft speed
+        std::vector<double> gears;               // driveshaft / engine speed per forward gear
+        std::vector<double> shiftDown, shiftUp;  // engine speed [rpm] per gear
+        std::vector<double> fullSpeed, fullTorque, zeroSpeed, zeroTorque;  // engine maps [rpm], [Nm]
+        NativeTire::Parameters tire;
+    };
+
+    SingleTrackVehicle(const std::string& name, const Parameters& par, double maxStep);
+
+    // Chassis reference frame position, yaw and velocity (world) / yaw rate
+    void SetState(const double* pos, double yaw, const double* posDt, double yawRate);
+    void SetInputs(double throttle, double braking, double steering);
+    const Parameters& GetParameters() const { return m_par; }
+    int GetGear() const { return m_gear + 1; }
+
+    // NativeComponent
+    const std::string& GetName() const override { return m_name; }
+    double* GetInput(const std::string& name) override;
+    const double* GetOutput(const std::string& name) override;
+    fmi2_status_t DoStep(double time, double step) override;
+
+    // Fits the parameters from "vehicle.parameters" (vehicle_JSON, data_path, init_speed),
+    // "powertrain.parameters" and "tire.parameters"; "<root>.single_track.overrides" replaces fitted values
+    static std::unique_ptr<SingleTrackVehicle> FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                          const std::string& name);
+
+private:
+    void Integrate(double h);
+    double EngineTorque(double rpm) const;
+    void UpdateOutputs();
+
+    std::string m_name;
+    Parameters m_par;
+    double m_maxStep;
+
+    // CG state: position, yaw, body velocities, yaw rate
+    double m_x = 0.0, m_y = 0.0, m_z = 0.0, m_yaw = 0.0;
+    double m_vx = 0.0, m_vy = 0.0, m_r = 0.0;
+    double m_ax = 0.0;  // last longitudinal acceleration, for the load transfer
+    int m_gear = 0;
+
+    double m_throttle = 0.0, m_braking = 0.0, m_steering = 0.0;
+    double m_pos[3] = {}, m_rot[4] = {1.0, 0.0, 0.0, 0.0}, m_posDt[3] = {};
+    std::map<std::string, double*> m_inputs;
+    std::map<std::string, const double*> m_outputs;
+};
+
+// "compare" vehicle model: the surrogate runs next to the Chrono vehicle on the
+// same driver inputs. Every `horizon` seconds its drift from the Chrono
+// trajectory is recorded and it is reset onto the Chrono state; windows are
+// binned by speed and peak lateral acceleration, showing where it can be trusted.
+class SurrogateComparison {
+public:
+    // An empty logPath disables the per-window CSV
+    SurrogateComparison(std::unique_ptr<SingleTrackVehicle> surrogate, double horizon, double tolerance,
+                        const std::string& logPath);
+
+    // After each outer step: driver inputs applied during the step and the Chrono reference frame at its end
+    void Update(double time, double step, double throttle, double braking, double steering,
+                const double* pos, const double* rot, const double* posDt);
+    void PrintSummary() const;
+
+    static std::unique_ptr<SurrogateComparison> FromConfig(const DemoConfiguration& config, const std::string& root,
+                                                           std::unique_ptr<SingleTrackVehicle> surrogate);
+
+private:
+    struct Bin {
+        int windows = 0;
+        double sumPos = 0.0, maxPos = 0.0, sumYaw = 0.0, sumSpeed = 0.0;
+    };
+    static const int kSpeedBands = 4, kAccelBands = 4;
+
+    std::unique_ptr<SingleTrackVehicle> m_surrogate;
+    double m_horizon, m_tolerance;
+    bool m_started = false;
+    double m_windowStart = 0.0, m_prevYaw = 0.0, m_prevVel[2] = {};
+    double m_speedSum = 0.0, m_maxAccel = 0.0;
+    int m_windowSteps = 0;
+    std::array<Bin, kSpeedBands * kAccelBands> m_bins;
+    Bin m_total;
+    std::ofstream m_log;
+};
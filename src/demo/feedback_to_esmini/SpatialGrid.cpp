@@ -0,0 +1,225 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Cell coordinates are clamped to this so that far-off or non-finite positions stay representable
+constexpr double kCellLimit = 1 << 30;
+
+uint32_t HashCell(int32_t cx, int32_t cy) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+}  // namespace
+
+SpatialGrid::Options SpatialGrid::Options::FromConfig(const DemoConfiguration& config, const std::string& root) {
+    Options o;
+    o.cellSize = config.GetDouble(root + ".cell_size", o.cellSize);
+    return o;
+}
+
+SpatialGrid::SpatialGrid(const Options& options) : m_cellSize(options.cellSize) {
+    if (!(m_cellSize > 0.0)) throw std::runtime_error("Spatial grid cell_size must be positive");
+}
+
+const SpatialGrid::Cell* SpatialGrid::Grid::Find(int32_t cx, int32_t cy) const {
+    if (cells.empty()) return nullptr;
+    for (uint32_t s = HashCell(cx, cy) & mask; cells[s].count != 0; s = (s + 1) & mask) {
+        if (cells[s].cx == cx && cells[s].cy == cy) return &cells[s];
+    }
+    return nullptr;
+}
+
+int32_t SpatialGrid::CellOf(double v) const {
+    double c = std::floor(v / m_cellSize);
+    if (!(c > -kCellLimit)) return static_cast<int32_t>(-kCellLimit);  // also NaN
+    if (c > kCellLimit) return static_cast<int32_t>(kCellLimit);
+    return static_cast<int32_t>(c);
+}
+
+void SpatialGrid::Rebuild(Grid& g) {
+    size_t n = g.items.size();
+    size_t capacity = 16;
+    while (capacity < 2 * n) capacity *= 2;
+    g.cells.assign(capacity, Cell{});
+    g.mask = static_cast<uint32_t>(capacity - 1);
+    g.slot.resize(n);
+    g.order.resize(n);
+    g.minCx = g.minCy = std::numeric_limits<int32_t>::max();
+    g.maxCx = g.maxCy = std::numeric_limits<int32_t>::min();
+    g.maxRadius = 0.0;
+
+    // Count per cell, then lay the cells out back to back (counting sort)
+    for (uint32_t i = 0; i < n; ++i) {
+        const Footprint& f = g.items[i];
+        int32_t cx = CellOf(f.x), cy = CellOf(f.y);
+        uint32_t s = HashCell(cx, cy) & g.mask;
+        while (g.cells[s].count != 0 && (g.cells[s].cx != cx || g.cells[s].cy != cy)) s = (s + 1) & g.mask;
+        g.cells[s].cx = cx;
+        g.cells[s].cy = cy;
+        ++g.cells[s].count;
+        g.slot[i] = s;
+        g.minCx = std::min(g.minCx, cx), g.maxCx = std::max(g.maxCx, cx);
+        g.minCy = std::min(g.minCy, cy), g.maxCy = std::max(g.maxCy, cy);
+        g.maxRadius = std::max(g.maxRadius, f.radius);
+    }
+    uint32_t end = 0;
+    for (auto& c : g.cells) {
+        end += c.count;
+        c.begin = end;  // filled backwards below
+    }
+    for (uint32_t i = static_cast<uint32_t>(n); i-- > 0;) g.order[--g.cells[g.slot[i]].begin] = i;
+}
+
+void SpatialGrid::Update(const ObjectTable& objects) {
+    size_t n = objects.Size();
+    m_moving.items.resize(n);
+    for (size_t r = 0; r < n; ++r) {
+        Footprint& f = m_moving.items[r];
+        f.id = objects.id[r];
+        f.x = objects.x[r], f.y = objects.y[r], f.yaw = objects.yaw[r];
+        f.halfLength = 0.5 * objects.length[r], f.halfWidth = 0.5 * objects.width[r];
+        f.radius = std::hypot(f.halfLength, f.halfWidth);
+    }
+    Rebuild(m_moving);
+}
+
+void SpatialGrid::SetStationary(const osi3::GroundTruth& groundTruth, uint64_t generation) {
+    if (generation != 0 && generation == m_stationaryGeneration) return;
+    m_stationaryGeneration = generation;
+
+    size_t n = static_cast<size_t>(groundTruth.stationary_object_size());
+    m_stationary.items.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const osi3::StationaryObject& o = groundTruth.stationary_object(static_cast<int>(i));
+        const osi3::BaseStationary& b = o.base();
+        Footprint& f = m_stationary.items[i];
+        f.id = o.id().value();
+        f.x = b.position().x(), f.y = b.position().y(), f.yaw = b.orientation().yaw();
+        f.halfLength = 0.5 * b.dimension().length(), f.halfWidth = 0.5 * b.dimension().width();
+        f.radius = std::hypot(f.halfLength, f.halfWidth);
+    }
+    Rebuild(m_stationary);
+}
+
+double SpatialGrid::MaxRadius() const { return std::max(m_moving.maxRadius, m_stationary.maxRadius); }
+
+template <typename F>
+size_t SpatialGrid::VisitCells(const Grid& g, int64_t cx0, int64_t cy0, int64_t cx1, int64_t cy1, F&& visit) const {
+    cx0 = std::max<int64_t>(cx0, g.minCx), cx1 = std::min<int64_t>(cx1, g.maxCx);
+    cy0 = std::max<int64_t>(cy0, g.minCy), cy1 = std::min<int64_t>(cy1, g.maxCy);
+    if (cx0 > cx1 || cy0 > cy1) return 0;
+    for (int64_t cx = cx0; cx <= cx1; ++cx) {
+        for (int64_t cy = cy0; cy <= cy1; ++cy) {
+            const Cell* c = g.Find(static_cast<int32_t>(cx), static_cast<int32_t>(cy));
+            if (!c) continue;
+            for (uint32_t k = c->begin; k < c->begin + c->count; ++k) visit(g.order[k]);
+        }
+    }
+    return static_cast<size_t>((cx1 - cx0 + 1) * (cy1 - cy0 + 1));
+}
+
+void SpatialGrid::WithinRadius(double x, double y, double radius, std::vector<Hit>& hits) const {
+    hits.clear();
+    if (!(radius >= 0.0)) return;
+    for (Layer layer : {Layer::Moving, Layer::Stationary}) {
+        const Grid& g = Of(layer);
+        auto test = [&](uint32_t i) {
+            double d = std::hypot(g.items[i].x - x, g.items[i].y - y);
+            if (d <= radius) hits.push_back({layer, i, d});
+        };
+        // A query wider than the populated cells is cheaper as a plain scan
+        double cells = std::ceil(2.0 * radius / m_cellSize) + 1.0;
+        if (cells * cells > static_cast<double>(g.items.size())) {
+            for (uint32_t i = 0; i < g.items.size(); ++i) test(i);
+        } else {
+            VisitCells(g, CellOf(x - radius), CellOf(y - radius), CellOf(x + radius), CellOf(y + radius), test);
+        }
+    }
+}
+
+void SpatialGrid::WithinBox(double minX, double minY, double maxX, double maxY, std::vector<Hit>& hits) const {
+    hits.clear();
+    if (!(minX <= maxX && minY <= maxY)) return;
+    double cx = 0.5 * (minX + maxX), cy = 0.5 * (minY + maxY);
+    for (Layer layer : {Layer::Moving, Layer::Stationary}) {
+        const Grid& g = Of(layer);
+        auto test = [&](uint32_t i) {
+            const Footprint& f = g.items[i];
+            if (f.x >= minX && f.x <= maxX && f.y >= minY && f.y <= maxY) {
+                hits.push_back({layer, i, std::hypot(f.x - cx, f.y - cy)});
+            }
+        };
+        double cells = (std::ceil((maxX - minX) / m_cellSize) + 1.0) * (std::ceil((maxY - minY) / m_cellSize) + 1.0);
+        if (cells > static_cast<double>(g.items.size())) {
+            for (uint32_t i = 0; i < g.items.size(); ++i) test(i);
+        } else {
+            VisitCells(g, CellOf(minX), CellOf(minY), CellOf(maxX), CellOf(maxY), test);
+        }
+    }
+}
+
+void SpatialGrid::Nearest(double x, double y, size_t k, std::vector<Hit>& hits, double maxDistance) const {
+    hits.clear();
+    size_t total = m_moving.items.size() + m_stationary.items.size();
+    if (k == 0 || total == 0) return;
+
+    auto byDistance = [](const Hit& a, const Hit& b) { return a.distance < b.distance; };
+    const int64_t qx = CellOf(x), qy = CellOf(y);
+    // Rings of cells around the query's cell: after ring R, every object closer than R cells
+    // has been seen. Sparse layers with far-apart objects would need many empty rings, so give
+    // up on the grid once the lookups outnumber the objects.
+    size_t lookups = 0, budget = 4 * total + 64;
+    bool exhaustive = false;
+    for (int64_t r = 0;; ++r) {
+        bool covered = true;
+        for (Layer layer : {Layer::Moving, Layer::Stationary}) {
+            const Grid& g = Of(layer);
+            if (g.items.empty()) continue;
+            auto test = [&](uint32_t i) {
+                double d = std::hypot(g.items[i].x - x, g.items[i].y - y);
+                if (d <= maxDistance) hits.push_back({layer, i, d});
+            };
+            if (r == 0) {
+                lookups += VisitCells(g, qx, qy, qx, qy, test);
+            } else {
+                lookups += VisitCells(g, qx - r, qy - r, qx + r, qy - r, test);          // bottom row
+                lookups += VisitCells(g, qx - r, qy + r, qx + r, qy + r, test);          // top row
+                lookups += VisitCells(g, qx - r, qy - r + 1, qx - r, qy + r - 1, test);  // left column
+                lookups += VisitCells(g, qx + r, qy - r + 1, qx + r, qy + r - 1, test);  // right column
+            }
+            covered = covered && qx - r <= g.minCx && qx + r >= g.maxCx && qy - r <= g.minCy && qy + r >= g.maxCy;
+        }
+
+        double reach = static_cast<double>(r) * m_cellSize;  // everything closer than this has been seen
+        if (covered || reach > maxDistance) break;
+        if (hits.size() >= k) {
+            std::nth_element(hits.begin(), hits.begin() + (k - 1), hits.end(), byDistance);
+            if (hits[k - 1].distance <= reach) break;
+        }
+        if (lookups > budget) {
+            exhaustive = true;
+            break;
+        }
+    }
+
+    if (exhaustive) {
+        hits.clear();
+        for (Layer layer : {Layer::Moving, Layer::Stationary}) {
+            const Grid& g = Of(layer);
+            for (uint32_t i = 0; i < g.items.size(); ++i) {
+                double d = std::hypot(g.items[i].x - x, g.items[i].y - y);
+                if (d <= maxDistance) hits.push_back({layer, i, d});
+            }
+        }
+    }
+    if (hits.size() > k) {
+        std::nth_element(hits.begin(), hits.begin() + (k - 1), hits.end(), byDistance);
+        hits.resize(k);
+    }
+    std::sort(hits.begin(), hits.end(), byDistance);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+#include "ObjectTable.h"
+#include "osi_groundtruth.pb.h"
+
+// Uniform-grid spatial index over the ground truth objects.
+//
+// Objects are bucketed into square cells of the ground plane, so proximity
+// queries (within a radius, within a box, k nearest) only visit the cells they
+// overlap instead of every object, and pairwise checks become a query per
+// object. Two layers are kept:
+//   moving      rows of the step's ObjectTable, re-bucketed by Update()
+//   stationary  stationary_object of the static ground truth; SetStationary()
+//               only rebuilds it when the generation changes
+// Cells are stored compactly (one item array grouped by cell plus an
+// open-addressing cell index), so memory follows the object count rather than
+// the map extent, and rebuilding does not allocate once the vectors have grown.
+//
+// Queries test object centers. A footprint reaches at most MaxRadius() beyond
+// its center; widen the query by that when looking for overlaps.
+class SpatialGrid {
+public:
+    struct Options {
+        double cellSize = 20.0;  // [m]
+
+        // "simulation.spatial_grid": cell_size
+        static Options FromConfig(const DemoConfiguration& config, const std::string& root);
+    };
+
+    enum class Layer : uint8_t { Moving, Stationary };
+
+    // Oriented box in the ground plane
+    struct Footprint {
+        uint64_t id = 0;
+        double x = 0.0, y = 0.0, yaw = 0.0;
+        double halfLength = 0.0, halfWidth = 0.0;
+        double radius = 0.0;  // of the bounding circle
+    };
+
+    struct Hit {
+        Layer layer;
+        uint32_t index;   // ObjectTable row / stationary_object index
+        double distance;  // center to query point
+    };
+
+    // Throws std::runtime_error on a non-positive cell size
+    explicit SpatialGrid(const Options& options);
+
+    void Update(const ObjectTable& objects);
+    void SetStationary(const osi3::GroundTruth& groundTruth, uint64_t generation);
+
+    // `hits` is cleared first; results are unordered
+    void WithinRadius(double x, double y, double radius, std::vector<Hit>& hits) const;
+    void WithinBox(double minX, double minY, double maxX, double maxY, std::vector<Hit>& hits) const;
+    // Up to k nearest within maxDistance, sorted by distance
+    void Nearest(double x, double y, size_t k, std::vector<Hit>& hits,
+                 double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+    const Footprint& Get(Layer layer, uint32_t index) const { return Of(layer).items[index]; }
+    const Footprint& Get(const Hit& hit) const { return Get(hit.layer, hit.index); }
+    size_t Size(Layer layer) const { return Of(layer).items.size(); }
+    double MaxRadius() const;
+
+private:
+    struct Cell {
+        int32_t cx = 0, cy = 0;
+        uint32_t begin = 0, count = 0;  // count 0 = empty slot
+    };
+
+    struct Grid {
+        std::vector<Footprint> items;
+        std::vector<uint32_t> order;  // item indices grouped by cell
+        std::vector<uint32_t> slot;   // cell slot per item (scratch)
+        std::vector<Cell> cells;
+        uint32_t mask = 0;
+        int32_t minCx = 0, minCy = 0, maxCx = -1, maxCy = -1;  // occupied cell range
+        double maxRadius = 0.0;
+
+        const Cell* Find(int32_t cx, int32_t cy) const;
+    };
+
+    const Grid& Of(Layer layer) const { return layer == Layer::Moving ? m_moving : m_stationary; }
+    int32_t CellOf(double v) const;
+    void Rebuild(Grid& grid);
+    // Visits the items of the cells in [cx0, cx1] x [cy0, cy1]; returns the number of cells looked up
+    template <typename F>
+    size_t VisitCells(const Grid& grid, int64_t cx0, int64_t cy0, int64_t cx1, int64_t cy1, F&& visit) const;
+
+    double m_cellSize;
+    Grid m_moving, m_stationary;
+    uint64_t m_stationaryGeneration = 0;
+};
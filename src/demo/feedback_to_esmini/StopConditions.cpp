@@ -0,0 +1,221 @@
+#include "StopConditions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// JSON string contents; the reason includes user-chosen condition names
+std::string EscapeJson(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+int StopConditions::AddSignal(const std::string& name) {
+    auto it = m_slots.find(name);
+    if (it != m_slots.end()) return it->second;
+    int slot = static_cast<int>(m_signals.size());
+    m_slots[name] = slot;
+    m_signalNames.push_back(name);
+    m_signals.push_back(0.0);
+    return slot;
+}
+
+void StopConditions::Compile(const DemoConfiguration& config, const std::string& root) {
+    m_conditions.clear();
+    m_needsGroundTruth = false;
+    if (!config.GetBool(root + ".enabled", true)) return;
+
+    m_resultFile = config.GetString(root + ".result_file", "");
+
+    auto list = config.Get(root + ".conditions");
+    if (list.type != MiniJSON::Type::Array) return;
+
+    auto number = [](const MiniJSON::Object& o, const std::string& key, double def) {
+        auto it = o.find(key);
+        return (it != o.end() && it->second.type == MiniJSON::Type::Number) ? it->second.n_val : def;
+    };
+    auto text = [](const MiniJSON::Object& o, const std::string& key, const std::string& def) {
+        auto it = o.find(key);
+        return (it != o.end() && it->second.type == MiniJSON::Type::String) ? it->second.s_val : def;
+    };
+    auto slot = [&](const std::string& name) {
+        auto it = m_slots.find(name);
+        if (it == m_slots.end()) {
+            std::string known;
+            for (auto& n : m_signalNames) known += (known.empty() ? "" : ", ") + n;
+            throw std::runtime_error("Stop condition: unknown signal '" + name + "' (available: " + known + ")");
+        }
+        return it->second;
+    };
+
+    for (auto& entry : list.a_val) {
+        if (entry.type != MiniJSON::Type::Object) continue;
+        const auto& o = entry.o_val;
+
+        Condition c;
+        std::string type = text(o, "type", "threshold");
+        c.name = text(o, "name", type);
+        c.hold = number(o, "for", 0.0);
+        c.after = number(o, "after", 0.0);
+
+        if (type == "threshold") {
+            c.kind = Kind::Threshold;
+            c.slot = slot(text(o, "signal", ""));
+            c.value = number(o, "value", 0.0);
+            std::string op = text(o, "op", "<");
+            if (op == "<") c.op = Op::Less;
+            else if (op == "<=") c.op = Op::LessEqual;
+            else if (op == ">") c.op = Op::Greater;
+            else if (op == ">=") c.op = Op::GreaterEqual;
+            else throw std::runtime_error("Stop condition " + c.name + ": unknown op '" + op + "'");
+        } else if (type == "standstill") {
+            c.kind = Kind::Threshold;
+            c.slot = slot("speed");
+            c.op = Op::Less;
+            c.value = number(o, "speed", 0.1);
+        } else if (type == "collision") {
+            c.kind = Kind::Collision;
+            c.margin = number(o, "margin", 0.0);
+            m_needsGroundTruth = true;
+        } else if (type == "off_road") {
+            c.kind = Kind::OffRoad;
+            m_needsGroundTruth = true;
+        } else {
+            throw std::runtime_error("Stop condition " + c.name + ": unknown type '" + type + "'");
+        }
+        m_conditions.push_back(c);
+    }
+
+    for (auto& c : m_conditions) {
+        printf("[Stop] Condition '%s' (hold %.2f s, after %.2f s)\n", c.name.c_str(), c.hold, c.after);
+    }
+}
+
+bool StopConditions::Evaluate(double time, const ObjectTable* objects, const SpatialGrid* grid, uint64_t egoId) {
+    for (auto& c : m_conditions) {
+        if (time < c.after) continue;
+
+        if (!Test(c, objects, grid, egoId)) {
+            c.since = -1.0;
+            continue;
+        }
+        if (c.since < 0.0) c.since = time;
+        if (time - c.since + 1e-9 < c.hold) continue;
+
+        std::ostringstream ss;
+        ss << c.name << " at t=" << time << " s";
+        switch (c.kind) {
+            case Kind::Threshold:
+                ss << " (" << m_signalNames[c.slot] << "=" << c.observed << ")";
+                break;
+            case Kind::Collision:
+                ss << " (object " << static_cast<uint64_t>(c.observed) << ")";
+                break;
+            case Kind::OffRoad:
+                break;
+        }
+        m_reason = ss.str();
+        m_stopTime = time;
+        return true;
+    }
+    return false;
+}
+
+bool StopConditions::Test(Condition& c, const ObjectTable* objects, const SpatialGrid* grid, uint64_t egoId) {
+    if (c.kind == Kind::Threshold) {
+        double v = m_signals[c.slot];
+        c.observed = v;
+        switch (c.op) {
+            case Op::Less: return v < c.value;
+            case Op::LessEqual: return v <= c.value;
+            case Op::Greater: return v > c.value;
+            case Op::GreaterEqual: return v >= c.value;
+        }
+        return false;
+    }
+
+    if (!objects) return false;
+    uint32_t ego = egoId ? objects->Find(egoId) : objects->EgoRow();
+    if (ego == ObjectTable::kNoRow) return false;
+
+    if (c.kind == Kind::OffRoad) return !objects->hasLane[ego];
+
+    if (!grid || grid->Size(SpatialGrid::Layer::Moving) != objects->Size()) return false;
+    // Only objects whose bounding circle can reach the ego's (each grown by the margin)
+    const SpatialGrid::Footprint& self = grid->Get(SpatialGrid::Layer::Moving, ego);
+    double reach = self.radius + grid->MaxRadius() + 2.0 * std::sqrt(2.0) * std::max(c.margin, 0.0);
+    grid->WithinRadius(self.x, self.y, reach, m_candidates);
+    std::sort(m_candidates.begin(), m_candidates.end(),
+              [](const SpatialGrid::Hit& a, const SpatialGrid::Hit& b) { return a.distance < b.distance; });
+    for (const auto& hit : m_candidates) {
+        if (hit.layer == SpatialGrid::Layer::Moving && hit.index == ego) continue;
+        const SpatialGrid::Footprint& other = grid->Get(hit);
+        if (Collides(self, other, c.margin)) {
+            c.observed = static_cast<double>(other.id);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Separating axis test of the two oriented bounding boxes in the ground plane
+bool StopConditions::Collides(const SpatialGrid::Footprint& a, const SpatialGrid::Footprint& b, double margin) {
+    struct Box { double cx, cy, ux, uy, hl, hw; };
+    auto box = [margin](const SpatialGrid::Footprint& f) {
+        return Box{f.x, f.y, 0.0, 0.0, f.halfLength + margin, f.halfWidth + margin};
+    };
+    Box A = box(a), B = box(b);
+
+    // Quick reject on the bounding circles, before any trigonometry
+    double dx = B.cx - A.cx, dy = B.cy - A.cy;
+    double ra = std::hypot(A.hl, A.hw), rb = std::hypot(B.hl, B.hw);
+    if (dx * dx + dy * dy > (ra + rb) * (ra + rb)) return false;
+    A.ux = std::cos(a.yaw), A.uy = std::sin(a.yaw);
+    B.ux = std::cos(b.yaw), B.uy = std::sin(b.yaw);
+
+    const double axes[4][2] = {{A.ux, A.uy}, {-A.uy, A.ux}, {B.ux, B.uy}, {-B.uy, B.ux}};
+    for (const auto& ax : axes) {
+        auto extent = [&](const Box& k) {
+            return k.hl * std::fabs(k.ux * ax[0] + k.uy * ax[1]) + k.hw * std::fabs(-k.uy * ax[0] + k.ux * ax[1]);
+        };
+        if (std::fabs(dx * ax[0] + dy * ax[1]) > extent(A) + extent(B)) return false;
+    }
+    return true;
+}
+
+void StopConditions::PrintSummary() const {
+    if (m_reason.empty()) {
+        if (IsEnabled()) printf("[Stop] No stop condition triggered\n");
+        return;
+    }
+    printf("[Stop] Stopped early: %s\n", m_reason.c_str());
+}
+
+void StopConditions::WriteResult(double time) const {
+    if (m_resultFile.empty()) return;
+    std::ofstream f(m_resultFile);
+    f << "{\n"
+      << "    \"stopped_early\": " << (m_reason.empty() ? "false" : "true") << ",\n"
+      << "    \"reason\": \"" << EscapeJson(m_reason) << "\",\n"
+      << "    \"end_time\": " << (m_stopTime >= 0.0 ? m_stopTime : time) << "\n"
+      << "}\n";
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DemoConfiguration.h"
+#include "ObjectTable.h"
+#include "SpatialGrid.h"
+
+// Early termination of a run once its outcome is decided.
+//
+// Conditions are declared in "simulation.stop_conditions" and compiled once into
+// flat predicates over signal slots (values exchanged in the macro step) and,
+// for collision / off-road checks, the object table of esmini's ground truth and
+// its spatial grid (collision candidates are a radius query around the ego). Evaluate() is
+// called once per macro step; the first condition that has held for its `for`
+// duration stops the run and is recorded as the stop reason.
+//
+// Condition types:
+//   threshold   signal <op> value                (op: <, <=, >, >=)
+//   standstill  speed below `speed`               (default 0.1 m/s)
+//   collision   ego bounding box overlaps another moving or a stationary object (plus `margin`)
+//   off_road    ego has no assigned lane in the ground truth
+// Common keys: name, for (hold time [s], default 0), after (ignore before [s], default 0)
+class StopConditions {
+public:
+    // Signals must be registered before Compile()
+    int AddSignal(const std::string& name);
+    void SetSignal(int slot, double value) { m_signals[slot] = value; }
+
+    // Throws std::runtime_error on unknown types or signals
+    void Compile(const DemoConfiguration& config, const std::string& root);
+
+    bool IsEnabled() const { return !m_conditions.empty(); }
+    bool NeedsGroundTruth() const { return m_needsGroundTruth; }
+
+    // Returns true when the run should stop. `objects` and `grid` (updated from
+    // the same table) may be null when not needed; egoId 0 selects the table's
+    // ego (host_vehicle_id).
+    bool Evaluate(double time, const ObjectTable* objects, const SpatialGrid* grid, uint64_t egoId);
+
+    const std::string& GetReason() const { return m_reason; }
+    void PrintSummary() const;
+    void WriteResult(double time) const;
+
+private:
+    enum class Kind { Threshold, Collision, OffRoad };
+    enum class Op { Less, LessEqual, Greater, GreaterEqual };
+
+    struct Condition {
+        std::string name;
+        Kind kind = Kind::Threshold;
+        int slot = -1;
+        Op op = Op::Less;
+        double value = 0.0;
+        double margin = 0.0;
+        double hold = 0.0;
+        double after = 0.0;
+
+        double since = -1.0;  // time the predicate became true (-1: false)
+        double observed = 0.0;
+    };
+
+    bool Test(Condition& c, const ObjectTable* objects, const SpatialGrid* grid, uint64_t egoId);
+    static bool Collides(const SpatialGrid::Footprint& a, const SpatialGrid::Footprint& b, double margin);
+
+    std::map<std::string, int> m_slots;
+    std::vector<std::string> m_signalNames;
+    std::vector<double> m_signals;
+    std::vector<Condition> m_conditions;
+    bool m_needsGroundTruth = false;
+    std::vector<SpatialGrid::Hit> m_candidates;
+
+    std::string m_resultFile;
+    std::string m_reason;
+    double m_stopTime = -1.0;
+};
@@ -0,0 +1,170 @@
+#include "TrafficUpdateEncoder.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "OsiWireScanner.h"
+
+namespace {
+
+// Field numbers from osi_trafficupdate.proto / osi_object.proto / osi_common.proto
+constexpr uint32_t kTrafficUpdateTimestamp = 2;
+constexpr uint32_t kTrafficUpdateUpdate = 3;
+constexpr uint32_t kTimestampSeconds = 1;
+constexpr uint32_t kTimestampNanos = 2;
+constexpr uint32_t kMovingObjectBase = 2;
+constexpr uint32_t kMovingObjectAssignedLaneId = 4;
+constexpr uint32_t kMovingObjectClassification = 9;
+constexpr uint32_t kClassificationAssignedLaneId = 1;
+constexpr uint32_t kIdentifierValue = 1;
+constexpr uint32_t kBasePosition = 2;
+constexpr uint32_t kBaseOrientation = 3;
+constexpr uint32_t kBaseVelocity = 4;
+constexpr uint32_t kBaseAcceleration = 5;
+
+constexpr int kVarint = WireReader::kVarint, kFixed64 = WireReader::kFixed64, kLength = WireReader::kLength;
+
+// int64 seconds may be negative (10 bytes); uint32 nanos fit in 5; uint64 ids take 10
+constexpr size_t kSecondsWidth = 10;
+constexpr size_t kIdWidth = 10;
+constexpr size_t kNanosWidth = 5;
+// Vector3d / Orientation3d with all three doubles present: 3 x (tag + 8)
+constexpr size_t kTripleSize = 3 * 9;
+
+// Distinguishes templates across encoders and SetTemplate() calls
+std::atomic<uint64_t> g_nextContentId{1};
+
+// Varint padded with continuation bytes to a fixed width; parsers accept the non-minimal form
+void WritePaddedVarint(char* p, uint64_t v, size_t width) {
+    for (size_t i = 0; i + 1 < width; ++i) {
+        p[i] = static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    p[width - 1] = static_cast<char>(v & 0x7f);
+}
+
+// Appends a Vector3d-shaped submessage with all three doubles set to 0; returns the offset of the first double
+size_t PutTriple(std::string& out, uint32_t field) {
+    AppendTag(out, field, kLength);
+    AppendVarint(out, kTripleSize);
+    size_t offset = out.size() + 1;
+    for (uint32_t f = 1; f <= 3; ++f) {
+        AppendTag(out, f, kFixed64);
+        out.append(8, '\0');
+    }
+    return offset;
+}
+
+// Appends an Identifier field with a padded value; returns the offset of the value
+size_t PutIdentifier(std::string& out, uint32_t field) {
+    AppendTag(out, field, kLength);
+    AppendVarint(out, 1 + kIdWidth);
+    AppendTag(out, kIdentifierValue, kVarint);
+    size_t offset = out.size();
+    out.append(kIdWidth, '\0');
+    return offset;
+}
+
+}  // namespace
+
+void TrafficUpdateEncoder::SetTemplate(const osi3::MovingObject& object, bool assignLane) {
+    // Static parts: the object without base, and base without the patched fields
+    osi3::MovingObject statics(object);
+    statics.clear_base();
+    std::string classification;
+    m_laneId = 0;
+    if (assignLane) {
+        if (object.moving_object_classification().assigned_lane_id_size() > 0) {
+            m_laneId = object.moving_object_classification().assigned_lane_id(0).value();
+        } else if (object.assigned_lane_id_size() > 0) {
+            m_laneId = object.assigned_lane_id(0).value();
+        }
+        // The lane percentages belong to the replaced lane ids
+        statics.clear_assigned_lane_id();
+        osi3::MovingObject::MovingObjectClassification cls(statics.moving_object_classification());
+        cls.clear_assigned_lane_id();
+        cls.clear_assigned_lane_percentage();
+        statics.clear_moving_object_classification();
+        classification = cls.SerializeAsString();
+    }
+    osi3::BaseMoving baseStatics(object.base());
+    baseStatics.clear_position();
+    baseStatics.clear_orientation();
+    baseStatics.clear_velocity();
+    baseStatics.clear_acceleration();
+
+    std::string base = baseStatics.SerializeAsString();
+    size_t position = PutTriple(base, kBasePosition);
+    size_t orientation = PutTriple(base, kBaseOrientation);
+    size_t velocity = PutTriple(base, kBaseVelocity);
+    size_t acceleration = PutTriple(base, kBaseAcceleration);
+
+    std::string obj = statics.SerializeAsString();
+    AppendTag(obj, kMovingObjectBase, kLength);
+    AppendVarint(obj, base.size());
+    size_t objBase = obj.size();
+    obj += base;
+    size_t laneOffsets[2] = {0, 0};
+    if (assignLane) {
+        laneOffsets[0] = PutIdentifier(obj, kMovingObjectAssignedLaneId);
+        size_t lane = PutIdentifier(classification, kClassificationAssignedLaneId);
+        AppendTag(obj, kMovingObjectClassification, kLength);
+        AppendVarint(obj, classification.size());
+        laneOffsets[1] = obj.size() + lane;
+        obj += classification;
+    }
+
+    m_template.clear();
+    AppendTag(m_template, kTrafficUpdateTimestamp, kLength);
+    AppendVarint(m_template, 1 + kSecondsWidth + 1 + kNanosWidth);
+    AppendTag(m_template, kTimestampSeconds, kVarint);
+    m_seconds = m_template.size();
+    m_template.append(kSecondsWidth, '\0');
+    AppendTag(m_template, kTimestampNanos, kVarint);
+    m_nanos = m_template.size();
+    m_template.append(kNanosWidth, '\0');
+
+    AppendTag(m_template, kTrafficUpdateUpdate, kLength);
+    AppendVarint(m_template, obj.size());
+    size_t update = m_template.size();
+    m_template += obj;
+
+    m_contentId = g_nextContentId++;
+    m_time = 0.0;
+    m_position = Triple{update + objBase + position};
+    m_orientation = Triple{update + objBase + orientation};
+    m_velocity = Triple{update + objBase + velocity};
+    m_acceleration = Triple{update + objBase + acceleration};
+    for (int i = 0; i < 2; ++i) m_laneOffsets[i] = assignLane ? update + laneOffsets[i] : 0;
+}
+
+void TrafficUpdateEncoder::Write(OsmpBuffer& out) const {
+    if (out.contentId != m_contentId) {
+        out.data = m_template;
+        out.contentId = m_contentId;
+    }
+    char* data = &out.data[0];
+
+    double seconds = std::floor(m_time);
+    uint32_t nanos = static_cast<uint32_t>((m_time - seconds) * 1e9);
+    if (nanos >= 1000000000u) nanos = 999999999u;
+    WritePaddedVarint(data + m_seconds, static_cast<uint64_t>(static_cast<int64_t>(seconds)), kSecondsWidth);
+    WritePaddedVarint(data + m_nanos, nanos, kNanosWidth);
+
+    Patch(data, m_position);
+    Patch(data, m_orientation);
+    Patch(data, m_velocity);
+    Patch(data, m_acceleration);
+    for (size_t offset : m_laneOffsets) {
+        if (offset) WritePaddedVarint(data + offset, m_laneId, kIdWidth);
+    }
+}
+
+void TrafficUpdateEncoder::Patch(char* data, const Triple& t) {
+    // Doubles are 9 bytes apart (one-byte tag in between); OSI only runs on little-endian hosts
+    char* p = data + t.offset;
+    std::memcpy(p, &t.v[0], 8);
+    std::memcpy(p + 9, &t.v[1], 8);
+    std::memcpy(p + 18, &t.v[2], 8);
+}
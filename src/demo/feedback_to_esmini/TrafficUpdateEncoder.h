@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "OsmpBuffers.h"
+#include "osi_object.pb.h"
+
+// osi3::TrafficUpdate for a single moving object, encoded once and patched in place.
+//
+// SetTemplate() serializes the object's static fields (id, dimension, vehicle
+// attributes, classification, ...) together with the TrafficUpdate framing.
+// The dynamic fields (timestamp, base position / orientation / velocity /
+// acceleration) are written at fixed width: doubles as explicit fixed64
+// fields, timestamp varints padded to their maximum length. Write() copies the
+// template into an outgoing buffer only the first time it sees that buffer;
+// after that it just overwrites the dynamic bytes, so no message is built or
+// serialized per step.
+//
+// With `assignLane`, the object's assigned lane (moving_object_classification
+// and the deprecated top-level field) is replaced by a single padded id that
+// SetAssignedLane() patches as well; until then it keeps the object's first lane.
+class TrafficUpdateEncoder {
+public:
+    // Dynamic values are reset to zero
+    void SetTemplate(const osi3::MovingObject& object, bool assignLane = false);
+    bool HasTemplate() const { return !m_template.empty(); }
+
+    void SetTimestamp(double time) { m_time = time; }
+    void SetPosition(double x, double y, double z) { Set(m_position, x, y, z); }
+    void SetOrientation(double roll, double pitch, double yaw) { Set(m_orientation, roll, pitch, yaw); }
+    void SetVelocity(double x, double y, double z) { Set(m_velocity, x, y, z); }
+    void SetAcceleration(double x, double y, double z) { Set(m_acceleration, x, y, z); }
+    // Only with a template made with assignLane
+    void SetAssignedLane(uint64_t laneId) { m_laneId = laneId; }
+
+    // Encodes the current values into an OSMP buffer
+    void Write(OsmpBuffer& out) const;
+
+private:
+    struct Triple {
+        size_t offset = 0;  // of the first double in the encoding
+        double v[3] = {0, 0, 0};
+    };
+    static void Set(Triple& t, double a, double b, double c) {
+        t.v[0] = a;
+        t.v[1] = b;
+        t.v[2] = c;
+    }
+    static void Patch(char* data, const Triple& t);
+
+    std::string m_template;
+    uint64_t m_contentId = 0;
+    size_t m_seconds = 0, m_nanos = 0;  // offsets of the padded varints
+    size_t m_laneOffsets[2] = {0, 0};   // 0 = no assigned lane patching
+    double m_time = 0.0;
+    uint64_t m_laneId = 0;
+    Triple m_position, m_orientation, m_velocity, m_acceleration;
+};
@@ -5,9 +5,30 @@
 #include <array>
 #include <iomanip>
 #include <chrono>
+#include <cmath>
+#include <set>
+#include <algorithm>
 #include "FmuHelper.h"
-#include "OsiHelper.h"
+#include "GroundTruthCache.h"
+#include "LaneLocator.h"
 #include "DemoConfiguration.h"
+#include "ConnectionGraph.h"
+#include "ControllerPlugin.h"
+#include "NativeTerrain.h"
+#include "NativeTire.h"
+#include "ObjectTable.h"
+#include "OsiArena.h"
+#include "OsiWireScanner.h"
+#include "OsmpBuffers.h"
+#include "ParallelExecutor.h"
+#include "SingleTrackVehicle.h"
+#include "PowerBond.h"
+#include "SensorModel.h"
+#include "SensorViewPruner.h"
+#include "SpatialGrid.h"
+#include "StepRecovery.h"
+#include "StopConditions.h"
+#include "TrafficUpdateEncoder.h"
 
 // OSI Ptrs
 #include "osi_sensorview.pb.h"
@@ -41,6 +62,21 @@ void GetQuatVariable(FmuHelper& fmu, const std::string& prefix, double* q) {
     fmu.GetVariable(prefix + ".e3", q[3]);
 }
 
+// Wheel variable prefixes of a vehicle FMU: every "<id>" that declares <id>.pos.x,
+// <id>.lin_vel.x and <id>.force.x, in modelDescription order
+std::vector<std::string> FindWheelIds(const FmuHelper& fmu) {
+    std::vector<std::string> names = fmu.GetVariableNames();
+    std::set<std::string> declared(names.begin(), names.end());
+    std::vector<std::string> ids;
+    const std::string marker = ".lin_vel.x";
+    for (const auto& n : names) {
+        if (n.size() <= marker.size() || n.compare(n.size() - marker.size(), marker.size(), marker) != 0) continue;
+        std::string id = n.substr(0, n.size() - marker.size());
+        if (declared.count(id + ".pos.x") && declared.count(id + ".force.x")) ids.push_back(id);
+    }
+    return ids;
+}
+
 int main(int argc, char* argv[]) {
     // -------------------------------------------------------------------------
     // Configuration
@@ -66,22 +102,61 @@ int main(int argc, char* argv[]) {
     };
 
     std::string esmini_fmu_file = get_abs_path("esmini.fmu_path");
-    std::string drivecontroller_fmu_file = get_abs_path("drivecontroller.fmu_path");
-    std::string vehicle_fmu_file = get_abs_path("vehicle.fmu_path");
-    std::string powertrain_fmu_file = get_abs_path("powertrain.fmu_path");
-    std::string tire_fmu_file = get_abs_path("tire.fmu_path");
-    std::string terrain_fmu_file = get_abs_path("terrain.fmu_path");
+    // "fmu": GT-DriveController FMU, "native": C++ controller plugin fed the decoded SensorView in process
+    std::string controller_backend = config.GetString("drivecontroller.backend", "fmu");
+    if (controller_backend != "fmu" && controller_backend != "native") {
+        std::cerr << "Error: Unknown drivecontroller.backend '" << controller_backend << "'" << std::endl;
+        return 1;
+    }
+    bool use_controller_fmu = controller_backend == "fmu";
+    std::string drivecontroller_fmu_file = use_controller_fmu ? get_abs_path("drivecontroller.fmu_path") : "";
+    // "chrono": Chrono vehicle / powertrain / tire / terrain FMUs, "single_track": in-process surrogate only,
+    // "compare": Chrono drives, the surrogate runs alongside on the same driver inputs
+    std::string vehicle_model = config.GetString("vehicle.model", "chrono");
+    if (vehicle_model != "chrono" && vehicle_model != "single_track" && vehicle_model != "compare") {
+        std::cerr << "Error: Unknown vehicle.model '" << vehicle_model << "'" << std::endl;
+        return 1;
+    }
+    bool use_chrono = vehicle_model != "single_track";
+    // Chrono FMU topology: "split" couples FMU2cs_WheeledVehicle and FMU2cs_Powertrain through the driveshaft
+    // every substep, "combined" runs FMU2cs_WheeledVehiclePtrain with the powertrain built in
+    std::string vehicle_topology = config.GetString("vehicle.topology", "split");
+    if (vehicle_topology != "split" && vehicle_topology != "combined") {
+        std::cerr << "Error: Unknown vehicle.topology '" << vehicle_topology << "'" << std::endl;
+        return 1;
+    }
+    bool use_powertrain_fmu = use_chrono && vehicle_topology == "split";
+    std::string vehicle_fmu_file = !use_chrono ? ""
+                                 : get_abs_path(use_powertrain_fmu ? "vehicle.fmu_path" : "vehicle.combined_fmu_path");
+    std::string powertrain_fmu_file = use_powertrain_fmu ? get_abs_path("powertrain.fmu_path") : "";
+    // "fmu": one Tire FMU per wheel, "native": in-process TMeasy for all wheels,
+    // "compare": FMUs drive the vehicle, the native model is evaluated alongside and compared
+    std::string tire_backend = config.GetString("tire.backend", "fmu");
+    if (tire_backend != "fmu" && tire_backend != "native" && tire_backend != "compare") {
+        std::cerr << "Error: Unknown tire.backend '" << tire_backend << "'" << std::endl;
+        return 1;
+    }
+    bool use_tire_fmus = use_chrono && tire_backend != "native";
+    std::string tire_fmu_file = use_tire_fmus ? get_abs_path("tire.fmu_path") : "";
+    // "fmu": one Terrain FMU per wheel, "native": in-process batched terrain query
+    std::string terrain_backend = config.GetString("terrain.backend", "fmu");
+    if (terrain_backend != "fmu" && terrain_backend != "native") {
+        std::cerr << "Error: Unknown terrain.backend '" << terrain_backend << "'" << std::endl;
+        return 1;
+    }
+    bool use_terrain_fmus = use_chrono && terrain_backend == "fmu";
+    std::string terrain_fmu_file = use_terrain_fmus ? get_abs_path("terrain.fmu_path") : "";
 
     // Check existence of critical FMUs
     if (!std::filesystem::exists(esmini_fmu_file)) {
         std::cerr << "Error: esmini FMU not found at " << esmini_fmu_file << std::endl;
         return 1;
     }
-    if (!std::filesystem::exists(drivecontroller_fmu_file)) {
+    if (use_controller_fmu && !std::filesystem::exists(drivecontroller_fmu_file)) {
         std::cerr << "Error: DriveController FMU not found at " << drivecontroller_fmu_file << std::endl;
         return 1;
     }
-    if (!std::filesystem::exists(vehicle_fmu_file)) {
+    if (use_chrono && !std::filesystem::exists(vehicle_fmu_file)) {
         std::cerr << "Error: Vehicle FMU not found at " << vehicle_fmu_file << std::endl;
         return 1;
     }
@@ -102,14 +177,43 @@ int main(int argc, char* argv[]) {
         std::string p_unpack = std::filesystem::absolute(config.GetString("powertrain.unpack_dir", "./tmp_powertrain")).string();
 
         ensure_dir(esmini_unpack);
-        ensure_dir(dc_unpack);
-        ensure_dir(v_unpack);
-        ensure_dir(p_unpack);
 
         FmuHelper esmini_fmu("EsminiFMU", esmini_fmu_file, esmini_unpack);
-        FmuHelper drivecontroller_fmu("DriveControllerFMU", drivecontroller_fmu_file, dc_unpack);
-        FmuHelper vehicle_fmu("WheeledVehicleFMU", vehicle_fmu_file, v_unpack);
-        FmuHelper powertrain_fmu("PowertrainFMU", powertrain_fmu_file, p_unpack);
+        std::unique_ptr<FmuHelper> drivecontroller_fmu;
+        std::unique_ptr<ControllerPlugin> controller_plugin;
+        if (use_controller_fmu) {
+            ensure_dir(dc_unpack);
+            drivecontroller_fmu = std::make_unique<FmuHelper>("DriveControllerFMU", drivecontroller_fmu_file, dc_unpack);
+        } else {
+            controller_plugin = ControllerPlugin::FromConfig(config, "drivecontroller");
+        }
+        std::unique_ptr<FmuHelper> vehicle_fmu, powertrain_fmu;
+        if (use_powertrain_fmu) {
+            ensure_dir(v_unpack);
+            ensure_dir(p_unpack);
+            vehicle_fmu = std::make_unique<FmuHelper>("WheeledVehicleFMU", vehicle_fmu_file, v_unpack);
+            powertrain_fmu = std::make_unique<FmuHelper>("PowertrainFMU", powertrain_fmu_file, p_unpack);
+        } else if (use_chrono) {
+            ensure_dir(v_unpack);
+            vehicle_fmu = std::make_unique<FmuHelper>("WheeledVehiclePtrainFMU", vehicle_fmu_file, v_unpack);
+        }
+
+        // Wheel topology: "vehicle.wheels" lists the wheel variable prefixes, otherwise they are
+        // discovered from the vehicle FMU. One tire / terrain slot per wheel.
+        std::vector<std::string> wheel_ids;
+        if (vehicle_fmu) {
+            auto wheels = config.Get("vehicle.wheels");
+            if (wheels.type == MiniJSON::Type::Array && !wheels.a_val.empty()) {
+                for (auto& w : wheels.a_val) wheel_ids.push_back(w.as_string());
+            } else {
+                wheel_ids = FindWheelIds(*vehicle_fmu);
+            }
+            if (wheel_ids.empty()) throw std::runtime_error("Vehicle FMU declares no wheels (set vehicle.wheels)");
+            std::cout << "[Vehicle] " << wheel_ids.size() << " wheels:";
+            for (auto& w : wheel_ids) std::cout << " " << w;
+            std::cout << std::endl;
+        }
+        int num_wheels = static_cast<int>(wheel_ids.size());
 
         std::vector<FmuHelper*> tires;
         std::vector<FmuHelper*> terrains;
@@ -117,26 +221,56 @@ int main(int argc, char* argv[]) {
         std::string t_prefix = config.GetString("tire.unpack_dir_prefix", "./tmp_tire_");
         std::string tr_prefix = config.GetString("terrain.unpack_dir_prefix", "./tmp_terrain_");
 
-        for(int i=0; i<4; ++i) {
+        for(int i=0; i<num_wheels; ++i) {
             std::string t_dir = std::filesystem::absolute(t_prefix + std::to_string(i)).string();
-            std::string tr_dir = std::filesystem::absolute(tr_prefix + std::to_string(i)).string();
-            ensure_dir(t_dir);
-            ensure_dir(tr_dir);
-            tires.push_back(new FmuHelper("TireFMU_" + std::to_string(i), tire_fmu_file, t_dir));
-            terrains.push_back(new FmuHelper("TerrainFMU_" + std::to_string(i), terrain_fmu_file, tr_dir));
+            if (use_tire_fmus) ensure_dir(t_dir);
+            if (use_tire_fmus) tires.push_back(new FmuHelper("TireFMU_" + std::to_string(i), tire_fmu_file, t_dir));
+            if (use_terrain_fmus) {
+                std::string tr_dir = std::filesystem::absolute(tr_prefix + std::to_string(i)).string();
+                ensure_dir(tr_dir);
+                terrains.push_back(new FmuHelper("TerrainFMU_" + std::to_string(i), terrain_fmu_file, tr_dir));
+            }
+        }
+
+        std::unique_ptr<NativeTerrain> native_terrain;
+        if (use_chrono && terrain_backend == "native") {
+            native_terrain = NativeTerrain::FromConfig(config, "terrain", "NativeTerrain", num_wheels);
+        }
+        std::unique_ptr<NativeTire> native_tire;
+        std::unique_ptr<TireComparison> tire_comparison;
+        if (use_chrono && tire_backend == "native") {
+            native_tire = NativeTire::FromConfig(config, "tire", "NativeTire", num_wheels);
+        } else if (use_chrono && tire_backend == "compare") {
+            tire_comparison = std::make_unique<TireComparison>(NativeTire::FromConfig(config, "tire", "NativeTire", num_wheels), tires,
+                                                               config.GetString("tire.native.compare_log", ""));
+        }
+
+        // Reduced-order vehicle in place of (single_track) or next to (compare) the Chrono group
+        std::unique_ptr<SingleTrackVehicle> surrogate;
+        std::unique_ptr<SurrogateComparison> surrogate_comparison;
+        if (vehicle_model == "single_track") {
+            surrogate = SingleTrackVehicle::FromConfig(config, "vehicle", "SingleTrackVehicle");
+        } else if (vehicle_model == "compare") {
+            surrogate_comparison = SurrogateComparison::FromConfig(config, "vehicle",
+                                                                   SingleTrackVehicle::FromConfig(config, "vehicle", "SingleTrackVehicle"));
         }
 
         std::cout << "Instantiating esmini FMU..." << std::endl;
         esmini_fmu.Instantiate();
         
-        std::cout << "Instantiating DriveController FMU..." << std::endl;
-        drivecontroller_fmu.Instantiate();
-        
-        std::cout << "Instantiating Vehicle FMU..." << std::endl;
-        vehicle_fmu.Instantiate();
+        if (drivecontroller_fmu) {
+            std::cout << "Instantiating DriveController FMU..." << std::endl;
+            drivecontroller_fmu->Instantiate();
+        }
         
-        std::cout << "Instantiating Powertrain FMU..." << std::endl;
-        powertrain_fmu.Instantiate();
+        if (vehicle_fmu) {
+            std::cout << "Instantiating Vehicle FMU..." << std::endl;
+            vehicle_fmu->Instantiate();
+        }
+        if (powertrain_fmu) {
+            std::cout << "Instantiating Powertrain FMU..." << std::endl;
+            powertrain_fmu->Instantiate();
+        }
         
         std::cout << "Instantiating Tire FMUs..." << std::endl;
         for(auto t : tires) t->Instantiate();
@@ -198,27 +332,26 @@ int main(int argc, char* argv[]) {
         double initial_rot[3] = {0,0,0}; // roll, pitch, yaw
         bool found_ego = false;
 
+        SensorViewScan sv_scan; // Reused for every selective SensorView decode below
+        ObjectTable objects;    // Moving objects of the last decoded view
         if (sv_sz > 0) {
             void* ptr = DecodeOSMPPointer(sv_lo, sv_hi);
-            osi3::SensorView sv;
-            if (sv.ParseFromArray(ptr, sv_sz)) {
-                if (sv.has_global_ground_truth() && sv.global_ground_truth().moving_object_size() > 0) {
-                     // As per user request: Use the first moving object
-                     const auto& obj = sv.global_ground_truth().moving_object(0);
-                     if (obj.has_base()) {
-                         initial_pos[0] = obj.base().position().x();
-                         initial_pos[1] = obj.base().position().y();
-                         initial_pos[2] = obj.base().position().z();
-                         
-                         initial_rot[0] = obj.base().orientation().roll();
-                         initial_rot[1] = obj.base().orientation().pitch();
-                         initial_rot[2] = obj.base().orientation().yaw();
-                         
-                         std::cout << "[Scenario Init] Found Ego Initial State: Pos(" 
-                                   << initial_pos[0] << ", " << initial_pos[1] << ", " << initial_pos[2] << ") "
-                                   << "Rot(" << initial_rot[0] << ", " << initial_rot[1] << ", " << initial_rot[2] << ")" << std::endl;
-                         found_ego = true;
-                     }
+            if (ScanSensorView(ptr, sv_sz, sv_scan)) {
+                objects.Build(sv_scan);
+                // host_vehicle_id, else the first moving object
+                uint32_t row = objects.EgoRow();
+                if (row != ObjectTable::kNoRow) {
+                     initial_pos[0] = objects.x[row];
+                     initial_pos[1] = objects.y[row];
+                     initial_pos[2] = objects.z[row];
+                     initial_rot[0] = objects.roll[row];
+                     initial_rot[1] = objects.pitch[row];
+                     initial_rot[2] = objects.yaw[row];
+                     
+                     std::cout << "[Scenario Init] Found Ego Initial State: Pos(" 
+                               << initial_pos[0] << ", " << initial_pos[1] << ", " << initial_pos[2] << ") "
+                               << "Rot(" << initial_rot[0] << ", " << initial_rot[1] << ", " << initial_rot[2] << ")" << std::endl;
+                     found_ego = true;
                 }
             } else {
                  std::cerr << "[Error] Failed to parse initial OSI SensorView!" << std::endl;
@@ -232,8 +365,8 @@ int main(int argc, char* argv[]) {
         // ---------------------------------------------------------------------
         std::cout << "Setting up parameters for other FMUs..." << std::endl;
         
-        auto set_params_from_config = [&](FmuHelper& fmu, const std::string& config_root) {
-            fmu.SetVariable("step_size", config.GetDouble(config_root + ".parameters.step_size", step_size));
+        auto set_params_from_config = [&](FmuHelper& fmu, const std::string& config_root, bool set_step_size = true) {
+            if (set_step_size) fmu.SetVariable("step_size", config.GetDouble(config_root + ".parameters.step_size", step_size));
 
             auto val = config.Get(config_root + ".parameters");
             if (val.type == MiniJSON::Type::Object) {
@@ -256,9 +389,11 @@ int main(int argc, char* argv[]) {
         };
 
         // set_params_from_config(esmini_fmu, "esmini"); // Already done
-        set_params_from_config(drivecontroller_fmu, "drivecontroller");
-        set_params_from_config(vehicle_fmu, "vehicle");
-        set_params_from_config(powertrain_fmu, "powertrain");
+        if (drivecontroller_fmu) set_params_from_config(*drivecontroller_fmu, "drivecontroller");
+        if (vehicle_fmu) set_params_from_config(*vehicle_fmu, "vehicle");
+        if (powertrain_fmu) set_params_from_config(*powertrain_fmu, "powertrain");
+        // Combined topology: engine / transmission parameters are routed to the vehicle FMU
+        else if (vehicle_fmu) set_params_from_config(*vehicle_fmu, "powertrain", false);
 
         for(auto t : tires) set_params_from_config(*t, "tire");
         for(auto t : terrains) set_params_from_config(*t, "terrain");
@@ -269,10 +404,16 @@ int main(int argc, char* argv[]) {
              std::cout << "  Position: " << initial_pos[0] << ", " << initial_pos[1] << ", " << initial_pos[2] << std::endl;
              std::cout << "  Yaw:      " << initial_rot[2] << std::endl;
 
-             vehicle_fmu.SetVariable("init_loc.x", initial_pos[0]);
-             vehicle_fmu.SetVariable("init_loc.y", initial_pos[1]);
-             vehicle_fmu.SetVariable("init_loc.z", initial_pos[2]);
-             vehicle_fmu.SetVariable("init_yaw", initial_rot[2]); 
+             if (vehicle_fmu) {
+                 vehicle_fmu->SetVariable("init_loc.x", initial_pos[0]);
+                 vehicle_fmu->SetVariable("init_loc.y", initial_pos[1]);
+                 vehicle_fmu->SetVariable("init_loc.z", initial_pos[2]);
+                 vehicle_fmu->SetVariable("init_yaw", initial_rot[2]);
+             } else {
+                 double init_speed = config.GetDouble("vehicle.parameters.init_speed", 0.0);
+                 double init_vel[3] = {init_speed * std::cos(initial_rot[2]), init_speed * std::sin(initial_rot[2]), 0.0};
+                 surrogate->SetState(initial_pos, initial_rot[2], init_vel, 0.0);
+             }
         }
 
         // ---------------------------------------------------------------------
@@ -282,29 +423,45 @@ int main(int argc, char* argv[]) {
         
         // Esmini is skipped here because it was initialized earlier.
 
-        drivecontroller_fmu.SetupExperiment(start_time, t_end);
-        vehicle_fmu.SetupExperiment(start_time, t_end);
-        powertrain_fmu.SetupExperiment(start_time, t_end);
+        if (drivecontroller_fmu) drivecontroller_fmu->SetupExperiment(start_time, t_end);
+        if (vehicle_fmu) vehicle_fmu->SetupExperiment(start_time, t_end);
+        if (powertrain_fmu) powertrain_fmu->SetupExperiment(start_time, t_end);
         for(auto t : tires) t->SetupExperiment(start_time, t_end);
         for(auto t : terrains) t->SetupExperiment(start_time, t_end);
 
-        drivecontroller_fmu.EnterInitializationMode();
-        vehicle_fmu.EnterInitializationMode();
-        powertrain_fmu.EnterInitializationMode();
+        if (drivecontroller_fmu) drivecontroller_fmu->EnterInitializationMode();
+        if (vehicle_fmu) vehicle_fmu->EnterInitializationMode();
+        if (powertrain_fmu) powertrain_fmu->EnterInitializationMode();
         for(auto t : tires) t->EnterInitializationMode();
         for(auto t : terrains) t->EnterInitializationMode();
         
-        drivecontroller_fmu.ExitInitializationMode();
-        vehicle_fmu.ExitInitializationMode();
-        powertrain_fmu.ExitInitializationMode();
+        if (drivecontroller_fmu) drivecontroller_fmu->ExitInitializationMode();
+        if (vehicle_fmu) vehicle_fmu->ExitInitializationMode();
+        if (powertrain_fmu) powertrain_fmu->ExitInitializationMode();
         for(auto t : tires) t->ExitInitializationMode();
         for(auto t : terrains) t->ExitInitializationMode();
         std::cout << "[DEBUG] All init done." << std::endl;
 
+        // Chassis reference frame of the vehicle model that drives the scenario
+        auto get_ref_frame = [&](double* pos, double* rot, double* pos_dt) {
+            if (vehicle_fmu) {
+                GetVecVariable(*vehicle_fmu, "ref_frame.pos", pos);
+                GetQuatVariable(*vehicle_fmu, "ref_frame.rot", rot);
+                GetVecVariable(*vehicle_fmu, "ref_frame.pos_dt", pos_dt);
+                return;
+            }
+            static const char* axes[3] = {"x", "y", "z"};
+            for (int k = 0; k < 3; ++k) {
+                pos[k] = *surrogate->GetOutput(std::string("ref_frame.pos.") + axes[k]);
+                pos_dt[k] = *surrogate->GetOutput(std::string("ref_frame.pos_dt.") + axes[k]);
+            }
+            for (int k = 0; k < 4; ++k) rot[k] = *surrogate->GetOutput("ref_frame.rot.e" + std::to_string(k));
+        };
+
         // [Post-Init Check] Read back the specific coordinates to verify override
-        double init_check_pos[3];
-        GetVecVariable(vehicle_fmu, "ref_frame.pos", init_check_pos);
-        std::cout << "[Chrono Init Result] Pos: (" 
+        double init_check_pos[3], init_check_rot[4], init_check_pos_dt[3];
+        get_ref_frame(init_check_pos, init_check_rot, init_check_pos_dt);
+        std::cout << (vehicle_fmu ? "[Chrono Init Result] Pos: (" : "[Single-Track Init Result] Pos: (") 
                   << init_check_pos[0] << ", " 
                   << init_check_pos[1] << ", " 
                   << init_check_pos[2] << ")" << std::endl;
@@ -317,18 +474,220 @@ int main(int argc, char* argv[]) {
         std::cout << std::string(80, '=') << std::endl;
         
         double time = start_time;
-        std::string wheel_ids[4] = {"wheel_FL", "wheel_FR", "wheel_RL", "wheel_RR"};
         int step_count = 0;
 
+        // Parallel stepping of the Chrono group (esmini / DriveController stay on this thread)
+        ParallelExecutor executor(ParallelOptions::FromConfig(config, "simulation.parallel"));
+        double stage_time = 0.0;
+        double stage_step = 0.0;
+
+        // Power-bond energy monitoring / correction (coupling.energy_correction)
+        // (only between Chrono FMUs; the surrogate has no bonds)
+        auto driveshaft_bond = use_powertrain_fmu ? PowerBond::FromConfig(config, "coupling.energy_correction", "powertrain_vehicle", "driveshaft", 1)
+                                                  : nullptr;
+        std::vector<std::unique_ptr<PowerBond>> wheel_bonds;
+        for (int i = 0; i < num_wheels; ++i) {
+            auto bond = PowerBond::FromConfig(config, "coupling.energy_correction", "tire_vehicle", wheel_ids[i], 3);
+            if (bond) wheel_bonds.push_back(std::move(bond));
+        }
+
+        std::ofstream energy_log;
+        std::string energy_log_path = config.GetString("coupling.energy_log", "");
+        if (!energy_log_path.empty() && (driveshaft_bond || !wheel_bonds.empty())) {
+            energy_log.open(energy_log_path);
+            energy_log << "time";
+            if (driveshaft_bond) energy_log << "," << driveshaft_bond->GetName() << "_residual," << driveshaft_bond->GetName() << "_raw";
+            for (auto& b : wheel_bonds) energy_log << "," << b->GetName() << "_residual," << b->GetName() << "_raw";
+            energy_log << std::endl;
+        }
+
+        auto print_energy = [&](const char* tag) {
+            if (driveshaft_bond) {
+                std::cout << tag << " " << driveshaft_bond->GetName() << ": residual=" << driveshaft_bond->GetResidual()
+                          << " J raw=" << driveshaft_bond->GetTotalResidual() << " J transferred=" << driveshaft_bond->GetTransferred() << " J" << std::endl;
+            }
+            for (auto& b : wheel_bonds) {
+                std::cout << tag << " " << b->GetName() << ": residual=" << b->GetResidual()
+                          << " J raw=" << b->GetTotalResidual() << " J transferred=" << b->GetTransferred() << " J" << std::endl;
+            }
+        };
+
+        // Connection graph of the Chrono group; the exchange order and the
+        // parallel stages are derived from it once (simulation.schedule)
+        auto vec = [](const std::string& p) { return std::vector<std::string>{p + ".x", p + ".y", p + ".z"}; };
+        auto quat = [](const std::string& p) { return std::vector<std::string>{p + ".e0", p + ".e1", p + ".e2", p + ".e3"}; };
+        auto cat = [](std::initializer_list<std::vector<std::string>> parts) {
+            std::vector<std::string> all;
+            for (auto& part : parts) all.insert(all.end(), part.begin(), part.end());
+            return all;
+        };
+
+        ConnectionGraph graph;
+        int vehicle_node = vehicle_fmu ? graph.AddInstance(vehicle_fmu.get(), "vehicle") : graph.AddInstance(surrogate.get(), "vehicle");
+        int powertrain_node = powertrain_fmu ? graph.AddInstance(powertrain_fmu.get(), "powertrain") : -1;
+        std::vector<int> tire_nodes, terrain_nodes;
+        for (auto t : tires) tire_nodes.push_back(graph.AddInstance(t, "tire"));
+        int native_tire_node = native_tire ? graph.AddInstance(native_tire.get(), "tire") : -1;
+        for (auto t : terrains) terrain_nodes.push_back(graph.AddInstance(t, "terrain"));
+        int native_terrain_node = native_terrain ? graph.AddInstance(native_terrain.get(), "terrain") : -1;
+
+        if (powertrain_fmu) {
+            int driveshaft_torque = graph.AddConnection(powertrain_node, vehicle_node, "powertrain_vehicle",
+                                                        {"driveshaft_torque"}, {"driveshaft_torque"});
+            graph.AddConnection(vehicle_node, powertrain_node, "vehicle_powertrain", {"driveshaft_speed"}, {"driveshaft_speed"});
+            if (driveshaft_bond) {
+                graph.SetFilter(driveshaft_torque, [&](double* torque) {
+                    double speed;
+                    vehicle_fmu->GetVariable("driveshaft_speed", speed);
+                    driveshaft_bond->Exchange(torque, &speed, stage_step, torque);
+                });
+            }
+        }
+
+        for (int i = 0; i < num_wheels; ++i) {
+            const std::string& w = wheel_ids[i];
+            // The native tire serves all wheels; its variables carry the wheel index as suffix
+            int tire_node = native_tire ? native_tire_node : tire_nodes[i];
+            std::string ts = native_tire ? "_" + std::to_string(i) : "";
+            int wheel_state = graph.AddConnection(vehicle_node, tire_node, "vehicle_tire",
+                                cat({vec(w + ".pos"), quat(w + ".rot"), vec(w + ".lin_vel"), vec(w + ".ang_vel")}),
+                                cat({vec("wheel_state" + ts + ".pos"), quat("wheel_state" + ts + ".rot"),
+                                     vec("wheel_state" + ts + ".lin_vel"), vec("wheel_state" + ts + ".ang_vel")}));
+            int wheel_load = graph.AddConnection(tire_node, vehicle_node, "tire_vehicle",
+                                cat({vec("wheel_load" + ts + ".point"), vec("wheel_load" + ts + ".force"), vec("wheel_load" + ts + ".moment")}),
+                                cat({vec(w + ".point"), vec(w + ".force"), vec(w + ".moment")}));
+            std::vector<std::string> tire_terrain_in = cat({{"terrain_height" + ts, "terrain_mu" + ts}, vec("terrain_normal" + ts)});
+            int terrain_tire;
+            if (native_terrain) {
+                // One terrain component answers all wheels; wheel i uses query slot i
+                std::string k = std::to_string(i);
+                graph.AddConnection(tire_node, native_terrain_node, "tire_terrain", vec("query_point" + ts), vec("query_point_" + k));
+                terrain_tire = graph.AddConnection(native_terrain_node, tire_node, "terrain_tire",
+                                    cat({{"height_" + k, "mu_" + k}, vec("normal_" + k)}), tire_terrain_in);
+            } else {
+                graph.AddConnection(tire_node, terrain_nodes[i], "tire_terrain", vec("query_point" + ts), vec("query_point"));
+                terrain_tire = graph.AddConnection(terrain_nodes[i], tire_node, "terrain_tire",
+                                    cat({{"height", "mu"}, vec("normal")}), tire_terrain_in);
+            }
+
+            if (tire_comparison) {
+                // Feed the native model exactly what Tire FMU i receives
+                graph.SetFilter(wheel_state, [&, i](double* state) { tire_comparison->SetWheelState(i, state); });
+                graph.SetFilter(terrain_tire, [&, i](double* terrain) { tire_comparison->SetTerrain(i, terrain); });
+            }
+
+            if (!wheel_bonds.empty()) {
+                // values: point[3], force[3], moment[3]
+                graph.SetFilter(wheel_load, [&, i](double* load) {
+                    double w_lin_vel[3];
+                    GetVecVariable(*vehicle_fmu, wheel_ids[i] + ".lin_vel", w_lin_vel);
+                    wheel_bonds[i]->Exchange(load + 3, w_lin_vel, stage_step, load + 3);
+                });
+            }
+        }
+
+        graph.Build(ScheduleOptions::FromConfig(config, "simulation.schedule"));
+        graph.PrintSchedule();
+        graph.SetMemoization(MemoOptions::FromConfig(config, "simulation.memoization"));
+
+        // Stage tasks are built once; they read the current substep time from stage_time/stage_step
+        std::vector<fmi2_status_t> chrono_status(graph.GetInstanceCount(), fmi2_status_ok);
+        std::vector<std::vector<ParallelExecutor::Task>> chrono_stages;
+        for (auto& stage : graph.GetStages()) {
+            // Members of a stage (e.g. the tires of all wheels) are spread evenly over the workers
+            std::vector<ParallelExecutor::Task> tasks;
+            int slot = 0;
+            for (int node : stage) {
+                tasks.push_back({executor.AssignWorker(graph.GetName(node), slot++), [&, node] {
+                    chrono_status[node] = graph.DoStep(node, stage_time, stage_step);
+                }});
+            }
+            chrono_stages.push_back(std::move(tasks));
+        }
+
+        // One Chrono substep: exchange + DoStep of every stage in schedule order.
+        // Wrapped so that StepRecovery can re-run the macro step when a member rejects a substep.
+        auto chrono_substep = [&](double t, double h) -> StepRecovery::Result {
+            stage_time = t;
+            stage_step = h;
+            for (size_t s = 0; s < chrono_stages.size(); ++s) {
+                for (int node : graph.GetStages()[s]) graph.PullInputs(node);
+                executor.RunStage(chrono_stages[s]);
+            }
+            if (tire_comparison) tire_comparison->Compare(t + h);
+
+            // Report every member that rejected the substep
+            StepRecovery::Result result;
+            for (int node = 0; node < graph.GetInstanceCount(); ++node) {
+                result.Report(chrono_status[node], graph.GetFmu(node));  // nullptr for native components
+            }
+            return result;
+        };
+
+        std::vector<FmuHelper*> chrono_members;
+        if (vehicle_fmu) chrono_members.push_back(vehicle_fmu.get());
+        if (powertrain_fmu) chrono_members.push_back(powertrain_fmu.get());
+        for (auto t : tires) chrono_members.push_back(t);
+        for (auto t : terrains) chrono_members.push_back(t);
+        StepRecovery chrono_recovery("Chrono", chrono_members, chrono_substep,
+                                     StepRecovery::FromConfig(config, "simulation.step_recovery"));
+        // The bonds' bookkeeping is rolled back with the FMUs, so that a re-run interval is not counted twice
+        std::vector<PowerBond*> bonds;
+        if (driveshaft_bond) bonds.push_back(driveshaft_bond.get());
+        for (auto& b : wheel_bonds) bonds.push_back(b.get());
+        for (PowerBond* bond : bonds) {
+            chrono_recovery.AddHostState([bond] { bond->SaveState(); }, [bond] { bond->RestoreState(); });
+        }
+        bool aborted = false;
+
+        // Early termination (simulation.stop_conditions)
+        StopConditions stop_conditions;
+        int sig_time = stop_conditions.AddSignal("time");
+        int sig_speed = stop_conditions.AddSignal("speed");
+        int sig_pos_x = stop_conditions.AddSignal("pos.x");
+        int sig_pos_y = stop_conditions.AddSignal("pos.y");
+        int sig_pos_z = stop_conditions.AddSignal("pos.z");
+        int sig_yaw = stop_conditions.AddSignal("yaw");
+        int sig_accel_long = stop_conditions.AddSignal("accel_long");
+        int sig_accel_lat = stop_conditions.AddSignal("accel_lat");
+        int sig_throttle = stop_conditions.AddSignal("throttle");
+        int sig_brake = stop_conditions.AddSignal("brake");
+        int sig_steering = stop_conditions.AddSignal("steering");
+        int sig_lane_s = stop_conditions.AddSignal("lane.s");
+        int sig_lane_t = stop_conditions.AddSignal("lane.t");
+        int sig_lane_heading = stop_conditions.AddSignal("lane.heading_error");
+        stop_conditions.Compile(config, "simulation.stop_conditions");
+        // Proximity queries over esmini's objects (collision candidates)
+        SpatialGrid scene_grid(SpatialGrid::Options::FromConfig(config, "simulation.spatial_grid"));
+        double prev_vel[2] = {0.0, 0.0};
+        bool has_prev_vel = false;
+
         // [Feedback] State variables
-        osi3::TrafficUpdate current_tu;
+        // Per-step OSI messages (SensorView / GroundTruth decodes) live on this arena
+        OsiArena osi_arena(OsiArena::Options::FromConfig(config, "simulation.osi_arena"));
+        // Map sections of the SensorView are decoded once for the native controller
+        GroundTruthCache gt_cache(GroundTruthCache::Options::FromConfig(config, "simulation.ground_truth_cache"));
+        // Optional range / FOV / field pruning of the view the DriveController FMU decodes
+        SensorViewPruner dc_pruner(SensorViewPruner::Options::FromConfig(config, "drivecontroller.pruning"));
+        // Idealized sensors feeding the native controller; their tasks run on the worker pool
+        SensorModel sensor_model(SensorModel::Options::FromConfig(config, "drivecontroller.sensors"), executor);
+        if (sensor_model.IsEnabled() && !controller_plugin) {
+            std::cout << "[Sensor] Sensors are only evaluated for the native controller backend" << std::endl;
+        }
+        // Chrono ego position on esmini's lanes (assigned lane of the TrafficUpdate, lane.* signals)
+        LaneLocator lane_locator(LaneLocator::Options::FromConfig(config, "simulation.lane_localization"));
         osi3::MovingObject stored_ego_obj; // Template object
-        std::string tu_buffer;
-        tu_buffer.reserve(64000); 
+        TrafficUpdateEncoder tu_encoder; // Ego TrafficUpdate, patched in place every step
+        // esmini may read a TrafficUpdate until its DoStep returns; never rewrite a buffer before that
+        OsmpBufferRing tu_buffers("esmini TrafficUpdate", static_cast<size_t>(config.GetDouble("simulation.osmp_buffer_depth", 2)));
+        double tu_prev_vel[3] = {0.0, 0.0, 0.0};
+        bool has_tu_prev_vel = false;
         bool ego_found_in_dc = false;
     uint64_t found_ego_id = 0; // Store detected ID
 
         while (time < t_end) {
+            osi_arena.BeginStep();
+
             // --- esmini -> DriveController (OSI SensorView) ---
             int osi_sv_lo, osi_sv_hi, osi_sv_size;
             esmini_fmu.GetVariable("OSMPSensorViewOut.base.lo", osi_sv_lo);
@@ -337,173 +696,175 @@ int main(int argc, char* argv[]) {
 
             std::cout << "[DEBUG] Step " << time << ": OSI size=" << osi_sv_size << std::endl;
 
-            // Direct pointer transfer (same process)
-            drivecontroller_fmu.SetVariable("OSI_SensorView_In_BaseLo", osi_sv_lo);
-            drivecontroller_fmu.SetVariable("OSI_SensorView_In_BaseHi", osi_sv_hi);
-            drivecontroller_fmu.SetVariable("OSI_SensorView_In_Size", osi_sv_size);
-
-            // Debug: Decode pointer to verify (optional)
-            if (osi_sv_size > 0 && step_count % 100 == 0) {
-                void* osi_ptr = DecodeOSMPPointer(osi_sv_lo, osi_sv_hi);
-                std::cout << "[DEBUG] OSI SensorView pointer: " << osi_ptr 
-                          << ", size: " << osi_sv_size << " bytes" << std::endl;
+            // Without a native controller the map is split out only for the lane locator
+            if (!controller_plugin && lane_locator.IsEnabled() && osi_sv_size > 0) {
+                gt_cache.Split(DecodeOSMPPointer(osi_sv_lo, osi_sv_hi), osi_sv_size, osi_arena);
             }
 
-            // --- Step DriveController ---
-            std::cerr << "[TRACE] Stepping DriveController..." << std::endl;
-            if(drivecontroller_fmu.DoStep(time, step_size) != fmi2_status_ok) {
-                std::cerr << "DriveController FMU step failed at time " << time << std::endl;
-                break;
-            }
-            std::cout << "[DEBUG] DriveController Step OK" << std::endl;
+            double throttle = 0.0, brake = 0.0, steering = 0.0;
+            if (controller_plugin) {
+                // Decode the dynamic part once; the plugin reads the message in place and gets
+                // the cached static ground truth next to it. An undecodable view is passed on empty.
+                osi3::SensorView* controller_sv = osi_sv_size > 0
+                    ? gt_cache.Split(DecodeOSMPPointer(osi_sv_lo, osi_sv_hi), osi_sv_size, osi_arena) : nullptr;
+                if (!controller_sv) controller_sv = osi_arena.New<osi3::SensorView>();
+                const osi3::GroundTruth& sv_gt = controller_sv->global_ground_truth();
+                objects.Build(*controller_sv); // rows follow moving_object order
+                // Stationary objects are part of the cached map; re-indexed only when it changes
+                if (gt_cache.Static().groundTruth) {
+                    scene_grid.SetStationary(*gt_cache.Static().groundTruth, gt_cache.Static().generation);
+                }
+
+                // [Feedback] 1. Identify Ego: host_vehicle_id, else the first moving object (like the DC FMU)
+                if (!ego_found_in_dc && objects.EgoRow() != ObjectTable::kNoRow) {
+                    stored_ego_obj.CopyFrom(sv_gt.moving_object(static_cast<int>(objects.EgoRow())));
+                    found_ego_id = objects.id[objects.EgoRow()];
+                    std::cout << "[Feedback] Found Ego ID from SensorView: " << found_ego_id << std::endl;
+                    ego_found_in_dc = true;
+                }
+
+                ControllerEgoState ego;
+                ego.id = found_ego_id;
+                uint32_t ego_row = ego_found_in_dc ? objects.Find(found_ego_id) : ObjectTable::kNoRow;
+                if (ego_row != ObjectTable::kNoRow) ego.object = &sv_gt.moving_object(static_cast<int>(ego_row));
+                get_ref_frame(ego.pos, ego.rot, ego.posDt);
+                ego.yaw = std::atan2(2.0 * (ego.rot[0] * ego.rot[3] + ego.rot[1] * ego.rot[2]),
+                                     1.0 - 2.0 * (ego.rot[2] * ego.rot[2] + ego.rot[3] * ego.rot[3]));
+                ego.speed = std::hypot(ego.posDt[0], ego.posDt[1]);
+                if (sensor_model.IsEnabled()) sensor_model.Run(time, objects, ego_row, ego);
+
+                ControlCommand command;
+                if (!controller_plugin->Step(time, step_size, *controller_sv, gt_cache.Static(), sensor_model.Data(), ego,
+                                             command)) {
+                    std::cerr << "Native controller step failed at time " << time << std::endl;
+                    break;
+                }
+                throttle = command.throttle;
+                brake = command.brake;
+                steering = command.steering;
+            } else {
+                // Direct pointer transfer (same process), or a pruned copy of the view
+                OsmpPointer dc_in{osi_sv_lo, osi_sv_hi, osi_sv_size};
+                if (dc_pruner.IsEnabled() && osi_sv_size > 0) {
+                    dc_in = dc_pruner.Prune(DecodeOSMPPointer(osi_sv_lo, osi_sv_hi), osi_sv_size);
+                }
+                drivecontroller_fmu->SetVariable("OSI_SensorView_In_BaseLo", dc_in.lo);
+                drivecontroller_fmu->SetVariable("OSI_SensorView_In_BaseHi", dc_in.hi);
+                drivecontroller_fmu->SetVariable("OSI_SensorView_In_Size", dc_in.size);
+
+                // Debug: Decode pointer to verify (optional)
+                if (dc_in.size > 0 && step_count % 100 == 0) {
+                    void* osi_ptr = DecodeOSMPPointer(dc_in.lo, dc_in.hi);
+                    std::cout << "[DEBUG] OSI SensorView pointer: " << osi_ptr 
+                              << ", size: " << dc_in.size << " bytes" << std::endl;
+                }
 
-            std::cout << "[DEBUG] DriveController Step OK" << std::endl;
+                // --- Step DriveController ---
+                std::cerr << "[TRACE] Stepping DriveController..." << std::endl;
+                if(drivecontroller_fmu->DoStep(time, step_size) != fmi2_status_ok) {
+                    std::cerr << "DriveController FMU step failed at time " << time << std::endl;
+                    break;
+                }
+                std::cout << "[DEBUG] DriveController Step OK" << std::endl;
 
-            // [Feedback] 1. Identify Ego from DC Output
-            if (!ego_found_in_dc) {
-                int dc_sv_lo=0, dc_sv_hi=0, dc_sv_sz=0;
-                // Note: Assuming these variables exist on the FMU based on user instruction
-                drivecontroller_fmu.GetVariable("OSI_SensorView_Out_BaseLo", dc_sv_lo);
-                drivecontroller_fmu.GetVariable("OSI_SensorView_Out_BaseHi", dc_sv_hi);
-                drivecontroller_fmu.GetVariable("OSI_SensorView_Out_Size", dc_sv_sz);
+                std::cout << "[DEBUG] DriveController Step OK" << std::endl;
+
+                // [Feedback] 1. Identify Ego from DC Output
+                if (!ego_found_in_dc) {
+                    int dc_sv_lo=0, dc_sv_hi=0, dc_sv_sz=0;
+                    // Note: Assuming these variables exist on the FMU based on user instruction
+                    drivecontroller_fmu->GetVariable("OSI_SensorView_Out_BaseLo", dc_sv_lo);
+                    drivecontroller_fmu->GetVariable("OSI_SensorView_Out_BaseHi", dc_sv_hi);
+                    drivecontroller_fmu->GetVariable("OSI_SensorView_Out_Size", dc_sv_sz);
                 
-                if (dc_sv_sz > 0) {
-                    void* ptr = DecodeOSMPPointer(dc_sv_lo, dc_sv_hi);
-                    osi3::SensorView dc_sv;
-                    // Use ParseFromArray with caution on pointer validity
-                    if (dc_sv.ParseFromArray(ptr, dc_sv_sz)) {
-                        if (dc_sv.has_global_ground_truth() && dc_sv.global_ground_truth().moving_object_size() > 0) {
-                            const auto& ego_obj = dc_sv.global_ground_truth().moving_object(0);
-                            // Copy ID and Object to TrafficUpdate (Base for updates)
-                            stored_ego_obj.CopyFrom(ego_obj); // [RESTORED] Copy useful metadata
-                            found_ego_id = ego_obj.id().value();
-                            // copy to current_tu for consistency/logging if needed, though cleared downstream
-                            current_tu.add_update()->CopyFrom(ego_obj); 
-                            found_ego_id = ego_obj.id().value();
-                            std::cout << "[Feedback] Found Ego ID from DC: " << ego_obj.id().value() << std::endl;
-                            ego_found_in_dc = true;
+                    if (dc_sv_sz > 0) {
+                        void* ptr = DecodeOSMPPointer(dc_sv_lo, dc_sv_hi);
+                        // Only the ego object is decoded; lanes and the other objects are skipped
+                        if (ScanSensorView(ptr, dc_sv_sz, sv_scan)) {
+                            objects.Build(sv_scan);
+                            if (objects.EgoRow() != ObjectTable::kNoRow) {
+                                const ScannedObject& ego_obj = sv_scan.movingObjects[objects.EgoRow()];
+                                // Copy ID and Object to TrafficUpdate (Base for updates)
+                                if (stored_ego_obj.ParseFromArray(ego_obj.data, static_cast<int>(ego_obj.size))) { // [RESTORED] Copy useful metadata
+                                    found_ego_id = ego_obj.id;
+                                    std::cout << "[Feedback] Found Ego ID from DC: " << ego_obj.id << std::endl;
+                                    ego_found_in_dc = true;
+                                }
+                            }
                         }
                     }
                 }
-            }
 
-            // --- DriveController -> Vehicle (Control Inputs) ---
-            double throttle, brake, steering;
-            // std::cout << "[DEBUG] Getting DriveController outputs..." << std::endl;
-            drivecontroller_fmu.GetVariable("Throttle", throttle);
-            drivecontroller_fmu.GetVariable("Brake", brake);
-            drivecontroller_fmu.GetVariable("Steering", steering);
-            // std::cout << "[DEBUG] Outputs: T=" << throttle << " B=" << brake << " S=" << steering << std::endl;
+                // The DC output view (read above) may alias its input
+                dc_pruner.Release();
+
+                // --- DriveController -> Vehicle (Control Inputs) ---
+                // std::cout << "[DEBUG] Getting DriveController outputs..." << std::endl;
+                drivecontroller_fmu->GetVariable("Throttle", throttle);
+                drivecontroller_fmu->GetVariable("Brake", brake);
+                drivecontroller_fmu->GetVariable("Steering", steering);
+                // std::cout << "[DEBUG] Outputs: T=" << throttle << " B=" << brake << " S=" << steering << std::endl;
+            }
 
             // std::cout << "[DEBUG] Setting Vehicle inputs..." << std::endl;
-            vehicle_fmu.SetVariable("steering", steering);
-            vehicle_fmu.SetVariable("throttle", throttle);
-            vehicle_fmu.SetVariable("braking", brake);
-            powertrain_fmu.SetVariable("throttle", throttle);
+            if (vehicle_fmu) {
+                vehicle_fmu->SetVariable("steering", steering);
+                vehicle_fmu->SetVariable("throttle", throttle);
+                vehicle_fmu->SetVariable("braking", brake);
+                if (powertrain_fmu) powertrain_fmu->SetVariable("throttle", throttle);
+            } else {
+                surrogate->SetInputs(throttle, brake, steering);
+            }
             // std::cout << "[DEBUG] Vehicle inputs set." << std::endl;
 
             // --- Chrono Co-simulation (Sub-stepping) ---
-            double chrono_step_size = step_size / chrono_substeps;
-            double current_chrono_time = time;
-
-            for (int sub = 0; sub < chrono_substeps; ++sub) {
-                // Powertrain <-> Vehicle
-                double driveshaft_torque, driveshaft_speed;
-                powertrain_fmu.GetVariable("driveshaft_torque", driveshaft_torque);
-                vehicle_fmu.SetVariable("driveshaft_torque", driveshaft_torque);
-
-                vehicle_fmu.GetVariable("driveshaft_speed", driveshaft_speed);
-                powertrain_fmu.SetVariable("driveshaft_speed", driveshaft_speed);
-
-                // Tires & Terrains
-                for(int i=0; i<4; ++i) {
-                    // Vehicle -> Tire
-                    double w_pos[3], w_rot[4], w_lin_vel[3], w_ang_vel[3];
-                    GetVecVariable(vehicle_fmu, wheel_ids[i] + ".pos", w_pos);
-                    GetQuatVariable(vehicle_fmu, wheel_ids[i] + ".rot", w_rot);
-                    GetVecVariable(vehicle_fmu, wheel_ids[i] + ".lin_vel", w_lin_vel);
-                    GetVecVariable(vehicle_fmu, wheel_ids[i] + ".ang_vel", w_ang_vel);
-
-                    SetVecVariable(*tires[i], "wheel_state.pos", w_pos);
-                    SetQuatVariable(*tires[i], "wheel_state.rot", w_rot);
-                    SetVecVariable(*tires[i], "wheel_state.lin_vel", w_lin_vel);
-                    SetVecVariable(*tires[i], "wheel_state.ang_vel", w_ang_vel);
-
-                    // Tire -> Vehicle
-                    double t_point[3], t_force[3], t_moment[3];
-                    GetVecVariable(*tires[i], "wheel_load.point", t_point);
-                    GetVecVariable(*tires[i], "wheel_load.force", t_force);
-                    GetVecVariable(*tires[i], "wheel_load.moment", t_moment);
-
-                    SetVecVariable(vehicle_fmu, wheel_ids[i] + ".point", t_point);
-                    SetVecVariable(vehicle_fmu, wheel_ids[i] + ".force", t_force);
-                    SetVecVariable(vehicle_fmu, wheel_ids[i] + ".moment", t_moment);
-
-                    // Tire -> Terrain
-                    double query_point[3];
-                    GetVecVariable(*tires[i], "query_point", query_point);
-                    SetVecVariable(*terrains[i], "query_point", query_point);
-
-                    // Step Terrain
-                    terrains[i]->DoStep(current_chrono_time, chrono_step_size);
-
-                    // Terrain -> Tire
-                    double height, mu, normal[3];
-                    terrains[i]->GetVariable("height", height);
-                    terrains[i]->GetVariable("mu", mu);
-                    GetVecVariable(*terrains[i], "normal", normal);
-                    
-                    tires[i]->SetVariable("terrain_height", height);
-                    tires[i]->SetVariable("terrain_mu", mu);
-                    SetVecVariable(*tires[i], "terrain_normal", normal);
-                }
-
-                // --- Step FMUs ---
-                if(vehicle_fmu.DoStep(current_chrono_time, chrono_step_size) != fmi2_status_ok) {
-                    std::cerr << "Vehicle FMU step failed at sub-step time " << current_chrono_time << std::endl;
-                    // In a real app handle error, here we could break
-                }
-                if(powertrain_fmu.DoStep(current_chrono_time, chrono_step_size) != fmi2_status_ok) {
-                    std::cerr << "Powertrain FMU step failed at sub-step time " << current_chrono_time << std::endl;
-                }
-                
-                for(auto t : tires) {
-                    t->DoStep(current_chrono_time, chrono_step_size);
-                }
-                
-                current_chrono_time += chrono_step_size;
+            if (!chrono_recovery.Advance(time, step_size, chrono_substeps)) {
+                std::cerr << chrono_recovery.GetDiagnostics() << std::endl;
+                std::cerr << "Aborting simulation at time " << time << " s" << std::endl;
+                aborted = true;
+                break;
             }
 
             // [Feedback] 2. Update TrafficUpdate with minimal construction
             if (ego_found_in_dc) {
-                double c_pos[3];
-                GetVecVariable(vehicle_fmu, "ref_frame.pos", c_pos);
-
-                // Update TrafficUpdate - Full Construction
-                current_tu.Clear();
-                current_tu.mutable_timestamp()->set_seconds((int64_t)time);
-                current_tu.mutable_timestamp()->set_nanos((int)((time - (int64_t)time) * 1e9));
-
-                auto* update_obj = current_tu.add_update();
-                update_obj->CopyFrom(stored_ego_obj); // Start with full copy
-                
-                auto* base = update_obj->mutable_base();
-                base->mutable_position()->set_x(c_pos[0]);
-                base->mutable_position()->set_y(c_pos[1]);
-                base->mutable_position()->set_z(c_pos[2]);
-
-                // Serialize
-                tu_buffer.clear();
-                current_tu.SerializeToString(&tu_buffer);
+                double c_pos[3], c_rot[4], c_pos_dt[3];
+                get_ref_frame(c_pos, c_rot, c_pos_dt);
+
+                // Static ego fields are encoded once; each step patches the dynamic ones in place
+                if (!tu_encoder.HasTemplate()) tu_encoder.SetTemplate(stored_ego_obj, lane_locator.IsEnabled());
+                double c_roll = std::atan2(2.0 * (c_rot[0] * c_rot[1] + c_rot[2] * c_rot[3]),
+                                           1.0 - 2.0 * (c_rot[1] * c_rot[1] + c_rot[2] * c_rot[2]));
+                double c_pitch = std::asin(std::clamp(2.0 * (c_rot[0] * c_rot[2] - c_rot[3] * c_rot[1]), -1.0, 1.0));
+                double c_yaw = std::atan2(2.0 * (c_rot[0] * c_rot[3] + c_rot[1] * c_rot[2]),
+                                          1.0 - 2.0 * (c_rot[2] * c_rot[2] + c_rot[3] * c_rot[3]));
+                double c_acc[3] = {0.0, 0.0, 0.0};
+                if (has_tu_prev_vel) {
+                    for (int i = 0; i < 3; ++i) c_acc[i] = (c_pos_dt[i] - tu_prev_vel[i]) / step_size;
+                }
+                for (int i = 0; i < 3; ++i) tu_prev_vel[i] = c_pos_dt[i];
+                has_tu_prev_vel = true;
+
+                tu_encoder.SetTimestamp(time);
+                tu_encoder.SetPosition(c_pos[0], c_pos[1], c_pos[2]);
+                tu_encoder.SetOrientation(c_roll, c_pitch, c_yaw);
+                tu_encoder.SetVelocity(c_pos_dt[0], c_pos_dt[1], c_pos_dt[2]);
+                tu_encoder.SetAcceleration(c_acc[0], c_acc[1], c_acc[2]);
+                if (lane_locator.IsEnabled()) {
+                    // After this step's split (above, or in the native controller branch), so the
+                    // index follows map changes from the same step; unchanged generations are a no-op
+                    lane_locator.SetMap(gt_cache.Static());
+                    // Off the lanes the last assigned lane is kept
+                    const LaneLocator::Location& lane = lane_locator.Locate(c_pos[0], c_pos[1], c_yaw);
+                    if (lane.onLane) tu_encoder.SetAssignedLane(lane.laneId);
+                }
 
                 // Send to esmini
-                int32_t tu_lo, tu_hi;
-                EncodeOSMPPointer(const_cast<char*>(tu_buffer.data()), tu_lo, tu_hi);
-                int32_t tu_sz = static_cast<int32_t>(tu_buffer.size());
+                tu_encoder.Write(tu_buffers.Acquire());
+                OsmpPointer tu = tu_buffers.Publish();
 
-                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.base.lo", tu_lo);
-                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.base.hi", tu_hi);
-                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.size", tu_sz);
+                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.base.lo", tu.lo);
+                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.base.hi", tu.hi);
+                esmini_fmu.SetVariable("OSMPTrafficUpdateIn.size", tu.size);
             }
 
             std::cerr << "[TRACE] Stepping Esmini..." << std::endl;
@@ -511,12 +872,14 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Esmini FMU step failed at time " << time << std::endl;
                 break;
             }
+            tu_buffers.Release(); // esmini has consumed the TrafficUpdate of this step
 
             // --- Get and Display Chrono Vehicle State ---
             double ref_pos[3], ref_rot[4], ref_pos_dt[3];
-            GetVecVariable(vehicle_fmu, "ref_frame.pos", ref_pos);
-            GetQuatVariable(vehicle_fmu, "ref_frame.rot", ref_rot);
-            GetVecVariable(vehicle_fmu, "ref_frame.pos_dt", ref_pos_dt);
+            get_ref_frame(ref_pos, ref_rot, ref_pos_dt);
+            if (surrogate_comparison) {
+                surrogate_comparison->Update(time + step_size, step_size, throttle, brake, steering, ref_pos, ref_rot, ref_pos_dt);
+            }
 
             double speed = std::sqrt(ref_pos_dt[0]*ref_pos_dt[0] + 
                                      ref_pos_dt[1]*ref_pos_dt[1] + 
@@ -535,19 +898,94 @@ int main(int argc, char* argv[]) {
                           << "Brake: " << std::setw(5) << brake << " | "
                           << "Steering: " << std::setw(6) << steering
                           << std::endl;
+                print_energy("[Energy]");
+            }
+
+            if (energy_log.is_open()) {
+                energy_log << time;
+                if (driveshaft_bond) energy_log << "," << driveshaft_bond->GetResidual() << "," << driveshaft_bond->GetTotalResidual();
+                for (auto& b : wheel_bonds) energy_log << "," << b->GetResidual() << "," << b->GetTotalResidual();
+                energy_log << "\n";
             }
 
             time += step_size;
             step_count++;
+
+            if (stop_conditions.IsEnabled()) {
+                double yaw = std::atan2(2.0 * (ref_rot[0] * ref_rot[3] + ref_rot[1] * ref_rot[2]),
+                                        1.0 - 2.0 * (ref_rot[2] * ref_rot[2] + ref_rot[3] * ref_rot[3]));
+                double acc_x = has_prev_vel ? (ref_pos_dt[0] - prev_vel[0]) / step_size : 0.0;
+                double acc_y = has_prev_vel ? (ref_pos_dt[1] - prev_vel[1]) / step_size : 0.0;
+                has_prev_vel = true;
+                prev_vel[0] = ref_pos_dt[0];
+                prev_vel[1] = ref_pos_dt[1];
+
+                stop_conditions.SetSignal(sig_time, time);
+                stop_conditions.SetSignal(sig_speed, speed);
+                stop_conditions.SetSignal(sig_pos_x, ref_pos[0]);
+                stop_conditions.SetSignal(sig_pos_y, ref_pos[1]);
+                stop_conditions.SetSignal(sig_pos_z, ref_pos[2]);
+                stop_conditions.SetSignal(sig_yaw, yaw);
+                stop_conditions.SetSignal(sig_accel_long, std::cos(yaw) * acc_x + std::sin(yaw) * acc_y);
+                stop_conditions.SetSignal(sig_accel_lat, -std::sin(yaw) * acc_x + std::cos(yaw) * acc_y);
+                stop_conditions.SetSignal(sig_throttle, throttle);
+                stop_conditions.SetSignal(sig_brake, brake);
+                stop_conditions.SetSignal(sig_steering, steering);
+                // NaN (never satisfies a threshold) while the ego is not located
+                const LaneLocator::Location& lane = lane_locator.Last();
+                stop_conditions.SetSignal(sig_lane_s, lane.valid ? lane.s : std::nan(""));
+                stop_conditions.SetSignal(sig_lane_t, lane.valid ? lane.t : std::nan(""));
+                stop_conditions.SetSignal(sig_lane_heading, lane.valid ? lane.headingError : std::nan(""));
+
+                // Objects after the esmini step (only scanned when a condition needs them)
+                const ObjectTable* stop_objects = nullptr;
+                const SpatialGrid* stop_grid = nullptr;
+                if (stop_conditions.NeedsGroundTruth()) {
+                    int sv_lo, sv_hi, sv_size;
+                    esmini_fmu.GetVariable("OSMPSensorViewOut.base.lo", sv_lo);
+                    esmini_fmu.GetVariable("OSMPSensorViewOut.base.hi", sv_hi);
+                    esmini_fmu.GetVariable("OSMPSensorViewOut.size", sv_size);
+                    // Moving objects are scanned from the view, skipping the map; stationary
+                    // ones come from the cached map when the native controller has one
+                    if (sv_size > 0 && ScanSensorView(DecodeOSMPPointer(sv_lo, sv_hi), sv_size, sv_scan)) {
+                        objects.Build(sv_scan);
+                        scene_grid.Update(objects);
+                        stop_objects = &objects;
+                        stop_grid = &scene_grid;
+                    }
+                }
+
+                if (stop_conditions.Evaluate(time, stop_objects, stop_grid, found_ego_id)) {
+                    std::cout << "[Stop] " << stop_conditions.GetReason() << std::endl;
+                    break;
+                }
+            }
         }
 
         std::cout << std::string(80, '=') << std::endl;
         std::cout << "Simulation finished at time " << time << " s" << std::endl;
+        executor.PrintStats();
+        chrono_recovery.PrintStats();
+        graph.PrintMemoization();
+        if (native_terrain) native_terrain->PrintStats();
+        if (tire_comparison) tire_comparison->PrintSummary();
+        if (surrogate_comparison) surrogate_comparison->PrintSummary();
+        if (controller_plugin) controller_plugin->PrintStats();
+        if (controller_plugin || lane_locator.IsEnabled()) gt_cache.PrintStats();
+        lane_locator.PrintStats();
+        sensor_model.PrintStats();
+        dc_pruner.PrintStats();
+        osi_arena.PrintStats();
+        stop_conditions.PrintSummary();
+        stop_conditions.WriteResult(time);
+        print_energy("[Energy] Final");
 
         // Cleanup
         for(auto t : tires) delete t;
         for(auto t : terrains) delete t;
 
+        if (aborted) return 2;
+
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 1;